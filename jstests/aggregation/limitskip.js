@@ -25,6 +25,16 @@ for (var i=0; i<r; i++) {
     assert.eq(100 - r[i]._id, i, tojson(doc));
 }
 
+print("limit on sort of an unindexed field");
+doc = db.runCommand({ aggregate : coll, pipeline : [{$project : {k : {$mod : ["$_id", 7]}}}, {$sort : {k : -1, _id : 1}}, {$limit : 20}]});
+r = doc.result;
+assert.eq(r.length, 20, tojson(doc));
+for (var i=0; i<r.length; i++) {
+    assert.eq(6 - Math.floor(i / 14), r[i].k, tojson(doc));
+    if (i > 0 && r[i].k == r[i-1].k)
+        assert.lt(r[i-1]._id, r[i]._id, tojson(doc));
+}
+
 print("TODO: invalid limit"); // once assert has been replaced with uassert
 
 
@@ -0,0 +1,40 @@
+// covered queries, counts and distincts over dotted and compound index fields
+
+t = db["jstests_coveredIndex3"];
+t.drop();
+
+for ( var i = 0; i < 20; ++i ) {
+    t.save( { a : { b : i % 5 , c : "x" + i } , d : i } );
+}
+
+t.ensureIndex( { "a.b" : 1 , d : 1 } );
+
+// nested projection rebuilt from the key
+var explain = t.find( { "a.b" : { $gt : 2 } } , { "a.b" : 1 , d : 1 , _id : 0 } ).explain();
+assert.eq( true , explain.indexOnly , "dotted projection should be covered" );
+assert.eq( 0 , explain.nscannedObjects , "covered query loaded documents" );
+assert.eq( { a : { b : 3 } , d : 3 } ,
+           t.find( { "a.b" : 3 } , { "a.b" : 1 , d : 1 , _id : 0 } ).sort( { "a.b" : 1 , d : 1 } ).limit( 1 ).next() );
+
+// fields outside the index still need the document
+assert.eq( false , t.find( { "a.b" : 3 } , { "a.c" : 1 , _id : 0 } ).explain().indexOnly );
+
+// an in memory sort on projected fields works from hydrated keys
+assert.eq( 19 , t.find( { "a.b" : { $gte : 1 } } , { "a.b" : 1 , d : 1 , _id : 0 } ).sort( { d : -1 } ).next().d );
+
+// distinct with a query on indexed fields
+var res = db.runCommand( { distinct : t.getName() , key : "d" , query : { "a.b" : 2 } } );
+assert.eq( [ 2 , 7 , 12 , 17 ] , res.values.sort( function( x , y ) { return x - y; } ) );
+assert.eq( true , res.stats.indexOnly , "distinct should be covered" );
+assert.eq( 0 , res.stats.nscannedObjects );
+
+res = db.runCommand( { distinct : t.getName() , key : "a.c" , query : { "a.b" : 2 } } );
+assert.eq( 4 , res.values.length );
+assert.eq( false , res.stats.indexOnly );
+
+// count over a range is answered from the index
+assert.eq( 8 , t.count( { "a.b" : { $gt : 2 } } ) );
+
+// multikey indexes can't cover
+t.save( { a : { b : [ 1 , 2 ] } , d : 100 } );
+assert.eq( false , t.find( { "a.b" : 2 } , { "a.b" : 1 , d : 1 , _id : 0 } ).explain().indexOnly );
@@ -0,0 +1,38 @@
+// Prefix compressed (v:2) indexes behave like v:1 ones.
+
+t = db.jstests_indexv2;
+t.drop();
+
+function path( i ) {
+    return "/home/shared/projects/reports/" + ( 100000 + i );
+}
+
+n = 5000;
+for( i = 0; i < n; ++i ) {
+    t.save( {t:'tenant' + ( i % 10 ), p:path( i )} );
+}
+t.ensureIndex( {t:1,p:1}, {v:2} );
+assert( !db.getLastError() );
+assert.eq( 2, db.system.indexes.findOne( {ns:t.getFullName(), name:'t_1_p_1'} ).v );
+
+function check() {
+    assert.eq( t.count(), t.find().hint( {t:1,p:1} ).itcount() );
+    assert.eq( t.find( {t:'tenant3'} ).hint( {$natural:1} ).itcount(), t.find( {t:'tenant3'} ).hint( {t:1,p:1} ).itcount() );
+    assert.eq( 1, t.find( {t:'tenant3',p:path( 3003 )} ).hint( {t:1,p:1} ).itcount() );
+    assert( t.validate( true ).valid );
+}
+check();
+
+// incremental inserts and removes
+for( i = n; i < 2 * n; ++i ) {
+    t.save( {t:'tenant' + ( i % 10 ), p:path( i )} );
+}
+t.remove( {p:{$lt:path( n / 2 )}} );
+assert( !db.getLastError() );
+check();
+
+// sorted in both directions
+a = t.find( {t:'tenant5'} ).sort( {t:1,p:1} ).hint( {t:1,p:1} ).toArray();
+b = t.find( {t:'tenant5'} ).sort( {t:-1,p:-1} ).hint( {t:1,p:1} ).toArray();
+assert.eq( a.length, b.length );
+assert.eq( a[ 0 ].p, b[ b.length - 1 ].p );
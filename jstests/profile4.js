@@ -0,0 +1,28 @@
+// Commands build their results in the operation's arena, and the profiler reports its use.
+
+t = db.profile4;
+t.drop();
+
+try {
+    db.setProfilingLevel(0);
+
+    db.system.profile.drop();
+    assert.eq( 0 , db.system.profile.count() )
+
+    db.setProfilingLevel(2);
+
+    t.insert( { x : 1 } );
+    assert.eq( 1 , t.count() );
+
+    db.setProfilingLevel(0);
+
+    p = db.system.profile.findOne( { op : "command" , "command.count" : t.getName() } );
+    assert( p , "count not profiled" );
+    assert( p.arenaAllocs > 0 , tojson( p ) );
+    assert.lte( 0 , p.arenaMallocs , tojson( p ) );
+
+    db.system.profile.drop();
+}
+finally {
+    db.setProfilingLevel(0);
+}
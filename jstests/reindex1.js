@@ -0,0 +1,33 @@
+// reIndex builds all foreground indexes out of a single collection scan.
+
+t = db.jstests_reindex1;
+t.drop();
+
+n = 20000;
+for( i = 0; i < n; ++i ) {
+    t.save( {a:i % 100, b:[i, -i - 1], c:'x' + i} );
+}
+t.ensureIndex( {a:1} );
+t.ensureIndex( {b:1} );
+t.ensureIndex( {a:1,c:-1} );
+assert( !db.getLastError() );
+
+res = t.reIndex();
+assert( res.ok );
+assert.eq( 4, res.nIndexes );
+
+function checkCounts() {
+    assert.eq( n, t.find().hint( {_id:1} ).itcount() );
+    assert.eq( n / 100, t.find( {a:7} ).hint( {a:1} ).itcount() );
+    assert.eq( 2 * n, t.find().hint( {b:1} ).explain().nscanned );
+    assert.eq( 1, t.find( {b:-123} ).hint( {b:1} ).itcount() );
+    assert.eq( n / 100, t.find( {a:7,c:{$gt:''}} ).hint( {a:1,c:-1} ).itcount() );
+    assert( t.validate( true ).valid );
+}
+checkCounts();
+
+// again, now that the indexes are in place
+res = t.reIndex();
+assert( res.ok );
+checkCounts();
+
@@ -0,0 +1,34 @@
+// Members run with --networkCompression send large messages to each other compressed
+
+var replTest = new ReplSetTest( { name : "network_compression" , nodes : 2 } );
+replTest.startSet( { networkCompression : "" } );
+replTest.initiate();
+
+var master = replTest.getMaster();
+
+// the shell doesn't ask for compression, so its replies are sent as they were
+var res = master.getDB( "admin" ).runCommand( { isMaster : 1 } );
+assert( ! res.compression , "A " + tojson( res ) );
+
+// a client that asks is answered
+res = master.getDB( "admin" ).runCommand( { isMaster : 1 , compression : [ "snappy" ] } );
+assert.eq( [ "snappy" ] , res.compression , "B" );
+
+// compressible documents, in getMore replies to the secondary well over CompressMinBytes
+var big = "";
+while ( big.length < 10000 )
+    big += "compress me ";
+for ( var i = 0; i < 100; i++ )
+    master.getDB( "test" ).foo.insert( { _id : i , s : big } );
+master.getDB( "test" ).getLastError( 2 , 60000 );
+
+var slave = replTest.liveNodes.slaves[ 0 ];
+slave.setSlaveOk();
+assert.eq( 100 , slave.getDB( "test" ).foo.count() , "C" );
+assert.eq( big , slave.getDB( "test" ).foo.findOne( { _id : 99 } ).s , "D" );
+
+var saved = master.getDB( "admin" ).serverStatus().network.compression;
+printjson( saved );
+assert.lt( 100 * big.length / 2 , saved.bytesSavedOut , "E" );
+
+replTest.stopSet();
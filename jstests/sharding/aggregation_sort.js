@@ -0,0 +1,52 @@
+// A $sort is done on the shards, which only send back their first $limit documents; mongos
+// merges the shards' sorted results.
+
+var st = new ShardingTest({ shards : 2, mongos : 1 })
+
+st.stopBalancer()
+
+var coll = st.s.getCollection( jsTest.name() + ".coll" )
+
+var n = 1000
+for( var i = 0; i < n; i++ ) coll.insert({ _id : i, v : ( i * 37 ) % n, g : i % 10 })
+assert.eq( null, coll.getDB().getLastError() )
+st.shardColl( coll, { _id : 1 }, { _id : n / 2 }, { _id : n / 2 } )
+
+var aggregate = function( pipeline ){
+    var res = coll.getDB().runCommand({ aggregate : coll.getName(), pipeline : pipeline })
+    assert.commandWorked( res )
+    return res.result
+}
+
+var checkSorted = function( result, expected, dir ){
+    assert.eq( expected, result.length )
+    for( var i = 1; i < result.length; i++ ){
+        if( dir > 0 ) assert.lt( result[ i - 1 ].v, result[ i ].v, tojson( result[ i ] ) )
+        else assert.gt( result[ i - 1 ].v, result[ i ].v, tojson( result[ i ] ) )
+    }
+}
+
+// the whole collection, merged across both shards
+checkSorted( aggregate([ { $sort : { v : 1 } } ]), n, 1 )
+
+// top k, with k less than either shard holds
+var top = aggregate([ { $sort : { v : -1 } }, { $limit : 15 } ])
+checkSorted( top, 15, -1 )
+assert.eq( n - 1, top[ 0 ].v )
+assert.eq( n - 15, top[ 14 ].v )
+
+// a $match after the $sort is moved ahead of it; later stages run after the merge
+var res = aggregate([ { $sort : { v : 1 } }, { $match : { g : 3 } }, { $limit : 5 },
+                      { $project : { v : 1 } } ])
+checkSorted( res, 5, 1 )
+res.forEach( function( doc ){ assert.eq( 3, doc._id % 10 ) } )
+
+// a limit larger than the collection
+checkSorted( aggregate([ { $sort : { v : 1 } }, { $limit : 5000 } ]), n, 1 )
+
+// a $skip between the $sort and the $limit is left for mongos
+res = aggregate([ { $sort : { v : 1 } }, { $skip : 990 }, { $limit : 20 } ])
+checkSorted( res, 10, 1 )
+assert.eq( 990, res[ 0 ].v )
+
+st.stop()
@@ -0,0 +1,49 @@
+// A bulk insert spanning chunks on several shards goes out as one batch per shard, and a stale
+// mongos retries the whole batch rather than losing the part for the moved chunk.
+
+var st = new ShardingTest({ shards : 2, mongos : 2, verbose : 1 })
+
+st.stopBalancer()
+
+var admin = st.s.getDB( "admin" )
+var config = st.s.getDB( "config" )
+var coll = st.s.getCollection( jsTest.name() + ".coll" )
+
+// chunks [MinKey, 0) and [0, MaxKey), the second on the other shard
+st.shardColl( coll, { _id : 1 }, { _id : 0 }, { _id : 0 } )
+assert.commandWorked( admin.runCommand({ split : coll + "", middle : { _id : -50 } }) )
+assert.commandWorked( admin.runCommand({ split : coll + "", middle : { _id : 50 } }) )
+
+var batch = function( from, to ){
+    var docs = []
+    for( var i = from; i < to; i++ ) docs.push({ _id : i })
+    return docs
+}
+
+var before = admin.runCommand({ serverStatus : 1 }).shardedInserts
+
+coll.insert( batch( -100, 100 ) )
+assert.eq( null, coll.getDB().getLastError() )
+assert.eq( 200, coll.find().itcount() )
+
+var after = admin.runCommand({ serverStatus : 1 }).shardedInserts
+printjson( after )
+assert.eq( before.batches + 1, after.batches )
+assert.eq( before.shardSends + 2, after.shardSends )
+assert.eq( 2, after.maxFanOut )
+
+jsTest.log( "Moving chunk to make the second mongos stale..." )
+
+var collB = st.s1.getCollection( coll + "" )
+assert.eq( 200, collB.find().itcount() )
+
+var otherShard = config.chunks.findOne({ ns : coll + "", min : { _id : 50 } }).shard
+otherShard = otherShard == st._shardNames[0] ? st._shardNames[1] : st._shardNames[0]
+assert.commandWorked( admin.runCommand({ moveChunk : coll + "", find : { _id : 50 }, to : otherShard }) )
+
+collB.insert( batch( 100, 300 ).concat( batch( -300, -100 ) ) )
+assert.eq( null, collB.getDB().getLastError() )
+assert.eq( 600, coll.find().itcount() )
+assert.eq( 600, collB.find().itcount() )
+
+st.stop()
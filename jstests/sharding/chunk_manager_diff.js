@@ -0,0 +1,54 @@
+// A stale mongos patches its chunk manager with just the chunks changed by splits and migrations
+// made through another mongos, and must still route every document correctly afterwards.
+
+var st = new ShardingTest({ shards : 2, mongos : 2, verbose : 1 })
+
+st.stopBalancer()
+
+var admin = st.s.getDB( "admin" )
+var config = st.s.getDB( "config" )
+var coll = st.s.getCollection( jsTest.name() + ".coll" )
+var collB = st.s1.getCollection( coll + "" )
+
+st.shardColl( coll, { _id : 1 }, { _id : 0 }, false )
+
+for( var i = -100; i < 100; i++ ) coll.insert({ _id : i })
+assert.eq( null, coll.getDB().getLastError() )
+
+// make sure the second mongos has a chunk manager to patch
+assert.eq( 200, collB.find().itcount() )
+
+var otherShard = function( key ){
+    var shard = config.chunks.findOne({ ns : coll + "", min : key }).shard
+    return shard == st._shardNames[0] ? st._shardNames[1] : st._shardNames[0]
+}
+
+jsTest.log( "Splitting and moving chunks through the first mongos..." )
+
+for( var i = -90; i < 100; i += 10 ){
+    if( i == 0 ) continue
+    assert.commandWorked( admin.runCommand({ split : coll + "", middle : { _id : i } }) )
+}
+for( var i = -80; i < 100; i += 40 ){
+    assert.commandWorked( admin.runCommand({ moveChunk : coll + "", find : { _id : i }, to : otherShard({ _id : i }) }) )
+}
+
+// writes and reads through the stale mongos pick up the new chunks
+for( var i = 100; i < 200; i++ ) collB.insert({ _id : i })
+for( var i = -200; i < -100; i++ ) collB.insert({ _id : i })
+assert.eq( null, collB.getDB().getLastError() )
+
+assert.eq( 400, collB.find().itcount() )
+for( var i = -200; i < 200; i += 13 ) assert.eq( 1, collB.find({ _id : i }).itcount(), "missing " + i )
+
+var version = config.chunks.find({ ns : coll + "" }).sort({ lastmod : -1 }).limit( 1 ).next().lastmod
+assert.eq( version, st.s1.getDB( "admin" ).runCommand({ getShardVersion : coll + "" }).version )
+
+// each shard holds exactly the documents of its chunks
+config.chunks.find({ ns : coll + "" }).forEach( function( chunk ){
+    var shardColl = st._connections[ st._shardNames[0] == chunk.shard ? 0 : 1 ].getCollection( coll + "" )
+    var query = { _id : { $gte : chunk.min._id, $lt : chunk.max._id } }
+    assert.eq( coll.find( query ).itcount(), shardColl.find( query ).itcount(), tojson( chunk ) )
+})
+
+st.stop()
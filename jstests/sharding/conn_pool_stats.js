@@ -0,0 +1,38 @@
+// connPoolStats reports how busy each host's pool is, and the pool limits can be set at runtime
+
+var st = new ShardingTest( { name : "conn_pool_stats" , shards : 1 , mongos : 1 } );
+var admin = st.s.getDB( "admin" );
+
+st.s.getDB( "test" ).foo.insert( { x : 1 } );
+assert.eq( 1 , st.s.getDB( "test" ).foo.count() , "A" );
+
+var stats = admin.runCommand( "connPoolStats" );
+printjson( stats );
+assert( stats.ok , "B" );
+assert.eq( 0 , stats.totalWaiting , "C" );
+for ( var host in stats.hosts ) {
+    var h = stats.hosts[ host ];
+    if ( h.created == undefined )
+        continue; // createdByType
+    assert( h.inUse >= 0 , "D " + host );
+    assert.eq( 0 , h.waiting , "E " + host );
+    assert.eq( 0 , h.timeouts , "F " + host );
+    assert( h.waits[ "0-1ms" ] >= 0 , "G " + host );
+}
+
+// setParameter / getParameter round trip
+var old = admin.runCommand( { getParameter : 1 , connPoolMaxInUsePerHost : 1 } );
+assert.eq( 0 , old.connPoolMaxInUsePerHost , "H" );
+
+var res = admin.runCommand( { setParameter : 1 , connPoolMaxInUsePerHost : 20 } );
+assert( res.ok , "I" );
+assert.eq( 0 , res.was , "J" );
+assert.eq( 20 , admin.runCommand( { getParameter : 1 , connPoolMaxInUsePerHost : 1 } ).connPoolMaxInUsePerHost , "K" );
+
+// still works under the limit
+assert.eq( 1 , st.s.getDB( "test" ).foo.count() , "L" );
+
+assert( ! admin.runCommand( { setParameter : 1 , connPoolMinPerHost : -1 } ).ok , "M" );
+assert( admin.runCommand( { setParameter : 1 , connPoolMaxInUsePerHost : 0 } ).ok , "N" );
+
+st.stop();
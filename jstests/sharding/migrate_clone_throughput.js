@@ -0,0 +1,41 @@
+// The initial clone of a migration is pipelined and applied in batches; both sides record its
+// throughput in the changelog, and indexes held back on an empty recipient end up built.
+
+var st = new ShardingTest({ shards : 2, mongos : 1, verbose : 1 })
+
+st.stopBalancer()
+
+var admin = st.s.getDB( "admin" )
+var config = st.s.getDB( "config" )
+var coll = st.s.getCollection( jsTest.name() + ".coll" )
+
+// loaded before sharding so that the whole collection is a single chunk
+var n = 20000
+var pad = new Array( 200 ).join( "x" )
+for( var i = 0; i < n; i++ ) coll.insert({ _id : i, b : i % 100, pad : pad })
+assert.eq( null, coll.getDB().getLastError() )
+coll.ensureIndex({ b : 1 })
+
+st.shardColl( coll, { _id : 1 }, false, false )
+
+var from = config.chunks.findOne({ ns : coll + "" }).shard
+var to = from == st._shardNames[0] ? st._shardNames[1] : st._shardNames[0]
+assert.commandWorked( admin.runCommand({ moveChunk : coll + "", find : { _id : 0 }, to : to }) )
+
+var toEntry = config.changelog.find({ what : "moveChunk.to", ns : coll + "" }).sort({ time : -1 }).next()
+printjson( toEntry )
+assert.eq( n, toEntry.details.clone.docs )
+assert.lt( 0, toEntry.details.clone.bytes )
+
+var fromEntry = config.changelog.find({ what : "moveChunk.from", ns : coll + "" }).sort({ time : -1 }).next()
+printjson( fromEntry )
+assert.eq( n, fromEntry.details.clone.docs )
+
+// the recipient had nothing of this collection, so its { b : 1 } index was built after the clone
+var toShard = st._connections[ to == st._shardNames[0] ? 0 : 1 ].getCollection( coll + "" )
+assert.eq( 2, toShard.getIndexes().length )
+assert.eq( n / 100, toShard.find({ b : 7 }).hint({ b : 1 }).itcount() )
+assert( toShard.validate( true ).valid )
+assert.eq( n, coll.find().itcount() )
+
+st.stop()
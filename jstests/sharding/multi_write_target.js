@@ -0,0 +1,60 @@
+// Multi updates and deletes are only sent to the shards owning chunks in the query's shard key
+// ranges; mongos counts targeted and broadcast writes in serverStatus.
+
+var st = new ShardingTest({ shards : 2, mongos : 1 })
+
+st.stopBalancer()
+
+var coll = st.s.getCollection( jsTest.name() + ".coll" )
+var admin = st.s.getDB( "admin" )
+
+var n = 100
+for( var i = 0; i < n; i++ ) coll.insert({ _id : i, x : 0 })
+assert.eq( null, coll.getDB().getLastError() )
+st.shardColl( coll, { _id : 1 }, { _id : n / 2 }, { _id : n / 2 } )
+
+var counts = function(){
+    return admin.runCommand({ serverStatus : 1 }).shardedWrites
+}
+var shardOps = function(){
+    return [ st.shard0.getDB( "admin" ).runCommand({ serverStatus : 1 }).opcounters,
+             st.shard1.getDB( "admin" ).runCommand({ serverStatus : 1 }).opcounters ]
+}
+
+// a range on one side of the split only touches that side's shard
+var before = counts()
+var ops = shardOps()
+coll.update({ _id : { $lt : 10 } }, { $set : { x : 1 } }, false, true)
+assert.eq( 10, coll.getDB().getLastErrorObj().n )
+var after = counts()
+var opsAfter = shardOps()
+assert.eq( before.update.targeted + 1, after.update.targeted )
+assert.eq( before.update.broadcast, after.update.broadcast )
+assert.eq( 1, ( opsAfter[0].update - ops[0].update ) + ( opsAfter[1].update - ops[1].update ) )
+
+// so does an $in whose values are all on one shard
+coll.update({ _id : { $in : [ 60, 70, 80 ] } }, { $set : { x : 2 } }, false, true)
+assert.eq( 3, coll.getDB().getLastErrorObj().n )
+assert.eq( before.update.targeted + 2, counts().update.targeted )
+
+// a query without the shard key has to go everywhere
+coll.update({ x : 0 }, { $set : { x : 3 } }, false, true)
+assert.eq( n - 13, coll.getDB().getLastErrorObj().n )
+assert.eq( before.update.broadcast + 1, counts().update.broadcast )
+
+// deletes are routed the same way
+before = counts()
+coll.remove({ _id : { $gte : 90 } })
+assert.eq( 10, coll.getDB().getLastErrorObj().n )
+coll.remove({ _id : { $in : [ 1, 2, 3 ] } })
+assert.eq( 3, coll.getDB().getLastErrorObj().n )
+coll.remove({ x : 2 })
+assert.eq( 3, coll.getDB().getLastErrorObj().n )
+after = counts()
+assert.eq( before["delete"].targeted + 2, after["delete"].targeted )
+assert.eq( before["delete"].broadcast + 1, after["delete"].broadcast )
+
+assert.eq( n - 16, coll.count() )
+assert.eq( 7, coll.count({ x : 1 }) )
+
+st.stop()
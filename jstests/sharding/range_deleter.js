@@ -0,0 +1,58 @@
+// Ranges migrated away are deleted by the range deleter, in throttled batches, once the cursors
+// open at commit are gone.
+
+var st = new ShardingTest({ shards : 2, mongos : 1, verbose : 1 })
+
+st.stopBalancer()
+
+var admin = st.s.getDB( "admin" )
+var config = st.s.getDB( "config" )
+var coll = st.s.getCollection( jsTest.name() + ".coll" )
+
+for( var i = 0; i < 2000; i++ ) coll.insert({ _id : i })
+assert.eq( null, coll.getDB().getLastError() )
+st.shardColl( coll, { _id : 1 }, { _id : 1000 }, false )
+
+var from = config.chunks.findOne({ ns : coll + "" }).shard
+var to = from == st._shardNames[0] ? st._shardNames[1] : st._shardNames[0]
+var donor = st._connections[ from == st._shardNames[0] ? 0 : 1 ]
+var donorColl = donor.getCollection( coll + "" )
+
+var status = donor.getDB( "admin" ).runCommand({ rangeDeleter : 1 })
+assert.commandWorked( status )
+assert.eq( 0, status.pending.length )
+assert( ! donor.getDB( "admin" ).runCommand({ rangeDeleter : 1, batchSize : 0 }).ok )
+assert( ! donor.getDB( "admin" ).runCommand({ rangeDeleter : 1, docsPerSec : -1 }).ok )
+status = donor.getDB( "admin" ).runCommand({ rangeDeleter : 1, batchSize : 50, docsPerSec : 2000 })
+assert.eq( 50, status.batchSize )
+assert.eq( 2000, status.docsPerSec )
+
+// an open cursor on the donor holds the deletion back
+var cursor = donorColl.find({ _id : { $gte : 1000 } }).batchSize( 2 )
+cursor.next()
+
+assert.commandWorked( admin.runCommand({ moveChunk : coll + "", find : { _id : 1000 }, to : to }) )
+
+status = donor.getDB( "admin" ).runCommand({ rangeDeleter : 1 })
+printjson( status )
+assert.eq( 1, status.pending.length )
+assert.eq( coll + "", status.pending[0].ns )
+assert.eq( 1000, status.pending[0].min._id )
+
+// the range can't come back while its old copy is still pending
+assert( ! admin.runCommand({ moveChunk : coll + "", find : { _id : 1000 }, to : from }).ok )
+
+cursor.itcount()
+assert.soon( function(){ return donor.getDB( "admin" ).runCommand({ rangeDeleter : 1 }).pending.length == 0 },
+             "range never deleted", 60 * 1000 )
+assert.eq( 0, donorColl.find({ _id : { $gte : 1000 } }).itcount() )
+assert.eq( 1000, donorColl.find().itcount() )
+assert.eq( 2000, coll.find().itcount() )
+
+// with no cursors open the move waits for the delete
+assert.commandWorked( admin.runCommand({ moveChunk : coll + "", find : { _id : 1000 }, to : from }) )
+var recipient = st._connections[ from == st._shardNames[0] ? 1 : 0 ].getCollection( coll + "" )
+assert.eq( 0, recipient.find().itcount() )
+assert.eq( 2000, coll.find().itcount() )
+
+st.stop()
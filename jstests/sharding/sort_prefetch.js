@@ -0,0 +1,41 @@
+// A sorted query merging several shards keeps a getMore in flight per shard cursor; results,
+// limits and abandoned cursors must be unaffected.
+
+var st = new ShardingTest({ shards : 2, mongos : 1 })
+
+st.stopBalancer()
+
+var coll = st.s.getCollection( jsTest.name() + ".coll" )
+
+var n = 2000
+for( var i = 0; i < n; i++ ) coll.insert({ _id : i, v : ( i * 37 ) % n })
+assert.eq( null, coll.getDB().getLastError() )
+st.shardColl( coll, { _id : 1 }, { _id : n / 2 }, { _id : n / 2 } )
+
+// both shards hold every other stretch of v, so the merge alternates between them
+var check = function( cursor, expected ){
+    var last = -1
+    var count = 0
+    while( cursor.hasNext() ){
+        var doc = cursor.next()
+        assert.gt( doc.v, last )
+        last = doc.v
+        count++
+    }
+    assert.eq( expected, count )
+}
+
+check( coll.find().sort({ v : 1 }).batchSize( 10 ), n )
+check( coll.find().sort({ v : 1 }).batchSize( 7 ).limit( 55 ), 55 )
+check( coll.find({ v : { $gte : 1500 } }).sort({ v : 1 }).batchSize( 10 ), 500 )
+
+// cursors dropped with a getMore outstanding don't leave replies on pooled connections
+for( var i = 0; i < 20; i++ ){
+    var cursor = coll.find().sort({ v : 1 }).batchSize( 10 )
+    for( var j = 0; j < 25; j++ ) cursor.next()
+    cursor.close()
+}
+check( coll.find().sort({ v : -1 }).batchSize( 10 ).limit( -1 ), 1 )
+check( coll.find().sort({ v : 1 }).batchSize( 100 ), n )
+
+st.stop()
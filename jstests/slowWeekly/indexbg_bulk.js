@@ -0,0 +1,60 @@
+// A non unique background index is bulk loaded; writes made while it builds, including ones
+// that move records or change multikey values, must end up in the finished index.
+
+baseName = "jstests_indexbg_bulk";
+t = db[ baseName ];
+
+parallel = function() {
+    return db[ baseName + "_parallelStatus" ];
+}
+
+doParallel = function( work ) {
+    parallel().drop();
+    startMongoProgramNoConnect( "mongo", "--eval", work + "; db." + baseName + "_parallelStatus.save( {done:1} );", db.getMongo().host );
+}
+
+doneParallel = function() {
+    return !!parallel().findOne();
+}
+
+checkIndex = function() {
+    var values = [ -1, 3, 7, 10, 400, 401, 1000, 'moved', 'new' ];
+    values.forEach( function( v ) {
+                   assert.eq( t.find( {a:v} ).hint( {$natural:1} ).itcount(),
+                              t.find( {a:v} ).hint( {a:1} ).itcount(), "value " + tojson( v ) );
+                   } );
+    assert.eq( t.find().hint( {$natural:1} ).itcount(), t.find( {a:{$exists:true}} ).hint( {a:1} ).itcount() );
+    assert( t.validate( true ).valid );
+}
+
+size = 200000;
+while( 1 ) {
+    t.drop();
+    db.eval( function( size ) {
+                for( i = 0; i < size; ++i ) {
+                    db.jstests_indexbg_bulk.save( {i:i, a:i % 1000} );
+                }
+            }, size );
+
+    doParallel( "db." + baseName + ".ensureIndex( {a:1}, {background:true} )" );
+    assert.soon( function() { return 2 == db.system.indexes.count( {ns:"test." + baseName} ) }, "no index created", 30000, 50 );
+
+    t.remove( {i:3} );
+    t.update( {i:7}, {$set:{a:-1}} );
+    t.update( {i:10}, {$set:{a:[1000, 'new']}} );
+    t.update( {i:401}, {$set:{pad:new Array( 2000 ).toString(), a:'moved'}} ); // grows, so moves
+    t.save( {i:-1, a:400} );
+    t.save( {i:-2, a:[7, 'new']} );
+    assert( !db.getLastError() );
+
+    if ( !doneParallel() ) {
+        break;
+    }
+    print( "indexing finished too soon, retrying..." );
+    size *= 2;
+    assert( size < 20000000, "unable to run checks in parallel with index creation" );
+}
+
+assert.soon( function() { return doneParallel(); }, "parallel did not finish in time", 300000, 1000 );
+assert.eq( "BtreeCursor a_1", t.find( {a:400} ).explain().cursor );
+checkIndex();
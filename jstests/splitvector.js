@@ -192,4 +192,54 @@ assert.eq( 1 , res.splitKeys.length , "9b" );
 assert.eq( 2 , res.splitKeys[0].x , "9c" );
 
 
+// -------------------------
+// Case 10: "estimate" mode, where split points come from the shape of the index
+//
+
+f.drop();
+f.ensureIndex( { x: 1 } );
+
+numDocs = 20000;
+for( i=0; i<numDocs; i++ ){
+    f.save( { x: i, y: filler } );
+}
+db.getLastError();
+
+exact = db.runCommand( { splitVector: "test.jstests_splitvector" , keyPattern: {x:1} , maxChunkSize: 1 } );
+res = db.runCommand( { splitVector: "test.jstests_splitvector" , keyPattern: {x:1} , maxChunkSize: 1 , estimate: true } );
+
+assert.eq( true , res.ok , "10a" );
+assert( res.estimated , "10b" );
+assert.close( exact.splitKeys.length , res.splitKeys.length , "10c" , -1 );
+splitVec = [ { x: -1 } ].concat( res.splitKeys );
+splitVec.push( { x: numDocs } );
+for ( i=0; i<splitVec.length-1; i++ ) {
+    assert.lt( splitVec[i].x , splitVec[i+1].x , "10d" );
+    if ( i < splitVec.length - 2 ) {
+        n = f.find( { x: { $gte: splitVec[i].x , $lt: splitVec[i+1].x } } ).count();
+        assert.gt( n , numDocs / exact.splitKeys.length / 4 , "10e" );
+        assert.lt( n , numDocs / exact.splitKeys.length * 4 , "10f" );
+    }
+}
+
+res = db.runCommand( { splitVector: "test.jstests_splitvector" , keyPattern: {x:1} , maxChunkSize: 1 , maxSplitPoints: 2 , estimate: true } );
+assert.eq( 2 , res.splitKeys.length , "10g" );
+
+res = db.runCommand( { splitVector: "test.jstests_splitvector" , keyPattern: {x:1} , min: {x:100} , max: {x:200} , maxChunkSize: 1 , estimate: true } );
+assert.eq( [] , res.splitKeys , "10h" );
+
+// a forced split finds the middle key of a small chunk too
+f.drop();
+f.ensureIndex( { x: 1 } );
+f.save( { x: 1 } );
+f.save( { x: 2 } );
+f.save( { x: 3 } );
+db.getLastError();
+
+res = db.runCommand( { splitVector: "test.jstests_splitvector" , keyPattern: {x:1} , force : true , estimate: true } );
+assert.eq( true , res.ok , "10i" );
+assert.eq( 1 , res.splitKeys.length , "10j" );
+assert.eq( 2 , res.splitKeys[0].x , "10k" );
+
+
 print("PASSED");
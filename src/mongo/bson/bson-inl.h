@@ -281,10 +281,16 @@ dodouble:
     }
 
     inline BSONElement BSONObj::getField(const StringData& name) const {
+        return _getField(name.data(), name.size());
+    }
+
+    inline BSONElement BSONObj::_getField(const char *name, unsigned len) const {
         BSONObjIterator i(*this);
         while ( i.more() ) {
             BSONElement e = i.next();
-            if ( strcmp(e.fieldName(), name.data()) == 0 )
+            // next() has already measured the field name to step over the element, so
+            // names of the wrong length are skipped without looking at their bytes
+            if ( e.fieldNameSize() == (int) len + 1 && memcmp(e.fieldName(), name, len) == 0 )
                 return e;
         }
         return BSONElement();
@@ -796,8 +802,9 @@ dodouble:
         if ( e.eoo() ) {
             const char *p = strchr(name, '.');
             if ( p ) {
-                string left(name, p-name);
-                BSONObj sub = getObjectField(left.c_str());
+                BSONElement left = _getField(name, (unsigned) (p-name));
+                BSONType t = left.type();
+                BSONObj sub = t == Object || t == Array ? left.embeddedObject() : BSONObj();
                 return sub.isEmpty() ? BSONElement() : sub.getFieldDotted(p+1);
             }
         }
@@ -923,10 +930,19 @@ dodouble:
     }
 
     // used by jsonString()
-    inline string escape( string s , bool escape_slash=false) {
-        StringBuilder ret;
-        for ( string::iterator i = s.begin(); i != s.end(); ++i ) {
-            switch ( *i ) {
+    inline void escape( StringBuilder& ret, const StringData& s, bool escape_slash=false ) {
+        const char *p = s.data();
+        const char *end = p + s.size();
+        while ( p != end ) {
+            // copy the longest run needing no escape at once
+            const char *run = p;
+            while ( p != end && *p != '"' && *p != '\\' && ( *p != '/' || !escape_slash ) &&
+                    !( *p >= 0 && *p <= 0x1f ) )
+                ++p;
+            ret.write( run, p - run );
+            if ( p == end )
+                break;
+            switch ( *p ) {
             case '"':
                 ret << "\\\"";
                 break;
@@ -934,7 +950,7 @@ dodouble:
                 ret << "\\\\";
                 break;
             case '/':
-                ret << (escape_slash ? "\\/" : "/");
+                ret << "\\/";
                 break;
             case '\b':
                 ret << "\\b";
@@ -951,17 +967,20 @@ dodouble:
             case '\t':
                 ret << "\\t";
                 break;
-            default:
-                if ( *i >= 0 && *i <= 0x1f ) {
-                    //TODO: these should be utf16 code-units not bytes
-                    char c = *i;
-                    ret << "\\u00" << toHexLower(&c, 1);
-                }
-                else {
-                    ret << *i;
-                }
+            default: {
+                //TODO: these should be utf16 code-units not bytes
+                static const char hexchars[] = "0123456789abcdef";
+                char u[] = { '\\', 'u', '0', '0', hexchars[ ( *p & 0xF0 ) >> 4 ], hexchars[ *p & 0x0F ] };
+                ret.write( u, 6 );
+            }
             }
+            ++p;
         }
+    }
+
+    inline string escape( string s , bool escape_slash=false) {
+        StringBuilder ret;
+        escape( ret, s, escape_slash );
         return ret.str();
     }
 
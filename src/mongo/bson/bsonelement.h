@@ -102,6 +102,7 @@ namespace mongo {
         string toString( bool includeFieldName = true, bool full=false) const;
         void toString(StringBuilder& s, bool includeFieldName = true, bool full=false) const;
         string jsonString( JsonStringFormat format, bool includeFieldNames = true, int pretty = 0 ) const;
+        void jsonString( StringBuilder& s, JsonStringFormat format, bool includeFieldNames = true, int pretty = 0 ) const;
         operator string() const { return toString(); }
 
         /** Returns the type of the element */
@@ -145,6 +145,8 @@ namespace mongo {
             @param pretty if true we try to add some lf's and indentation
         */
         string jsonString( JsonStringFormat format = Strict, int pretty = 0 ) const;
+        /** append the jsonString() to s, so that a buffer may be reused from object to object */
+        void jsonString( StringBuilder& s, JsonStringFormat format = Strict, int pretty = 0 ) const;
 
         /** note: addFields always adds _id even if not specified */
         int addFields(BSONObj& from, set<string>& fields); /* returns n added */
@@ -471,6 +473,9 @@ namespace mongo {
 
         void _assertInvalid() const;
 
+        /** getField() for the first len bytes of name, which need not be null terminated there */
+        BSONElement _getField(const char *name, unsigned len) const;
+
         void init(Holder *holder) {
             _holder = holder; // holder is now managed by intrusive_ptr
             init(holder->data);
@@ -99,6 +99,15 @@ namespace mongo {
             _b.skip(4); /*leave room for size field and ref-count*/
         }
 
+        /** @param arena build the object in arena rather than in malloc()ed memory; see Arena.
+                   obj() copies the result out of the arena.
+            @param initsize this is just a hint as to the final size of the object
+        */
+        BSONObjBuilder(Arena *arena, int initsize=512) : _b(_buf), _buf(arena, initsize + sizeof(unsigned)), _offset( sizeof(unsigned) ), _s( this ) , _tracker(0) , _doneCalled(false) {
+            _b.appendNum((unsigned)0); // ref-count
+            _b.skip(4); /*leave room for size field and ref-count*/
+        }
+
         /** @param baseBuilder construct a BSONObjBuilder using an existing BufBuilder
          *  This is for more efficient adding of subobjects/arrays. See docs for subobjStart for example.
          */
@@ -550,6 +559,8 @@ namespace mongo {
         BSONObj obj() {
             bool own = owned();
             massert( 10335 , "builder does not own memory", own );
+            if ( _b.arena() )
+                return done().getOwned();
             doneFast();
             BSONObj::Holder* h = (BSONObj::Holder*)_b.buf();
             decouple(); // sets _b.buf() to NULL
@@ -50,11 +50,143 @@ namespace mongo {
 
     void msgasserted(int msgid, const char *msg);
 
+    /** Hands out memory for short lived buffers by bumping a pointer through large blocks, and
+        takes it all back at once on reset().  Meant for the temporaries of one operation, e.g.
+        a command's result, so that they don't malloc and realloc as they grow.
+
+        Allocations of more than MaxAlloc bytes go to malloc, so that the arena stays small;
+        callers pass the size of what they free or reallocate so the two kinds can be told apart.
+        The latest allocation grows and is given back in place.  Not thread safe.
+    */
+    class Arena {
+        // non-copyable, non-assignable
+        Arena( const Arena& );
+        Arena& operator=( const Arena& );
+    public:
+        enum { BlockSize = 32 * 1024, MaxAlloc = BlockSize / 4 };
+
+        Arena() : _blocks(0), _cur(0), _end(0), _last(0), _allocs(0), _mallocs(0) { }
+        ~Arena() {
+            reset();
+            ::free( _blocks );
+        }
+
+        void* Malloc(size_t sz) {
+            if( sz > MaxAlloc ) {
+                _mallocs++;
+                return malloc(sz);
+            }
+            sz = round(sz);
+            if( _cur == 0 || sz > (size_t) ( _end - _cur ) )
+                newBlock();
+            _last = _cur;
+            _cur += sz;
+            _allocs++;
+            return _last;
+        }
+
+        void* Realloc(void *p, size_t oldSz, size_t sz) {
+            if( oldSz > MaxAlloc && sz > MaxAlloc ) {
+                _mallocs++;
+                return realloc(p, sz);
+            }
+            if( p && p == _last && sz <= MaxAlloc && round(sz) <= (size_t) ( _end - _last ) ) {
+                _cur = _last + round(sz);
+                _allocs++;
+                return p;
+            }
+            void *q = Malloc(sz);
+            if( q && p ) {
+                memcpy(q, p, oldSz < sz ? oldSz : sz);
+                Free(p, oldSz);
+            }
+            return q;
+        }
+
+        void Free(void *p, size_t sz) {
+            if( sz > MaxAlloc ) {
+                ::free(p);
+            }
+            else if( p && p == _last ) {
+                _cur = _last;
+                _last = 0;
+            }
+        }
+
+        /** release everything allocated.  the first block is kept for reuse. */
+        void reset() {
+            if( _blocks == 0 )
+                return;
+            Block *b = _blocks->next;
+            while( b ) {
+                Block *next = b->next;
+                ::free( b );
+                b = next;
+            }
+            _blocks->next = 0;
+            _cur = _blocks->data();
+            _end = (char *) _blocks + BlockSize;
+            _last = 0;
+        }
+
+        /** @return allocations served from the arena */
+        unsigned long long allocs() const { return _allocs; }
+        /** @return calls made to malloc and realloc, for blocks and for large allocations */
+        unsigned long long mallocs() const { return _mallocs; }
+
+    private:
+        struct Block {
+            Block *next;
+            double align;
+            char* data() { return (char *) &align; }
+        };
+
+        static size_t round(size_t sz) { return ( sz + 7 ) & ~(size_t) 7; }
+
+        void newBlock() {
+            Block *b = (Block *) malloc( BlockSize );
+            if( b == 0 )
+                msgasserted( 16068, "out of memory Arena::newBlock" );
+            _mallocs++;
+            // the first block is kept by reset(); later ones are chained after it
+            if( _blocks == 0 ) {
+                b->next = 0;
+                _blocks = b;
+            }
+            else {
+                b->next = _blocks->next;
+                _blocks->next = b;
+            }
+            _cur = b->data();
+            _end = (char *) b + BlockSize;
+            _last = 0;
+        }
+
+        Block *_blocks;
+        char *_cur;
+        char *_end;
+        char *_last;
+        unsigned long long _allocs;
+        unsigned long long _mallocs;
+    };
+
+    /** malloc, or an Arena if given one */
     class TrivialAllocator { 
     public:
-        void* Malloc(size_t sz) { return malloc(sz); }
-        void* Realloc(void *p, size_t sz) { return realloc(p, sz); }
-        void Free(void *p) { free(p); }
+        TrivialAllocator( Arena *arena = 0 ) : _arena( arena ) { }
+        void* Malloc(size_t sz) { return _arena ? _arena->Malloc(sz) : malloc(sz); }
+        void* Realloc(void *p, size_t oldSz, size_t sz) {
+            return _arena ? _arena->Realloc(p, oldSz, sz) : realloc(p, sz);
+        }
+        void Free(void *p, size_t sz) {
+            if( _arena )
+                _arena->Free(p, sz);
+            else
+                free(p);
+        }
+        Arena* arena() const { return _arena; }
+    private:
+        Arena *_arena;
     };
 
     class StackAllocator {
@@ -64,7 +196,7 @@ namespace mongo {
             if( sz <= SZ ) return buf;
             return malloc(sz); 
         }
-        void* Realloc(void *p, size_t sz) { 
+        void* Realloc(void *p, size_t oldSz, size_t sz) { 
             if( p == buf ) {
                 if( sz <= SZ ) return buf;
                 void *d = malloc(sz);
@@ -75,10 +207,11 @@ namespace mongo {
             }
             return realloc(p, sz); 
         }
-        void Free(void *p) { 
+        void Free(void *p, size_t sz) { 
             if( p != buf )
                 free(p); 
         }
+        Arena* arena() const { return 0; }
     private:
         char buf[SZ];
     };
@@ -101,11 +234,23 @@ namespace mongo {
             }
             l = 0;
         }
+        /** @param arena where to allocate the buffer, see Arena.  the buffer can't be decouple()d. */
+        _BufBuilder(Arena *arena, int initsize = 512) : al(arena), size(initsize) {
+            if ( size > 0 ) {
+                data = (char *) al.Malloc(size);
+                if( data == 0 )
+                    msgasserted(10000, "out of memory BufBuilder");
+            }
+            else {
+                data = 0;
+            }
+            l = 0;
+        }
         ~_BufBuilder() { kill(); }
 
         void kill() {
             if ( data ) {
-                al.Free(data);
+                al.Free(data, size);
                 data = 0;
             }
         }
@@ -116,7 +261,7 @@ namespace mongo {
         void reset( int maxSize ) {
             l = 0;
             if ( maxSize && size > maxSize ) {
-                al.Free(data);
+                al.Free(data, size);
                 data = (char*)al.Malloc(maxSize);
                 if ( data == 0 )
                     msgasserted( 15913 , "out of memory BufBuilder::reset" );
@@ -134,7 +279,14 @@ namespace mongo {
         const char* buf() const { return data; }
 
         /* assume ownership of the buffer - you must then free() it */
-        void decouple() { data = 0; }
+        void decouple() {
+            if ( al.arena() )
+                msgasserted(16069, "can't decouple a BufBuilder's buffer from its Arena");
+            data = 0;
+        }
+
+        /** @return the arena the buffer is in, or 0 if it was malloc()ed */
+        Arena* arena() const { return al.arena(); }
 
         void appendUChar(unsigned char j) {
             *((unsigned char*)grow(sizeof(unsigned char))) = j;
@@ -208,7 +360,7 @@ namespace mongo {
                 ss << "BufBuilder attempted to grow() to " << a << " bytes, past the 64MB limit.";
                 msgasserted(13548, ss.str().c_str());
             }
-            void* newData = al.Realloc(data, a);
+            void* newData = al.Realloc(data, size, a);
             if (newData == 0) msgasserted(16062, "out of memory BufBuilder::grow_reallocate");
             data = (char*) newData;
             size= a;
@@ -310,6 +462,9 @@ namespace mongo {
         void reset( int maxSize = 0 ) { _buf.reset( maxSize ); }
 
         std::string str() const { return std::string(_buf.data, _buf.l); }
+
+        /** the contents, without a copy.  valid until the next append or reset */
+        StringData stringData() const { return StringData( _buf.data, _buf.l ); }
         
         int len() const { return _buf.l; }
 
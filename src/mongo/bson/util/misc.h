@@ -19,6 +19,7 @@
 
 #pragma once
 
+#include <cstring>
 #include <ctime>
 
 namespace mongo {
@@ -93,11 +94,13 @@ namespace mongo {
 
     // Like strlen, but only scans up to n bytes.
     // Returns -1 if no '0' found.
+    // memchr is word at a time / vectorized in the C libraries we build against, which matters
+    // here as this is called for every field name when validating incoming BSON.
     inline int strnlen( const char *s, int n ) {
-        for( int i = 0; i < n; ++i )
-            if ( !s[ i ] )
-                return i;
-        return -1;
+        if ( n <= 0 )
+            return -1;
+        const char *p = (const char *) memchr( s, 0, n );
+        return p ? (int) ( p - s ) : -1;
     }
 
     inline bool isNumber( char c ) {
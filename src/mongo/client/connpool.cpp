@@ -37,17 +37,24 @@ namespace mongo {
     }
 
     void PoolForHost::done( DBConnectionPool * pool, DBClientBase * c ) {
+        _inUse--;
+        add( pool , c );
+    }
+
+    void PoolForHost::add( DBConnectionPool * pool , const StoredConnection& sc ) {
         if ( _pool.size() >= _maxPerHost ) {
-            pool->onDestroy( c );
-            delete c;
+            pool->onDestroy( sc.conn );
+            delete sc.conn;
         }
         else {
-            _pool.push(c);
+            _pool.push( sc );
         }
     }
 
     DBClientBase * PoolForHost::get( DBConnectionPool * pool , double socketTimeout ) {
 
+        _inUse++;
+
         time_t now = time(0);
         
         while ( ! _pool.empty() ) {
@@ -104,6 +111,88 @@ namespace mongo {
     }
 
 
+    void PoolForHost::takeIdle( vector<StoredConnection>& out , time_t idleSince ) {
+        vector<StoredConnection> all;
+        while ( ! _pool.empty() ) {
+            StoredConnection c = _pool.top();
+            _pool.pop();
+
+            if ( c.when <= idleSince )
+                out.push_back( c );
+            else
+                all.push_back( c );
+        }
+
+        // put back the recently used ones in the order they were
+        for ( vector<StoredConnection>::reverse_iterator i = all.rbegin(); i != all.rend(); ++i ) {
+            _pool.push( *i );
+        }
+    }
+
+    void PoolForHost::checked( DBConnectionPool * pool , const StoredConnection& sc , bool ok ) {
+        if ( ok ) {
+            // just checked, so it isn't checked again until it has been idle a while once more
+            add( pool , StoredConnection( sc.conn ) );
+            return;
+        }
+        _healthCheckFailures++;
+        pool->onDestroy( sc.conn );
+        delete sc.conn;
+    }
+
+    void PoolForHost::dequeue( unsigned long long ticket ) {
+        for ( std::deque<unsigned long long>::iterator i = _waiters.begin(); i != _waiters.end(); ++i ) {
+            if ( *i == ticket ) {
+                _waiters.erase( i );
+                return;
+            }
+        }
+        assert( false );
+    }
+
+    void PoolForHost::gotAfter( int millis ) {
+        if ( millis < 0 ) {
+            _timeouts++;
+            return;
+        }
+        int b = 0;
+        for ( int limit = 1; millis >= limit && b < WaitBuckets - 1; limit *= 10 )
+            b++;
+        _waits[b]++;
+    }
+
+    int PoolForHost::numToWarm() const {
+        // only hosts we have connected to: a key may be for a host that is down or misspelled
+        if ( _minPerHost == 0 || _created == 0 )
+            return 0;
+        int n = (int)_minPerHost - numAvailable() - _inUse;
+        // the extra would be destroyed on the way in
+        n = min( n , (int)_maxPerHost - numAvailable() );
+        return max( n , 0 );
+    }
+
+    void PoolForHost::taskDone( int millisSinceLast ) {
+        if ( millisSinceLast > 0 )
+            _createdPerSec = ( _created - _createdAtLastTask ) * 1000.0 / millisSinceLast;
+        _createdAtLastTask = _created;
+    }
+
+    void PoolForHost::appendInfo( BSONObjBuilder& b ) const {
+        b.append( "available" , numAvailable() );
+        b.appendNumber( "created" , numCreated() );
+        b.append( "inUse" , _inUse );
+        b.append( "waiting" , numWaiting() );
+        b.append( "createdPerSec" , _createdPerSec );
+        b.appendNumber( "timeouts" , _timeouts );
+        b.appendNumber( "healthCheckFailures" , _healthCheckFailures );
+
+        static const char * const bucketNames[WaitBuckets] = { "0-1ms" , "1-10ms" , "10-100ms" , "100-1000ms" , "1000ms+" };
+        BSONObjBuilder waits( b.subobjStart( "waits" ) );
+        for ( int i = 0; i < WaitBuckets; i++ )
+            waits.appendNumber( bucketNames[i] , _waits[i] );
+        waits.done();
+    }
+
     PoolForHost::StoredConnection::StoredConnection( DBClientBase * c ) {
         conn = c;
         when = time(0);
@@ -121,6 +210,9 @@ namespace mongo {
     }
 
     unsigned PoolForHost::_maxPerHost = 50;
+    unsigned PoolForHost::_maxInUse = 0;
+    unsigned PoolForHost::_minPerHost = 0;
+    int PoolForHost::_maxWaitMillis = 30000;
 
     // ------ DBConnectionPool ------
 
@@ -136,9 +228,54 @@ namespace mongo {
         assert( ! inShutdown() );
         scoped_lock L(_mutex);
         PoolForHost& p = _pools[PoolKey(ident,socketTimeout)];
+        _waitForSlot( p , ident , L );
         return p.get( this , socketTimeout );
     }
 
+    void DBConnectionPool::_waitForSlot( PoolForHost& p , const string& ident , scoped_lock& L ) {
+        if ( p.numWaiting() == 0 && p.hasSlot() ) {
+            p.gotAfter( 0 );
+            return;
+        }
+
+        // wait our turn, first come first served
+        unsigned long long ticket = p.enqueue();
+        Timer t;
+        int maxWait = PoolForHost::getMaxWaitMillis();
+        boost::xtime deadline = incxtimemillis( maxWait );
+        while ( ! ( p.isNext( ticket ) && p.hasSlot() ) ) {
+            if ( ! _slotFreed.timed_wait( L.boost() , deadline ) && ! ( p.isNext( ticket ) && p.hasSlot() ) ) {
+                p.dequeue( ticket );
+                p.gotAfter( -1 );
+                _slotFreed.notify_all();
+                uasserted( 16071 , str::stream() << _name << ": timed out after " << maxWait << "ms waiting for a connection to "
+                                                 << ident << ", " << p.numInUse() << " in use" );
+            }
+        }
+        p.dequeue( ticket );
+        p.gotAfter( t.millis() );
+        // the next in line may be able to go too
+        _slotFreed.notify_all();
+    }
+
+    void DBConnectionPool::_discarded( const string& ident , double socketTimeout ) {
+        scoped_lock L(_mutex);
+        _pools[PoolKey(ident,socketTimeout)].discarded();
+        _slotFreed.notify_all();
+    }
+
+    DBClientBase* DBConnectionPool::_handOut( const string& ident , double socketTimeout , DBClientBase* c ) {
+        try {
+            onHandedOut( c );
+        }
+        catch ( std::exception& ) {
+            delete c;
+            _discarded( ident , socketTimeout );
+            throw;
+        }
+        return c;
+    }
+
     DBClientBase* DBConnectionPool::_finishCreate( const string& host , double socketTimeout , DBClientBase* conn ) {
         {
             scoped_lock L(_mutex);
@@ -152,6 +289,7 @@ namespace mongo {
         }
         catch ( std::exception & ) {
             delete conn;
+            _discarded( host , socketTimeout );
             throw;
         }
 
@@ -160,55 +298,124 @@ namespace mongo {
 
     DBClientBase* DBConnectionPool::get(const ConnectionString& url, double socketTimeout) {
         DBClientBase * c = _get( url.toString() , socketTimeout );
-        if ( c ) {
-            try {
-                onHandedOut( c );
-            }
-            catch ( std::exception& ) {
-                delete c;
-                throw;
-            }
-            return c;
-        }
+        if ( c )
+            return _handOut( url.toString() , socketTimeout , c );
 
         string errmsg;
-        c = url.connect( errmsg, socketTimeout );
+        try {
+            c = url.connect( errmsg, socketTimeout );
+        }
+        catch ( std::exception& ) {
+            _discarded( url.toString() , socketTimeout );
+            throw;
+        }
+        if ( ! c )
+            _discarded( url.toString() , socketTimeout );
         uassert( 13328 ,  _name + ": connect failed " + url.toString() + " : " + errmsg , c );
 
         return _finishCreate( url.toString() , socketTimeout , c );
     }
 
     DBClientBase* DBConnectionPool::get(const string& host, double socketTimeout) {
+        string errmsg;
+        ConnectionString cs = ConnectionString::parse( host , errmsg );
+        uassert( 13071 , (string)"invalid hostname [" + host + "]" + errmsg , cs.isValid() );
+
         DBClientBase * c = _get( host , socketTimeout );
-        if ( c ) {
-            try {
-                onHandedOut( c );
-            }
-            catch ( std::exception& ) {
-                delete c;
-                throw;
-            }
-            return c;
-        }
+        if ( c )
+            return _handOut( host , socketTimeout , c );
+        return _create( host , cs , socketTimeout );
+    }
 
+    DBClientBase* DBConnectionPool::getIfSlotFree(const string& host, double socketTimeout) {
         string errmsg;
         ConnectionString cs = ConnectionString::parse( host , errmsg );
         uassert( 13071 , (string)"invalid hostname [" + host + "]" + errmsg , cs.isValid() );
 
-        c = cs.connect( errmsg, socketTimeout );
-        if ( ! c )
+        DBClientBase * c;
+        {
+            scoped_lock L(_mutex);
+            PoolForHost& p = _pools[PoolKey(host,socketTimeout)];
+            if ( p.numWaiting() || ! p.hasSlot() )
+                return 0;
+            p.gotAfter( 0 );
+            c = p.get( this , socketTimeout );
+        }
+        if ( c )
+            return _handOut( host , socketTimeout , c );
+        return _create( host , cs , socketTimeout );
+    }
+
+    DBClientBase* DBConnectionPool::_create( const string& host , const ConnectionString& cs , double socketTimeout ) {
+        string errmsg;
+        DBClientBase * c;
+        try {
+            c = cs.connect( errmsg, socketTimeout );
+        }
+        catch ( std::exception& ) {
+            _discarded( host , socketTimeout );
+            throw;
+        }
+        if ( ! c ) {
+            _discarded( host , socketTimeout );
             throw SocketException( SocketException::CONNECT_ERROR , host , 11002 , str::stream() << _name << " error: " << errmsg );
+        }
         return _finishCreate( host , socketTimeout , c );
     }
 
     void DBConnectionPool::release(const string& host, DBClientBase *c) {
+        _release( host , c , true );
+    }
+
+    void DBConnectionPool::releaseParked(const string& host, DBClientBase *c) {
+        _release( host , c , false );
+    }
+
+    void DBConnectionPool::_release( const string& host , DBClientBase *c , bool inUse ) {
+        double socketTimeout = c->getSoTimeout();
         if ( c->isFailed() ) {
             onDestroy( c );
             delete c;
+            if ( inUse )
+                _discarded( host , socketTimeout );
             return;
         }
         scoped_lock L(_mutex);
-        _pools[PoolKey(host,c->getSoTimeout())].done(this,c);
+        PoolForHost& p = _pools[PoolKey(host,socketTimeout)];
+        if ( ! inUse ) {
+            p.add( this , c );
+            return;
+        }
+        p.done(this,c);
+        _slotFreed.notify_all();
+    }
+
+    void DBConnectionPool::discard(const string& host, DBClientBase *c) {
+        double socketTimeout = c->getSoTimeout();
+        delete c;
+        _discarded( host , socketTimeout );
+    }
+
+    void DBConnectionPool::park(const string& host, DBClientBase *c) {
+        _discarded( host , c->getSoTimeout() );
+    }
+
+    DBClientBase* DBConnectionPool::unpark(const string& host, DBClientBase *c) {
+        double socketTimeout = c->getSoTimeout();
+        {
+            scoped_lock L(_mutex);
+            PoolForHost& p = _pools[PoolKey(host,socketTimeout)];
+            try {
+                _waitForSlot( p , host , L );
+            }
+            catch ( std::exception& ) {
+                // someone else can have it once a slot frees up
+                p.add( this , c );
+                throw;
+            }
+            p.reused();
+        }
+        return _handOut( host , socketTimeout , c );
     }
 
 
@@ -259,6 +466,8 @@ namespace mongo {
 
         int avail = 0;
         long long created = 0;
+        int inUse = 0;
+        int waiting = 0;
 
 
         map<ConnectionString::ConnectionType,long long> createdByType;
@@ -275,12 +484,13 @@ namespace mongo {
                 string s = str::stream() << i->first.ident << "::" << i->first.timeout;
 
                 BSONObjBuilder temp( bb.subobjStart( s ) );
-                temp.append( "available" , i->second.numAvailable() );
-                temp.appendNumber( "created" , i->second.numCreated() );
+                i->second.appendInfo( temp );
                 temp.done();
 
                 avail += i->second.numAvailable();
                 created += i->second.numCreated();
+                inUse += i->second.numInUse();
+                waiting += i->second.numWaiting();
 
                 long long& x = createdByType[i->second.type()];
                 x += i->second.numCreated();
@@ -322,6 +532,8 @@ namespace mongo {
 
         b.append( "totalAvailable" , avail );
         b.appendNumber( "totalCreated" , created );
+        b.append( "totalInUse" , inUse );
+        b.append( "totalWaiting" , waiting );
     }
 
     bool DBConnectionPool::serverNameCompare::operator()( const string& a , const string& b ) const{
@@ -363,13 +575,27 @@ namespace mongo {
 
     void DBConnectionPool::taskDoWork() { 
         vector<DBClientBase*> toDelete;
+        vector< pair<PoolKey,PoolForHost::StoredConnection> > toCheck;
         
         {
             // we need to get the connections inside the lock
             // but we can actually delete them outside
             scoped_lock lk( _mutex );
+            int millis = _sinceTask.millis();
+            _sinceTask.reset();
+
+            // connections used since the last pass are known to be good
+            time_t idleSince = time(0) - 60;
+
             for ( PoolMap::iterator i=_pools.begin(); i!=_pools.end(); ++i ) {
                 i->second.getStaleConnections( toDelete );
+
+                vector<PoolForHost::StoredConnection> idle;
+                i->second.takeIdle( idle , idleSince );
+                for ( size_t j=0; j<idle.size(); j++ )
+                    toCheck.push_back( make_pair( i->first , idle[j] ) );
+
+                i->second.taskDone( millis );
             }
         }
 
@@ -382,6 +608,68 @@ namespace mongo {
                 // we don't care if there was a socket error
             }
         }
+
+        // check the long idle connections, so that get() does not hand out one the other end closed
+        for ( size_t i=0; i<toCheck.size(); i++ ) {
+            DBClientBase* c = toCheck[i].second.conn;
+            bool ok = false;
+            try {
+                bool isMaster;
+                ok = c->isMaster( isMaster ) && ! c->isFailed();
+            }
+            catch ( std::exception& e ) {
+                LOG(1) << _name << ": health check of connection to " << c->getServerAddress() << " failed" << causedBy( e.what() ) << endl;
+            }
+
+            scoped_lock lk( _mutex );
+            _pools[toCheck[i].first].checked( this , toCheck[i].second , ok );
+        }
+
+        _warm();
+    }
+
+    void DBConnectionPool::_warm() {
+        vector< pair<PoolKey,int> > toWarm;
+        {
+            scoped_lock lk( _mutex );
+            for ( PoolMap::iterator i=_pools.begin(); i!=_pools.end(); ++i ) {
+                int n = i->second.numToWarm();
+                if ( n > 0 )
+                    toWarm.push_back( make_pair( i->first , n ) );
+            }
+        }
+
+        for ( size_t i=0; i<toWarm.size(); i++ ) {
+            const PoolKey& key = toWarm[i].first;
+            string errmsg;
+            ConnectionString cs = ConnectionString::parse( key.ident , errmsg );
+            if ( ! cs.isValid() )
+                continue;
+
+            for ( int j=0; j<toWarm[i].second; j++ ) {
+                DBClientBase* c = 0;
+                try {
+                    c = cs.connect( errmsg , key.timeout );
+                    if ( c )
+                        onCreate( c );
+                }
+                catch ( std::exception& e ) {
+                    delete c;
+                    c = 0;
+                    errmsg = e.what();
+                }
+
+                if ( ! c ) {
+                    LOG(1) << _name << ": couldn't open a connection ahead of need to " << key.ident << causedBy( errmsg ) << endl;
+                    break;
+                }
+
+                scoped_lock lk( _mutex );
+                PoolForHost& p = _pools[key];
+                p.createdOne( c );
+                p.add( this , c );
+            }
+        }
     }
 
     // ------ ScopedDbConnection ------
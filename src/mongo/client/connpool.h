@@ -18,10 +18,12 @@
 #pragma once
 
 #include <stack>
+#include <deque>
 #include "dbclient.h"
 #include "redef_macros.h"
 
 #include "../util/background.h"
+#include "../util/timer.h"
 
 namespace mongo {
 
@@ -35,12 +37,22 @@ namespace mongo {
     class PoolForHost {
     public:
         PoolForHost()
-            : _created(0) {}
+            : _created(0) , _inUse(0) , _nextTicket(0) , _timeouts(0) ,
+              _healthCheckFailures(0) , _createdAtLastTask(0) , _createdPerSec(0) {
+            memset( _waits , 0 , sizeof( _waits ) );
+        }
 
         PoolForHost( const PoolForHost& other ) {
             assert(other._pool.size() == 0);
             _created = other._created;
             assert( _created == 0 );
+            _inUse = 0;
+            _nextTicket = 0;
+            _timeouts = 0;
+            _healthCheckFailures = 0;
+            _createdAtLastTask = 0;
+            _createdPerSec = 0;
+            memset( _waits , 0 , sizeof( _waits ) );
         }
 
         ~PoolForHost();
@@ -53,20 +65,40 @@ namespace mongo {
         ConnectionString::ConnectionType type() const { assert(_created); return _type; }
 
         /**
-         * gets a connection or return NULL
+         * gets a connection or return NULL, in which case the caller is to create one.
+         * either way the caller then holds one of the maxInUse slots, until done() or discarded()
          */
         DBClientBase * get( DBConnectionPool * pool , double socketTimeout );
 
         void done( DBConnectionPool * pool , DBClientBase * c );
 
+        /** a connection from get() was destroyed rather than given back with done() */
+        void discarded() { _inUse--; }
+
+        /** a connection kept outside of the pool is in use again */
+        void reused() { _inUse++; }
+
+        /** connections handed out by get() and not yet given back */
+        int numInUse() const { return _inUse; }
+
+        /** @return true if fewer than maxInUse connections are in use */
+        bool hasSlot() const { return _maxInUse == 0 || _inUse < (int)_maxInUse; }
+
+        /** join the back of the queue of threads waiting for a slot.  @return the ticket to wait with */
+        unsigned long long enqueue() { _waiters.push_back( _nextTicket ); return _nextTicket++; }
+        /** @return true if no one is queued ahead of ticket */
+        bool isNext( unsigned long long ticket ) const { return _waiters.front() == ticket; }
+        /** leave the queue, having got a slot or given up */
+        void dequeue( unsigned long long ticket );
+        int numWaiting() const { return (int)_waiters.size(); }
+
+        /** records how long a get() waited for a slot, -1 if it timed out */
+        void gotAfter( int millis );
+
         void flush();
         
         void getStaleConnections( vector<DBClientBase*>& stale );
 
-        static void setMaxPerHost( unsigned max ) { _maxPerHost = max; }
-        static unsigned getMaxPerHost() { return _maxPerHost; }
-    private:
-
         struct StoredConnection {
             StoredConnection( DBClientBase * c );
 
@@ -76,12 +108,59 @@ namespace mongo {
             time_t when;
         };
 
+        /** keep an idle connection, or destroy it if maxPerHost are kept already */
+        void add( DBConnectionPool * pool , const StoredConnection& sc );
+
+        /** removes the connections idle since before idleSince, to be checked outside of the pool's lock */
+        void takeIdle( vector<StoredConnection>& out , time_t idleSince );
+        /** returns a connection from takeIdle() as it was, or destroys it if it failed */
+        void checked( DBConnectionPool * pool , const StoredConnection& sc , bool ok );
+
+        /** the number of connections to open so that this host has minPerHost */
+        int numToWarm() const;
+
+        /** called on each pass of the pool's background task */
+        void taskDone( int millisSinceLast );
+
+        void appendInfo( BSONObjBuilder& b ) const;
+
+        static void setMaxPerHost( unsigned max ) { _maxPerHost = max; }
+        static unsigned getMaxPerHost() { return _maxPerHost; }
+
+        /** the most connections to a host that may be in use at once, 0 for no limit */
+        static void setMaxInUse( unsigned max ) { _maxInUse = max; }
+        static unsigned getMaxInUse() { return _maxInUse; }
+
+        /** connections the background task opens ahead of need, for each host already connected to */
+        static void setMinPerHost( unsigned min ) { _minPerHost = min; }
+        static unsigned getMinPerHost() { return _minPerHost; }
+
+        /** how long a get() waits for a slot before failing */
+        static void setMaxWaitMillis( int millis ) { _maxWaitMillis = millis; }
+        static int getMaxWaitMillis() { return _maxWaitMillis; }
+
+    private:
+
         std::stack<StoredConnection> _pool;
         
         long long _created;
         ConnectionString::ConnectionType _type;
 
+        int _inUse;
+        std::deque<unsigned long long> _waiters; // tickets, in order of arrival
+        unsigned long long _nextTicket;
+
+        enum { WaitBuckets = 5 };
+        long long _waits[WaitBuckets]; // by log10 of the milliseconds waited: <1, <10, <100, <1000, more
+        long long _timeouts;
+        long long _healthCheckFailures;
+        long long _createdAtLastTask;
+        double _createdPerSec;
+
         static unsigned _maxPerHost;
+        static unsigned _maxInUse;
+        static unsigned _minPerHost;
+        static int _maxWaitMillis;
     };
 
     class DBConnectionHook {
@@ -126,8 +205,33 @@ namespace mongo {
         DBClientBase *get(const string& host, double socketTimeout = 0);
         DBClientBase *get(const ConnectionString& host, double socketTimeout = 0);
 
+        /**
+         * as get(), but never waits for a slot: returns NULL if PoolForHost::getMaxInUse()
+         * connections to host are in use already or others are waiting for one.
+         */
+        DBClientBase *getIfSlotFree(const string& host, double socketTimeout = 0);
+
         void release(const string& host, DBClientBase *c);
 
+        /** destroy a connection from get() that will not be released, e.g. one left in a bad state */
+        void discard(const string& host, DBClientBase *c);
+
+        /**
+         * give back the slot of a connection from get() that the caller keeps idle for itself,
+         * e.g. a thread's cached shard connection.  it is not available to other threads but is
+         * not in use either.
+         */
+        void park(const string& host, DBClientBase *c);
+
+        /**
+         * take a slot again for a connection given to park(), waiting for one as get() does.
+         * if none frees up in time, c goes to the pool's idle connections and this throws.
+         */
+        DBClientBase *unpark(const string& host, DBClientBase *c);
+
+        /** as release(), for a connection given to park() */
+        void releaseParked(const string& host, DBClientBase *c);
+
         void addHook( DBConnectionHook * hook ); // we take ownership
         void appendInfo( BSONObjBuilder& b );
 
@@ -144,7 +248,25 @@ namespace mongo {
         
         DBClientBase* _get( const string& ident , double socketTimeout );
 
+        /** with _mutex held by L, wait our turn in p's queue until p has a slot; throws 16071 on timeout */
+        void _waitForSlot( PoolForHost& p , const string& ident , scoped_lock& L );
+
+        /** inUse is false for a connection given to park() */
+        void _release( const string& host , DBClientBase *c , bool inUse );
+
         DBClientBase* _finishCreate( const string& ident , double socketTimeout, DBClientBase* conn );
+
+        /** connect to host for a caller holding a slot, which it gives back if that fails */
+        DBClientBase* _create( const string& host , const ConnectionString& cs , double socketTimeout );
+
+        /** hand a connection from _get() to the caller, destroying it if a hook fails */
+        DBClientBase* _handOut( const string& ident , double socketTimeout , DBClientBase* c );
+
+        /** give back the slot of a connection from _get() that was destroyed or never created */
+        void _discarded( const string& ident , double socketTimeout );
+
+        /** open connections to hosts with fewer than PoolForHost::getMinPerHost() */
+        void _warm();
         
         struct PoolKey {
             PoolKey( string i , double t ) : ident( i ) , timeout( t ) {}
@@ -163,6 +285,10 @@ namespace mongo {
         
         PoolMap _pools;
 
+        // notified whenever a slot is freed or a waiter leaves a queue.  shared by all the hosts
+        boost::condition _slotFreed;
+        Timer _sinceTask;
+
         // pointers owned by me, right now they leak on shutdown
         // _hooks itself also leaks because it creates a shutdown race condition
         list<DBConnectionHook*> * _hooks; 
@@ -251,7 +377,9 @@ namespace mongo {
             a bad state.  Destructor will do this too, but it is verbose.
         */
         void kill() {
-            delete _conn;
+            if ( ! _conn )
+                return;
+            pool.discard( _host , _conn );
             _conn = 0;
         }
 
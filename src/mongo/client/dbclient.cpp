@@ -627,9 +627,38 @@ namespace mongo {
         }
 #endif
 
+        if ( cmdLine.networkCompression ) {
+            try {
+                _negotiateCompression();
+            }
+            catch ( DBException& e ) {
+                errmsg = str::stream() << "couldn't connect to server " << _server.toString() << causedBy( e );
+                _failed = true;
+                return false;
+            }
+        }
+
         return true;
     }
 
+    void DBClientConnection::_negotiateCompression() {
+        // a server without compression, or an older one, leaves compression out of the reply,
+        // and so is never sent a compressed message
+        BSONObj info;
+        if ( ! runCommand( "admin" , BSON( "isMaster" << 1 << "compression" << BSON_ARRAY( "snappy" ) ) , info ) )
+            return;
+
+        BSONObjIterator i( info.getObjectField( "compression" ) );
+        while ( i.more() ) {
+            BSONElement e = i.next();
+            if ( e.type() == String && str::equals( e.valuestr() , "snappy" ) ) {
+                p->enableCompression();
+                LOG(1) << "compressing messages to " << _serverString << endl;
+                return;
+            }
+        }
+    }
+
 
     inline bool DBClientConnection::runCommand(const string &dbname, const BSONObj& cmd, BSONObj &info, int options) {
         if ( DBClientWithCommands::runCommand( dbname , cmd , info , options ) )
@@ -969,7 +998,11 @@ namespace mongo {
     }
 
     bool DBClientConnection::recv( Message &m ) {
-        return port().recv(m);
+        if ( !port().recv(m) ) {
+            _failed = true;
+            return false;
+        }
+        return true;
     }
 
     bool DBClientConnection::call( Message &toSend, Message &response, bool assertOk , string * actualServer ) {
@@ -1047,6 +1080,114 @@ namespace mongo {
             say(m);
     }
 
+    /* -- DBClientPipeline ---------------------------------------------- */
+
+    bool DBClientPipeline::Reply::join() {
+        while ( !_done ) {
+            assert( _pipeline );
+            _pipeline->receiveOne();
+        }
+        return _ok;
+    }
+
+    int DBClientPipeline::Reply::nReturned() const {
+        assert( _done && _ok );
+        return ( (QueryResult *) _m.singleData() )->nReturned;
+    }
+
+    long long DBClientPipeline::Reply::cursorId() const {
+        assert( _done && _ok );
+        return ( (QueryResult *) _m.singleData() )->cursorId;
+    }
+
+    void DBClientPipeline::Reply::documents( vector<BSONObj>& out ) const {
+        QueryResult *qr = (QueryResult *) _m.singleData();
+        const char *p = qr->data();
+        for ( int i = 0; i < nReturned(); i++ ) {
+            BSONObj o( p );
+            out.push_back( o );
+            p += o.objsize();
+        }
+    }
+
+    BSONObj DBClientPipeline::Reply::result() const {
+        if ( nReturned() == 0 )
+            return BSONObj();
+        return BSONObj( ( (QueryResult *) _m.singleData() )->data() ).copy();
+    }
+
+    DBClientPipeline::~DBClientPipeline() {
+        DESTRUCTOR_GUARD( join(); );
+        for ( map<unsigned,ReplyPtr>::iterator i = _inFlight.begin(); i != _inFlight.end(); ++i )
+            i->second->_pipeline = 0;
+    }
+
+    DBClientPipeline::ReplyPtr DBClientPipeline::call( Message& toSend , const Callback& callback ) {
+        if ( _conn.isFailed() ) {
+            // say() may reconnect, and replies to what was sent before it will never arrive
+            failAll();
+        }
+        _conn.say( toSend );
+        ReplyPtr reply( new Reply( this , callback ) );
+        _inFlight[ toSend.header()->id ] = reply;
+        return reply;
+    }
+
+    DBClientPipeline::ReplyPtr DBClientPipeline::query( const string& ns , Query query , int nToReturn , int nToSkip ,
+                                                        const BSONObj* fieldsToReturn , int queryOptions ,
+                                                        const Callback& callback ) {
+        Message toSend;
+        assembleRequest( ns , query.obj , nToReturn , nToSkip , fieldsToReturn , queryOptions , toSend );
+        return call( toSend , callback );
+    }
+
+    DBClientPipeline::ReplyPtr DBClientPipeline::runCommand( const string& dbname , const BSONObj& cmd , int options ,
+                                                             const Callback& callback ) {
+        return query( dbname + ".$cmd" , cmd , -1 , 0 , 0 , options , callback );
+    }
+
+    bool DBClientPipeline::join() {
+        bool ok = true;
+        while ( !_inFlight.empty() ) {
+            ReplyPtr reply = _inFlight.begin()->second;
+            if ( !reply->join() )
+                ok = false;
+        }
+        return ok;
+    }
+
+    void DBClientPipeline::receiveOne() {
+        Message m;
+        if ( !_conn.recv( m ) ) {
+            failAll();
+            return;
+        }
+
+        map<unsigned,ReplyPtr>::iterator i = _inFlight.find( m.header()->responseTo );
+        massert( 16070 , str::stream() << "DBClientPipeline: reply to an unknown request "
+                                       << (unsigned) m.header()->responseTo << " from " << _conn.getServerAddress() ,
+                 i != _inFlight.end() );
+        ReplyPtr reply = i->second;
+        _inFlight.erase( i );
+        reply->_m = m;
+        complete( reply , true );
+    }
+
+    void DBClientPipeline::failAll() {
+        while ( !_inFlight.empty() ) {
+            ReplyPtr reply = _inFlight.begin()->second;
+            _inFlight.erase( _inFlight.begin() );
+            complete( reply , false );
+        }
+    }
+
+    void DBClientPipeline::complete( const ReplyPtr& reply , bool ok ) {
+        reply->_done = true;
+        reply->_ok = ok;
+        if ( reply->_callback )
+            reply->_callback( *reply );
+    }
+
 #ifdef MONGO_SSL
     SSLManager* DBClientConnection::sslManager() {
         if ( _sslManager )
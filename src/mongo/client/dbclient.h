@@ -1006,6 +1006,8 @@ namespace mongo {
         map< string, pair<string,string> > authCache;
         double _so_timeout;
         bool _connect( string& errmsg );
+        /** ask the server to compress large replies, see --networkCompression */
+        void _negotiateCompression();
 
         static AtomicUInt _numConnections;
         static bool _lazyKillCursor; // lazy means we piggy back kill cursors on next op
@@ -1016,6 +1018,103 @@ namespace mongo {
 #endif
     };
 
+    /** Sends requests over one DBClientConnection without waiting for the reply to each before
+        sending the next, so that many requests may be in flight on a single connection.
+
+        Each request returns a Reply, a future: its reply is matched by responseTo, and is read
+        off the connection when it is joined or when a later reply is.  A callback given with the
+        request is run as its reply arrives, from whichever call read it.
+
+        e.g.
+          DBClientPipeline p( conn );
+          DBClientPipeline::ReplyPtr a = p.runCommand( "admin" , BSON( "ping" << 1 ) );
+          DBClientPipeline::ReplyPtr b = p.query( "test.foo" , QUERY( "x" << 1 ) , 1 );
+          if ( b->join() ) cout << b->result() << endl;
+
+        Not thread safe.  Nothing else may read from the connection while requests are in flight;
+        writes made without waiting for a reply, such as insert(), may be interleaved.
+    */
+    class DBClientPipeline : boost::noncopyable {
+    public:
+        class Reply;
+        typedef shared_ptr<Reply> ReplyPtr;
+        typedef boost::function<void( Reply& )> Callback;
+
+        class Reply : boost::noncopyable {
+        public:
+            bool isDone() const { return _done; }
+
+            /** blocks until the reply has arrived, or the connection failed
+                @return ok()
+             */
+            bool join();
+
+            /** false if the connection failed before the reply arrived */
+            bool ok() const {
+                assert( _done );
+                return _ok;
+            }
+
+            /** the reply message */
+            Message& message() {
+                assert( _done && _ok );
+                return _m;
+            }
+
+            /** a query's first batch: the number of documents in it */
+            int nReturned() const;
+            /** a query's cursor, 0 if all of the results were in the first batch */
+            long long cursorId() const;
+            /** a query's first batch, pointing into message() */
+            void documents( vector<BSONObj>& out ) const;
+            /** a copy of the first document of a query or command reply, empty if none */
+            BSONObj result() const;
+
+        private:
+            friend class DBClientPipeline;
+            Reply( DBClientPipeline* pipeline , const Callback& callback ) :
+                _pipeline( pipeline ), _callback( callback ), _done( false ), _ok( false ) {}
+
+            DBClientPipeline* _pipeline; // 0 once the pipeline is gone
+            Callback _callback;
+            Message _m;
+            bool _done;
+            bool _ok;
+        };
+
+        DBClientPipeline( DBClientConnection& conn ) : _conn( conn ) {}
+
+        /** reads the replies still in flight, so the connection may be used as before */
+        ~DBClientPipeline();
+
+        /** send a message that has a reply, such as a query or getMore */
+        ReplyPtr call( Message& toSend , const Callback& callback = Callback() );
+
+        ReplyPtr query( const string& ns , Query query , int nToReturn = 0 , int nToSkip = 0 ,
+                        const BSONObj* fieldsToReturn = 0 , int queryOptions = 0 ,
+                        const Callback& callback = Callback() );
+
+        /** see DBClientWithCommands::runCommand().  the command's result is reply->result() */
+        ReplyPtr runCommand( const string& dbname , const BSONObj& cmd , int options = 0 ,
+                             const Callback& callback = Callback() );
+
+        /** the number of requests whose replies have not been read */
+        int inFlight() const { return _inFlight.size(); }
+
+        /** reads every reply in flight.  @return false if the connection failed */
+        bool join();
+
+    private:
+        /** read the next reply off the connection, and complete its request */
+        void receiveOne();
+        /** the connection failed: no reply in flight will arrive */
+        void failAll();
+        void complete( const ReplyPtr& reply , bool ok );
+
+        DBClientConnection& _conn;
+        map<unsigned,ReplyPtr> _inFlight; // by request id
+    };
+
     /** pings server to check if it's up
      */
     bool serverAlive( const string &uri );
@@ -29,6 +29,7 @@ namespace mongo {
 
     void DBClientCursor::_finishConsInit() {
         _originalHost = _client->toString();
+        _prefetchConn = 0;
     }
 
     int DBClientCursor::nextBatchSize() {
@@ -103,6 +104,29 @@ namespace mongo {
         return ! retry;
     }
 
+    void DBClientCursor::_assembleGetMore( Message& toSend ) {
+        BufBuilder b;
+        b.appendNum(opts);
+        b.appendStr(ns);
+        b.appendNum(nextBatchSize());
+        b.appendNum(cursorId);
+        toSend.setData(dbGetMore, b.buf(), b.len());
+    }
+
+    /** dataReceived() for a reply that came on a connection this cursor doesn't keep */
+    void DBClientCursor::_dataReceivedOn( DBClientBase *conn ) {
+        _client = conn;
+        try {
+            dataReceived();
+        }
+        catch ( ... ) {
+            // the connection goes back to the pool (or away) as we unwind
+            _client = 0;
+            throw;
+        }
+        _client = 0;
+    }
+
     void DBClientCursor::requestMore() {
         assert( cursorId && batch.pos == batch.nReturned );
 
@@ -110,15 +134,21 @@ namespace mongo {
             nToReturn -= batch.nReturned;
             assert(nToReturn > 0);
         }
-        BufBuilder b;
-        b.appendNum(opts);
-        b.appendStr(ns);
-        b.appendNum(nextBatchSize());
-        b.appendNum(cursorId);
+        auto_ptr<Message> response(new Message());
+
+        if ( _prefetchConn ) {
+            // the getMore went out with the last batch still unread
+            scoped_ptr<ScopedDbConnection> conn( _prefetchConn );
+            _prefetchConn = 0;
+            uassert( 16066 , "getMore: no reply to prefetched request" , (*conn)->recv( *response ) );
+            this->batch.m = response;
+            _dataReceivedOn( conn->get() );
+            conn->done();
+            return;
+        }
 
         Message toSend;
-        toSend.setData(dbGetMore, b.buf(), b.len());
-        auto_ptr<Message> response(new Message());
+        _assembleGetMore( toSend );
 
         if ( _client ) {
             _client->call( toSend, *response );
@@ -129,14 +159,57 @@ namespace mongo {
             assert( _scopedHost.size() );
             ScopedDbConnection conn( _scopedHost );
             conn->call( toSend , *response );
-            _client = conn.get();
             this->batch.m = response;
-            dataReceived();
-            _client = 0;
+            _dataReceivedOn( conn.get() );
             conn.done();
         }
     }
 
+    void DBClientCursor::prefetchMore() {
+        if ( _prefetchConn || _client || _scopedHost.empty() || ! cursorId || ! _putBack.empty() )
+            return;
+        if ( opts & ( QueryOption_CursorTailable | QueryOption_Exhaust ) )
+            return;
+        if ( haveLimit && nToReturn <= batch.nReturned )
+            return;
+
+        // ask for what requestMore() would once this batch is read
+        const int toReturn = nToReturn;
+        if ( haveLimit )
+            nToReturn -= batch.nReturned;
+        Message toSend;
+        _assembleGetMore( toSend );
+        nToReturn = toReturn;
+
+        // this is only a head start, so it takes a connection only if one is to be had right
+        // away, and gives up on any error: requestMore() will ask again when it needs to
+        DBClientBase *c;
+        try {
+            c = pool.getIfSlotFree( _scopedHost );
+        }
+        catch ( std::exception& e ) {
+            LOG(1) << "DBClientCursor::prefetchMore couldn't get a connection to " << _scopedHost << ": " << e.what() << endl;
+            return;
+        }
+        if ( ! c )
+            return;
+
+        auto_ptr<ScopedDbConnection> conn( new ScopedDbConnection( _scopedHost , c ) );
+        if ( ! conn->get()->lazySupported() ) {
+            conn->done();
+            return;
+        }
+        try {
+            conn->get()->say( toSend );
+        }
+        catch ( std::exception& e ) {
+            LOG(1) << "DBClientCursor::prefetchMore getMore to " << _scopedHost << " failed: " << e.what() << endl;
+            conn->kill();
+            return;
+        }
+        _prefetchConn = conn.release();
+    }
+
     /** with QueryOption_Exhaust, the server just blasts data at us (marked at end with cursorid==0). */
     void DBClientCursor::exhaustReceiveMore() {
         assert( cursorId && batch.pos == batch.nReturned );
@@ -301,6 +374,13 @@ namespace mongo {
 
         DESTRUCTOR_GUARD (
 
+        if ( _prefetchConn ) {
+            // the reply to the prefetched getMore is still on its way, so the connection can't be reused
+            _prefetchConn->kill();
+            delete _prefetchConn;
+            _prefetchConn = 0;
+        }
+
         if ( cursorId && _ownCursor && ! inShutdown() ) {
             BufBuilder b;
             b.appendNum( (int)0 ); // reserved
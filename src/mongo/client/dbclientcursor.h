@@ -26,6 +26,7 @@
 namespace mongo {
 
     class AScopedConnection;
+    class ScopedDbConnection;
 
     /** for mock purposes only -- do not create variants of DBClientCursor, nor hang code here 
         @see DBClientMockCursor
@@ -163,6 +164,15 @@ namespace mongo {
 
         void attach( AScopedConnection * conn );
 
+        /**
+         * Sends the getMore for the batch after this one without waiting for it, so the server
+         * produces it while this batch is read; more() picks it up when this batch runs out.
+         * Only for attached cursors, as the request needs a connection of its own until then.
+         * Does nothing if there is nothing more to ask for or a request is already out, nor if
+         * no pooled connection to the host is free right away.  Never throws.
+         */
+        void prefetchMore();
+
         string originalHost() const { return _originalHost; }
 
         Message* getMessage(){ return batch.m.get(); }
@@ -210,11 +220,14 @@ namespace mongo {
         string _scopedHost;
         string _lazyHost;
         bool wasError;
+        ScopedDbConnection *_prefetchConn; // holds a getMore sent by prefetchMore(), if any
 
         void dataReceived() { bool retry; string lazyHost; dataReceived( retry, lazyHost ); }
         void dataReceived( bool& retry, string& lazyHost );
+        void _dataReceivedOn( DBClientBase *conn );
         void requestMore();
         void exhaustReceiveMore(); // for exhaust
+        void _assembleGetMore( Message& toSend );
 
         // Don't call from a virtual function
         void _assertIfNull() const { uassert(13348, "connection died", this); }
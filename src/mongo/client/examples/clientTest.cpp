@@ -31,6 +31,13 @@
 using namespace std;
 using namespace mongo;
 
+/** counts the replies it is called back with */
+struct Count {
+    Count( int& n ) : _n( n ) {}
+    void operator()( DBClientPipeline::Reply& ) { _n++; }
+    int& _n;
+};
+
 int main( int argc, const char **argv ) {
 
     const char *port = "27017";
@@ -246,6 +253,40 @@ int main( int argc, const char **argv ) {
         //MONGO_PRINT(out);
     }
 
+    {
+        // test pipelining
+
+        const char * pns = "test.pipeline";
+        conn.dropCollection( pns );
+        for ( int i = 0; i < 10; i++ )
+            conn.insert( pns , BSON( "_id" << i ) );
+
+        DBClientPipeline p( conn );
+        vector<DBClientPipeline::ReplyPtr> replies;
+        for ( int i = 0; i < 10; i++ )
+            replies.push_back( p.query( pns , QUERY( "_id" << i ) , 1 ) );
+        int called = 0;
+        DBClientPipeline::ReplyPtr ping = p.runCommand( "admin" , BSON( "ping" << 1 ) , 0 , Count( called ) );
+        assert( p.inFlight() == 11 );
+
+        // reads the replies sent before it too
+        assert( replies[ 9 ]->join() );
+        assert( replies[ 0 ]->isDone() );
+        assert( ! ping->isDone() );
+        for ( int i = 0; i < 10; i++ ) {
+            assert( replies[ i ]->nReturned() == 1 );
+            assert( replies[ i ]->result()[ "_id" ].numberInt() == i );
+        }
+
+        assert( p.join() );
+        assert( called == 1 );
+        assert( ping->result()[ "ok" ].trueValue() );
+        assert( p.inFlight() == 0 );
+
+        // the connection is used as before
+        assert( conn.count( pns ) == 10 );
+    }
+
     { 
         // test timeouts
 
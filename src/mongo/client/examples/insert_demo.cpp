@@ -4,7 +4,7 @@
    How to build and run:
 
    Using mongo_client_lib.cpp:
-    g++ -I .. -I ../.. insert_demo.cpp ../mongo_client_lib.cpp -lboost_thread-mt -lboost_filesystem
+    g++ -I .. -I ../.. insert_demo.cpp ../mongo_client_lib.cpp ../../../third_party/snappy/snappy.cc ../../../third_party/snappy/snappy-sinksource.cc -lboost_thread-mt -lboost_filesystem
     ./a.out
 */
 
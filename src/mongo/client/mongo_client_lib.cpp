@@ -5,13 +5,14 @@
    Normally one includes dbclient.h, and links against libmongoclient.a, when connecting to MongoDB
    from C++.  However, if you have a situation where the pre-built library does not work, you can use
    this file instead to build all the necessary symbols.  To do so, include mongo_client_lib.cpp in your
-   project.
+   project, along with snappy.cc and snappy-sinksource.cc from third_party/snappy, which are compiled
+   on their own as they don't build cleanly with the rest.
 
    GCC
    ---
    For example, to build and run simple_client_demo.cpp with GCC and run it:
 
-    g++ -I .. simple_client_demo.cpp mongo_client_lib.cpp -lboost_thread-mt -lboost_filesystem
+    g++ -I .. simple_client_demo.cpp mongo_client_lib.cpp ../../third_party/snappy/snappy.cc ../../third_party/snappy/snappy-sinksource.cc -lboost_thread-mt -lboost_filesystem
     ./a.out
 
    Visual Studio (2010 tested)
@@ -57,6 +58,7 @@
 #include "../util/log.cpp"
 #include "../util/password.cpp"
 #include "../util/net/message_port.cpp"
+#include "../util/compress.cpp"
 #include "../util/concurrency/thread_pool.cpp"
 #include "../util/concurrency/vars.cpp"
 #include "../util/concurrency/task.cpp"
@@ -291,15 +291,15 @@ namespace mongo {
 
     // --------  FilteringClientCursor -----------
     FilteringClientCursor::FilteringClientCursor( const BSONObj filter )
-        : _matcher( filter ) , _pcmData( NULL ), _done( true ) {
+        : _matcher( filter ) , _pcmData( NULL ), _done( true ), _prefetch( false ) {
     }
 
     FilteringClientCursor::FilteringClientCursor( auto_ptr<DBClientCursor> cursor , const BSONObj filter )
-        : _matcher( filter ) , _cursor( cursor ) , _pcmData( NULL ), _done( cursor.get() == 0 ) {
+        : _matcher( filter ) , _cursor( cursor ) , _pcmData( NULL ), _done( cursor.get() == 0 ), _prefetch( false ) {
     }
 
     FilteringClientCursor::FilteringClientCursor( DBClientCursor* cursor , const BSONObj filter )
-        : _matcher( filter ) , _cursor( cursor ) , _pcmData( NULL ), _done( cursor == 0 ) {
+        : _matcher( filter ) , _cursor( cursor ) , _pcmData( NULL ), _done( cursor == 0 ), _prefetch( false ) {
     }
 
 
@@ -360,6 +360,9 @@ namespace mongo {
             if ( _matcher.matches( _next ) ) {
                 if ( ! _cursor->moreInCurrentBatch() )
                     _next = _next.getOwned();
+                // a no-op unless a batch has just come in
+                if ( _prefetch )
+                    _cursor->prefetchMore();
                 return;
             }
             _next = BSONObj();
@@ -1133,6 +1136,7 @@ namespace mongo {
             PCMData& mdata = i->second;
 
             _cursors[ index ].reset( mdata.pcState->cursor.get(), &mdata );
+            _cursors[ index ].prefetch( true );
             _servers.insert( ServerAndQuery( i->first.getConnString(), BSONObj() ) );
 
             index++;
@@ -1372,6 +1376,7 @@ namespace mongo {
                 try {
                     _cursors[i].raw()->attach( conns[i].get() ); // this calls done on conn
                     _checkCursor( _cursors[i].raw() );
+                    _cursors[i].prefetch( true );
 
                     finishedQueries++;
                 }
@@ -137,6 +137,9 @@ namespace mongo {
 
         BSONObj peek();
 
+        /** keep a getMore in flight for the batch after the current one, see DBClientCursor::prefetchMore() */
+        void prefetch( bool on ) { _prefetch = on; }
+
         DBClientCursor* raw() { return _cursor.get(); }
         ParallelConnectionMetadata* rawMData(){ return _pcmData; }
 
@@ -155,6 +158,7 @@ namespace mongo {
 
         BSONObj _next;
         bool _done;
+        bool _prefetch;
     };
 
 
@@ -9,7 +9,7 @@
     ./a.out
 
    (2) using client_lib.cpp:
-    g++ -I .. simple_client_demo.cpp mongo_client_lib.cpp -lboost_thread-mt -lboost_filesystem
+    g++ -I .. simple_client_demo.cpp mongo_client_lib.cpp ../../third_party/snappy/snappy.cc ../../third_party/snappy/snappy-sinksource.cc -lboost_thread-mt -lboost_filesystem
     ./a.out
 */
 
@@ -326,7 +326,7 @@ namespace mongo {
         KeyNode kn = keyNode(this->n-1);
         recLoc = kn.recordLoc;
         key.assign(kn.key);
-        int keysize = kn.key.dataSize();
+        int keysize = storedSize(this->n-1);
 
         massert( 10283 , "rchild not null in btree popBack()", this->nextChild.isNull());
 
@@ -344,7 +344,7 @@ namespace mongo {
     /** add a key.  must be > all existing.  be careful to set next ptr right. */
     template< class V >
     bool BucketBasics<V>::_pushBack(const DiskLoc recordLoc, const Key& key, const Ordering &order, const DiskLoc prevChild) {
-        int bytesNeeded = key.dataSize() + sizeof(_KeyNode);
+        int bytesNeeded = bytesToStore(key) + sizeof(_KeyNode);
         if ( bytesNeeded > this->emptySize )
             return false;
         assert( bytesNeeded <= this->emptySize );
@@ -362,10 +362,7 @@ namespace mongo {
         _KeyNode& kn = k(this->n++);
         kn.prevChildBucket = prevChild;
         kn.recordLoc = recordLoc;
-        kn.setKeyDataOfs( (short) _alloc(key.dataSize()) );
-        short ofs = kn.keyDataOfs();
-        char *p = dataAt(ofs);
-        memcpy(p, key.data(), key.dataSize());
+        storeKey(kn, key, false);
 
         return true;
     }
@@ -382,9 +379,10 @@ namespace mongo {
     bool BucketBasics<V>::basicInsert(const DiskLoc thisLoc, int &keypos, const DiskLoc recordLoc, const Key& key, const Ordering &order) const {
         check( this->n < 1024 );
         check( keypos >= 0 && keypos <= this->n );
-        int bytesNeeded = key.dataSize() + sizeof(_KeyNode);
+        int bytesNeeded = this->bytesToStore(key) + sizeof(_KeyNode);
         if ( bytesNeeded > this->emptySize ) {
             _pack(thisLoc, order, keypos);
+            bytesNeeded = this->bytesToStore(key) + sizeof(_KeyNode); // a v2 pack may change the reference key
             if ( bytesNeeded > this->emptySize )
                 return false;
         }
@@ -414,10 +412,7 @@ namespace mongo {
         _KeyNode& kn = b->k(keypos);
         kn.prevChildBucket.Null();
         kn.recordLoc = recordLoc;
-        kn.setKeyDataOfs((short) b->_alloc(key.dataSize()) );
-        char *p = b->dataAt(kn.keyDataOfs());
-        getDur().declareWriteIntent(p, key.dataSize());
-        memcpy(p, key.data(), key.dataSize());
+        b->storeKey(kn, key, true);
         return true;
     }
 
@@ -553,7 +548,7 @@ namespace mongo {
         // TODO I think we only want to do the 90% split on the rhs node of the tree.
         int rightSizeLimit = ( this->topSize + sizeof( _KeyNode ) * this->n ) / ( keypos == this->n ? 10 : 2 );
         for( int i = this->n - 1; i > -1; --i ) {
-            rightSize += keyNode( i ).key.dataSize() + sizeof( _KeyNode );
+            rightSize += storedSize( i ) + sizeof( _KeyNode );
             if ( rightSize > rightSizeLimit ) {
                 split = i;
                 break;
@@ -585,9 +580,26 @@ namespace mongo {
         _KeyNode &kn = k( i );
         kn.recordLoc = recordLoc;
         kn.prevChildBucket = prevChildBucket;
+        storeKey( kn, key, false );
+    }
+
+    template< class V >
+    int BucketBasics<V>::storedSize( int i ) const {
+        return keyNode( i ).key.dataSize();
+    }
+
+    template< class V >
+    int BucketBasics<V>::bytesToStore( const Key &key ) const {
+        return key.dataSize();
+    }
+
+    template< class V >
+    void BucketBasics<V>::storeKey( _KeyNode &kn, const Key &key, bool declare ) {
         short ofs = (short) _alloc( key.dataSize() );
         kn.setKeyDataOfs( ofs );
         char *p = dataAt( ofs );
+        if ( declare )
+            getDur().declareWriteIntent( p, key.dataSize() );
         memcpy( p, key.data(), key.dataSize() );
     }
 
@@ -601,6 +613,232 @@ namespace mongo {
         _packReadyForMod( order, refpos );
     }
 
+    /* - v2 (prefix compressed) buckets ---------------------------------- */
+
+    /**
+     * @return the number of leading bytes of key that match c.  At least one
+     * byte of every key is stored, so this is less than the size of key.  Keys
+     * in BSON format share nothing, so that they are always read in one piece.
+     */
+    static int sharedPrefix( const KeyV2 &key, const char *c, int clen ) {
+        if ( !key.isCompactFormat() ) {
+            return 0;
+        }
+        int m = min( clen, key.dataSize() - 1 );
+        int i = 0;
+        while( i < m && key.at( i ) == c[ i ] ) {
+            ++i;
+        }
+        return i;
+    }
+
+    /**
+     * A packed bucket is rewritten around a new reference key, rather than split,
+     * when that frees at least this many bytes.
+     */
+    static const int RebaseSaving = BtreeData_V2::BucketSize / 16;
+
+    template<>
+    BucketBasics<V2>::Key BucketBasics<V2>::keyOf( const _KeyNode &kn ) const {
+        return Key( this->data + this->refOfs, kn._shared, this->data + kn.keyDataOfs(), kn._size );
+    }
+
+    template<>
+    int BucketBasics<V2>::storedSize( int i ) const {
+        return k( i )._size - k( i )._shared;
+    }
+
+    template<>
+    int BucketBasics<V2>::bytesToStore( const Key &key ) const {
+        if ( this->refSize == 0 ) {
+            // key will be the reference key, stored whole
+            return key.dataSize();
+        }
+        return key.dataSize() - sharedPrefix( key, this->data + this->refOfs, this->refSize );
+    }
+
+    template<>
+    void BucketBasics<V2>::storeKey( _KeyNode &kn, const Key &key, bool declare ) {
+        int size = key.dataSize();
+        int shared = this->refSize == 0 ? 0 : sharedPrefix( key, this->data + this->refOfs, this->refSize );
+        short ofs = (short) _alloc( size - shared );
+        kn.setKeyDataOfs( ofs );
+        kn._shared = shared;
+        kn._size = size;
+        char *p = dataAt( ofs );
+        if ( declare )
+            getDur().declareWriteIntent( p, size - shared );
+        key.copyTo( shared, size, p );
+        if ( this->refSize == 0 ) {
+            // the first key stored in a bucket becomes its reference key
+            if ( declare )
+                getDur().declareWriteIntent( &this->refOfs, sizeof( this->refOfs ) + sizeof( this->refSize ) );
+            this->refOfs = ofs;
+            this->refSize = size;
+        }
+    }
+
+    /**
+     * A new right half of a split keeps the reference key, so its keys take no more room than
+     * before.  Nothing shares a key in BSON format, so such a reference key is left behind.
+     */
+    template<>
+    void BucketBasics<V2>::adoptReference( const BucketBasics<V2> &src ) {
+        assert( this->n == 0 && this->refSize == 0 );
+        if ( src.refSize == 0 || !KeyV1( src.data + src.refOfs ).isCompactFormat() )
+            return;
+        short ofs = (short) _alloc( src.refSize );
+        memcpy( dataAt( ofs ), src.data + src.refOfs, src.refSize );
+        this->refOfs = ofs;
+        this->refSize = src.refSize;
+    }
+
+    template<>
+    int BucketBasics<V2>::referenceOwner() const {
+        if ( this->refSize == 0 )
+            return -1;
+        for( int j = 0; j < this->n; ++j ) {
+            if ( k( j )._shared == 0 && k( j ).keyDataOfs() == (short) this->refOfs )
+                return j;
+        }
+        return -1;
+    }
+
+    /**
+     * The middle key is taken when that saves RebaseSaving bytes, or when the
+     * reference key's own key is gone and the bytes shared with it don't pay
+     * for keeping it.  So a packed bucket never uses more than the full sizes of
+     * its keys, as merging and balancing assume (see packedDataSize()).
+     */
+    template<>
+    int BucketBasics<V2>::newReference() const {
+        if ( this->n == 0 )
+            return -1;
+        int owner = referenceOwner();
+        int candidate = this->n / 2;
+        const Key key = keyOf( k( candidate ) );
+        int csize = key.dataSize();
+        dassert( csize <= V2::KeyMax );
+        char c[ V2::KeyMax ];
+        key.copyTo( 0, csize, c );
+        int shared = 0;
+        int saving = owner < 0 ? this->refSize : 0;
+        for( int j = 0; j < this->n; ++j ) {
+            const _KeyNode &kn = k( j );
+            shared += kn._shared;
+            saving -= kn._shared;
+            if ( j != candidate )
+                saving += sharedPrefix( keyOf( kn ), c, csize );
+        }
+        if ( saving >= RebaseSaving || ( owner < 0 && this->refSize > shared ) )
+            return candidate;
+        return -1;
+    }
+
+    /**
+     * Full key sizes, as in v1: keys moved to another bucket are stored against
+     * its reference key, which may share less with them, but never take more
+     * than their full size.  As in v1 a packed bucket's dropped keys count.
+     */
+    template<>
+    int BucketBasics<V2>::packedDataSize( int refPos ) const {
+        int size = 0;
+        for( int j = 0; j < this->n; ++j ) {
+            if ( !( this->flags & Packed ) && mayDropKey( j, refPos ) ) {
+                continue;
+            }
+            size += k( j )._size + sizeof( _KeyNode );
+        }
+        return size;
+    }
+
+    template<>
+    void BucketBasics<V2>::_pack( const DiskLoc thisLoc, const Ordering &order, int &refPos ) const {
+        if ( ( this->flags & Packed ) && newReference() < 0 )
+            return;
+
+        dassert( thisLoc.btree<V2>() == this );
+        thisLoc.btreemod<V2>()->_packReadyForMod( order, refPos );
+    }
+
+    /**
+     * Also picks the reference key, see newReference(), so that a bucket whose
+     * keys have drifted from its reference key is recompressed instead of split.
+     */
+    template<>
+    void BucketBasics<V2>::_packReadyForMod( const Ordering &order, int &refPos ) {
+        assertWritable();
+
+        if ( ( this->flags & Packed ) && newReference() < 0 )
+            return;
+
+        int i = 0;
+        for ( int j = 0; j < this->n; j++ ) {
+            if( mayDropKey( j, refPos ) ) {
+                continue; // key is unused and has no children - drop it
+            }
+            if( i != j ) {
+                if ( refPos == j ) {
+                    refPos = i; // i < j so j will never be refPos again
+                }
+                k( i ) = k( j );
+            }
+            ++i;
+        }
+        if ( refPos == this->n ) {
+            refPos = i;
+        }
+        this->n = i;
+
+        int rebase = newReference();
+        int owner = rebase < 0 ? referenceOwner() : rebase;
+        int refSize = this->n == 0 ? 0 : this->refSize;
+        char c[ V2::KeyMax ];
+        if ( rebase >= 0 ) {
+            const Key key = keyOf( k( rebase ) );
+            refSize = key.dataSize();
+            key.copyTo( 0, refSize, c );
+        }
+
+        int tdz = totalDataSize();
+        char temp[V2::BucketSize];
+        int ofs = tdz;
+        int refOfs = 0;
+        if ( owner < 0 && refSize > 0 ) {
+            // kept although its key is gone
+            ofs -= refSize;
+            memcpy( temp + ofs, this->data + this->refOfs, refSize );
+            refOfs = ofs;
+        }
+        for ( int j = 0; j < this->n; j++ ) {
+            _KeyNode &kn = k( j );
+            Key key = keyOf( kn );
+            int shared = j == owner ? 0 : rebase >= 0 ? sharedPrefix( key, c, refSize ) : kn._shared;
+            ofs -= kn._size - shared;
+            key.copyTo( shared, kn._size, temp + ofs );
+            kn.setKeyDataOfsSavingUse( ofs );
+            kn._shared = shared;
+            if ( j == owner ) {
+                refOfs = ofs;
+            }
+        }
+        int dataUsed = tdz - ofs;
+        memcpy( this->data + ofs, temp + ofs, dataUsed );
+
+        this->topSize = dataUsed;
+        this->refOfs = refOfs;
+        this->refSize = refSize;
+        this->emptySize = tdz - dataUsed - this->n * sizeof( _KeyNode );
+        {
+            int foo = this->emptySize;
+            assert( foo >= 0 );
+        }
+
+        setPacked();
+
+        assertValid( order );
+    }
+
     /* - BtreeBucket --------------------------------------------------- */
 
     /** @return largest key in the subtree. */
@@ -983,7 +1221,7 @@ namespace mongo {
         const BtreeBucket *r = BTREE(this->childForPos( leftIndex + 1 ));
 
         int KNS = sizeof( _KeyNode );
-        int rightSizeLimit = ( l->topSize + l->n * KNS + keyNode( leftIndex ).key.dataSize() + KNS + r->topSize + r->n * KNS ) / 2;
+        int rightSizeLimit = ( l->packedDataSize( 0 ) + keyNode( leftIndex ).key.dataSize() + KNS + r->packedDataSize( 0 ) ) / 2;
         // This constraint should be ensured by only calling this function
         // if we go below the low water mark.
         assert( rightSizeLimit < BtreeBucket<V>::bodySize() );
@@ -1364,6 +1602,7 @@ namespace mongo {
         BtreeBucket *r = rLoc.btreemod<V>();
         if ( split_debug )
             out() << "     split:" << split << ' ' << keyNode(split).key.toString() << " n:" << this->n << endl;
+        r->adoptReference( *this );
         for ( int i = split+1; i < this->n; i++ ) {
             KeyNode kn = keyNode(i);
             r->pushBack(kn.recordLoc, kn.key, order, kn.prevChildBucket);
@@ -1503,6 +1742,67 @@ namespace mongo {
         return DiskLoc();
     }
 
+    template< class V >
+    bool BtreeBucket<V>::countKeys(DiskLoc &thisLoc, int &keyOfs, const DiskLoc &endLoc, int endOfs,
+                                   long long &maxKeys, long long &n) {
+        while ( !thisLoc.isNull() ) {
+            const BtreeBucket *b = BTREE(thisLoc);
+            while ( 1 ) {
+                if ( thisLoc == endLoc && keyOfs == endOfs )
+                    return true;
+                if ( b->k(keyOfs).isUsed() )
+                    ++n;
+                if ( --maxKeys <= 0 )
+                    return false;
+                // stop at the end of the bucket or where a child must be descended into
+                if ( keyOfs + 1 >= b->n || !b->childForPos(keyOfs + 1).isNull() )
+                    break;
+                ++keyOfs;
+            }
+            thisLoc = b->advance(thisLoc, keyOfs, 1, "countKeys");
+        }
+        return true;
+    }
+
+    template< class V >
+    double BtreeBucket<V>::estimateRank(const IndexDetails& idx, const Key& key, const DiskLoc &recordLoc, const Ordering &order) {
+        double base = 0;
+        double width = 1;
+        DiskLoc loc = idx.head;
+        while ( !loc.isNull() ) {
+            const BtreeBucket *b = BTREE(loc);
+            int p;
+            b->find(idx, key, recordLoc, order, p, /*assertIfDup*/ false);
+            width /= b->n + 1;
+            base += width * p;
+            loc = b->childForPos(p);
+        }
+        return base;
+    }
+
+    template< class V >
+    DiskLoc BtreeBucket<V>::keyAtRank(const IndexDetails& idx, double rank, int& keyOfs) {
+        DiskLoc loc = idx.head;
+        while ( 1 ) {
+            const BtreeBucket *b = BTREE(loc);
+            if ( b->n == 0 )
+                return DiskLoc();
+            // a rank from estimateRank must map back to the slot it was summed from despite rounding
+            double slot = rank * ( b->n + 1 );
+            int i = min( max( (int) ( slot + 1e-9 ), 0 ), (int) b->n );
+            DiskLoc child = b->childForPos(i);
+            if ( child.isNull() ) {
+                // the key after the slot sorts at or after every key ranked before it.  The last
+                // slot has none in this bucket (it is up in an ancestor), so that takes the key
+                // before it, the last one here, which is as near as one descent gets
+                keyOfs = min( i, b->n - 1 );
+                return loc;
+            }
+            rank = slot - i;
+            loc = child;
+        }
+    }
+
     template< class V >
     DiskLoc BtreeBucket<V>::locate(const IndexDetails& idx, const DiskLoc& thisLoc, const BSONObj& key, const Ordering &order, int& pos, bool& found, const DiskLoc &recordLoc, int direction) const {
         KeyOwned k(key);
@@ -1949,8 +2249,10 @@ namespace mongo {
 
     template class BucketBasics<V0>;
     template class BucketBasics<V1>;
+    template class BucketBasics<V2>;
     template class BtreeBucket<V0>;
     template class BtreeBucket<V1>;
+    template class BtreeBucket<V2>;
     template struct __KeyNode<DiskLoc>;
     template struct __KeyNode<DiskLoc56Bit>;
 
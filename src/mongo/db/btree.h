@@ -123,6 +123,18 @@ namespace mongo {
         }
     };
 
+    /**
+     * The _KeyNode of a v2 (prefix compressed) bucket.  The first _shared bytes
+     * of the key are those of the bucket's reference key and are not stored;
+     * keyDataOfs() locates the remaining _size - _shared bytes.
+     */
+    template< class Loc >
+    struct __KeyNodeV2 : public __KeyNode<Loc> {
+        unsigned short _shared;
+        /** Full size of the key. */
+        unsigned short _size;
+    };
+
     /**
      * This structure represents header data for a btree bucket.  An object of
      * this type is typically allocated inside of a buffer of size BucketSize,
@@ -285,8 +297,59 @@ namespace mongo {
         void _init() { }
     };
 
+    /**
+     * v2 buckets have the v1 key format and layout, but store keys prefix
+     * compressed: one key of each bucket, its reference key, is stored whole,
+     * and every other key stores only the bytes following those it shares with
+     * the reference.  Key nodes record the shared length and full size, so a
+     * key is read without touching its neighbors and binary search within a
+     * bucket is unchanged.  Keys are read in place through KeyV2 views.
+     *
+     * Sizes used for merge and balance decisions are full (uncompressed) key
+     * sizes, and a packed bucket never uses more, so v2 buckets split, merge
+     * and balance just as v1 buckets do.
+     */
+    class BtreeData_V2 {
+    public:
+        typedef DiskLoc56Bit Loc;
+        typedef __KeyNodeV2<Loc> _KeyNode;
+        typedef KeyV2 Key;
+        typedef KeyV2Owned KeyOwned;
+        enum { BucketSize = 8192-16 }; // leave room for Record header
+        static const int KeyMax = 1024;
+    protected:
+        /** Parent bucket of this bucket, which isNull() for the root bucket. */
+        Loc parent;
+        /** Given that there are n keys, this is the n index child. */
+        Loc nextChild;
+
+        unsigned short flags;
+
+        /** basicInsert() assumes the next three members are consecutive and in this order: */
+
+        /** Size of the empty region. */
+        unsigned short emptySize;
+        /** Size used for key storage, including the reference key and storage of old keys. */
+        unsigned short topSize;
+        /* Number of keys in the bucket. */
+        unsigned short n;
+
+        /** Offset and size of the reference key.  refSize == 0 if there is none (no keys yet). */
+        unsigned short refOfs;
+        unsigned short refSize;
+
+        /* Beginning of the bucket's body */
+        char data[4];
+
+        void _init() {
+            refOfs = 0;
+            refSize = 0;
+        }
+    };
+
     typedef BtreeData_V0 V0;
     typedef BtreeData_V1 V1;
+    typedef BtreeData_V2 V2;
 
     /**
      * This class adds functionality to BtreeData for managing a single bucket.
@@ -373,6 +436,24 @@ namespace mongo {
     protected:
         char * dataAt(short ofs) { return this->data + ofs; }
 
+        /** @return the key stored for kn */
+        Key keyOf(const _KeyNode &kn) const { return Key(this->data + kn.keyDataOfs()); }
+        /** @return bytes of key data used by key i, which is less than its size in a v2 bucket */
+        int storedSize(int i) const;
+        /** @return bytes of key data needed to add key to this bucket */
+        int bytesToStore(const Key& key) const;
+        /**
+         * Allocate room for key and copy it in, pointing kn at it.
+         * @param declare - declare write intent for what is written, if the bucket isn't writable already
+         */
+        void storeKey(_KeyNode &kn, const Key& key, bool declare);
+        /** Called on a new bucket about to take keys from src.  A v2 bucket copies src's reference key. */
+        void adoptReference(const BucketBasics &src) { }
+        /** v2 only.  @return the key whose stored bytes are the reference key, or -1 if it is gone. */
+        int referenceOwner() const;
+        /** v2 only.  @return the key a pack should make the reference key, or -1 to keep the current one. */
+        int newReference() const;
+
         /** Initialize the header for a new node. */
         void init();
 
@@ -726,6 +807,31 @@ namespace mongo {
          */
         DiskLoc advance(const DiskLoc& thisLoc, int& keyOfs, int direction, const char *caller) const;
 
+        /**
+         * Add to n the used keys in forward order from (thisLoc, keyOfs) up to, but not
+         * including, (endLoc, endOfs), or to the end of the btree if endLoc is null, reading
+         * at most maxKeys keys.  Keys are only tested for being used, never compared, and runs
+         * of keys with no child bucket between them are tallied within their bucket without
+         * calling advance().
+         * @return true if the end was reached.  Otherwise (thisLoc, keyOfs) is left at the last
+         * key read.
+         */
+        static bool countKeys(DiskLoc &thisLoc, int &keyOfs, const DiskLoc &endLoc, int endOfs,
+                              long long &maxKeys, long long &n);
+
+        /**
+         * Estimate, in one descent from the head, the fraction of the index's keys that sort
+         * before (key, recordLoc).  Each of a bucket's n+1 child slots is taken to hold an equal
+         * share of the keys below it, so the result is only as good as the tree is even.
+         */
+        static double estimateRank(const IndexDetails& idx, const Key& key, const DiskLoc &recordLoc, const Ordering &order);
+
+        /**
+         * The inverse of estimateRank: the position of a key about 'rank' of the way through
+         * the index, found in one descent.  Null if the index is empty.
+         */
+        static DiskLoc keyAtRank(const IndexDetails& idx, double rank, int& keyOfs);
+
         /** Advance in specified direction to the specified key */
         void advanceTo(DiskLoc &thisLoc, int &keyOfs, const BSONObj &keyBegin, int keyBeginLen, bool afterKey, const vector< const BSONElement * > &keyEnd, const vector< bool > &keyEndInclusive, const Ordering &order, int direction ) const;
 
@@ -894,7 +1000,7 @@ namespace mongo {
         Key keyAt(int i) const {
             if( i >= this->n ) 
                 return Key();
-            return Key(this->data + k(i).keyDataOfs());
+            return this->keyOf(k(i));
         }
     protected:
 
@@ -988,8 +1094,21 @@ namespace mongo {
     };
 #pragma pack()
 
+    // v2 buckets keep their keys relative to a reference key - see btree.cpp
+    template<> BucketBasics<V2>::Key BucketBasics<V2>::keyOf(const _KeyNode &kn) const;
+    template<> int BucketBasics<V2>::storedSize(int i) const;
+    template<> int BucketBasics<V2>::bytesToStore(const Key& key) const;
+    template<> void BucketBasics<V2>::storeKey(_KeyNode &kn, const Key& key, bool declare);
+    template<> void BucketBasics<V2>::adoptReference(const BucketBasics<V2> &src);
+    template<> int BucketBasics<V2>::referenceOwner() const;
+    template<> int BucketBasics<V2>::newReference() const;
+    template<> int BucketBasics<V2>::packedDataSize( int refPos ) const;
+    template<> void BucketBasics<V2>::_pack(const DiskLoc thisLoc, const Ordering &order, int &refPos) const;
+    template<> void BucketBasics<V2>::_packReadyForMod(const Ordering &order, int &refPos);
+
     class FieldRangeVector;
     class FieldRangeVectorIterator;
+    class ClientCursor;
     
     class BtreeCursor : public Cursor {
     protected:
@@ -1065,6 +1184,16 @@ namespace mongo {
 
         virtual long long nscanned() { return _nscanned; }
 
+        /**
+         * @return the number of keys within this cursor's bounds, counted per btree bucket
+         * without iterating the cursor, or -1 if the bounds can't be split into exact key
+         * intervals (see FieldRangeVector::exactKeyIntervals()).  The cursor is not moved.
+         * Every few thousand keys the count checks for interrupts and lets cc, a ClientCursor
+         * over this cursor, yield.  If cc is deleted while yielding, the keys counted so far
+         * are returned.
+         */
+        long long countExactBounds( ClientCursor *cc ) const;
+
         /** for debugging only */
         const DiskLoc getBucket() const { return bucket; }
         int getKeyOfs() const { return keyOfs; }
@@ -1168,7 +1297,7 @@ namespace mongo {
     template< class V >
     BucketBasics<V>::KeyNode::KeyNode(const BucketBasics<V>& bb, const _KeyNode &k) :
         prevChildBucket(k.prevChildBucket),
-        recordLoc(k.recordLoc), key(bb.data+k.keyDataOfs())
+        recordLoc(k.recordLoc), key(bb.keyOf(k))
     { }
 
 } // namespace mongo;
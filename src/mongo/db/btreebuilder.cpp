@@ -60,6 +60,11 @@ namespace mongo {
         }
     }
 
+    template<class V>
+    void BtreeBuilder<V>::relocked() {
+        b = cur.btreemod<V>();
+    }
+
     template<class V>
     void BtreeBuilder<V>::addKey(BSONObj& _key, DiskLoc loc) {
 
@@ -180,5 +185,6 @@ namespace mongo {
 
     template class BtreeBuilder<V0>;
     template class BtreeBuilder<V1>;
+    template class BtreeBuilder<V2>;
 
 }
@@ -48,6 +48,9 @@ namespace mongo {
         void commit();
 
         unsigned long long getn() { return n; }
+
+        /** call after giving up and retaking the lock, as the bucket being filled may have been remapped */
+        void relocked();
     };
 
 }
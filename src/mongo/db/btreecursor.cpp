@@ -18,6 +18,7 @@
 
 #include "pch.h"
 #include "btree.h"
+#include "clientcursor.h"
 #include "pdfile.h"
 #include "jsobj.h"
 #include "curop-inl.h"
@@ -181,6 +182,7 @@ namespace mongo {
 
     template class BtreeCursorImpl<V0>;
     template class BtreeCursorImpl<V1>;
+    template class BtreeCursorImpl<V2>;
 
     /*
     class BtreeCursorV1 : public BtreeCursor { 
@@ -257,6 +259,9 @@ namespace mongo {
         if( v == 1 ) {
             c = new BtreeCursorImpl<V1>(_d,_idxNo,_id,startKey,endKey,endKeyInclusive,direction);
         }
+        else if( v == 2 ) {
+            c = new BtreeCursorImpl<V2>(_d,_idxNo,_id,startKey,endKey,endKeyInclusive,direction);
+        }
         else if( v == 0 ) {
             c = new BtreeCursorImpl<V0>(_d,_idxNo,_id,startKey,endKey,endKeyInclusive,direction);
         }
@@ -275,6 +280,8 @@ namespace mongo {
         int v = _id.version();
         if( v == 1 )
             return new BtreeCursorImpl<V1>(_d,_idxNo,_id,_bounds,_direction);
+        if( v == 2 )
+            return new BtreeCursorImpl<V2>(_d,_idxNo,_id,_bounds,_direction);
         if( v == 0 )
             return new BtreeCursorImpl<V0>(_d,_idxNo,_id,_bounds,_direction);
         uasserted(14801, str::stream() << "unsupported index version " << v);
@@ -430,6 +437,38 @@ namespace mongo {
         }
     }
 
+    long long BtreeCursor::countExactBounds( ClientCursor *cc ) const {
+        // a multikey index can hold several keys per document
+        if ( !_independentFieldRanges || _multikey || indexDetails.getSpec().getType() ) {
+            return -1;
+        }
+        vector<KeyInterval> intervals;
+        if ( !_bounds->exactKeyIntervals( intervals ) ) {
+            return -1;
+        }
+        const long long keysPerYield = 4096;
+        long long n = 0;
+        long long maxKeys = keysPerYield;
+        for( vector<KeyInterval>::const_iterator i = intervals.begin(); i != intervals.end(); ++i ) {
+            // intervals are in traversal order, the btree is counted in index order
+            bool forward = _direction > 0;
+            BSONObj startKey = forward ? i->_start : i->_end;
+            bool startInclusive = forward ? i->_startInclusive : i->_endInclusive;
+            DiskLoc startLoc = startInclusive ? minDiskLoc : maxDiskLoc;
+            const BSONObj &endKey = forward ? i->_end : i->_start;
+            bool endInclusive = forward ? i->_endInclusive : i->_startInclusive;
+            while( !indexDetails.idxInterface().countRange( indexDetails, startKey, startLoc, endKey,
+                                                            endInclusive, maxKeys, n ) ) {
+                killCurrentOp.checkForInterrupt();
+                if ( !cc->yieldSometimes( ClientCursor::DontNeed ) ) {
+                    return n;
+                }
+                maxKeys = keysPerYield;
+            }
+        }
+        return n;
+    }
+
     string BtreeCursor::toString() {
         string s = string("BtreeCursor ") + indexDetails.indexName();
         if ( _direction < 0 ) s += " reverse";
@@ -117,6 +117,7 @@ namespace mongo {
     {
         _hasWrittenThisPass = false;
         _pageFaultRetryableSection = 0;
+        _opArenaDepth = 0;
         _connectionId = setThreadName(desc);
         _curOp = new CurOp( this );
 #ifndef _WIN32
@@ -583,6 +584,18 @@ namespace mongo {
             _pageFaultRetryableSection->laps() < 1000; 
     }
 
+    Client::OpArenaScope::OpArenaScope( Client& c ) :
+        _c( c ), _allocs( c._opArena.allocs() ), _mallocs( c._opArena.mallocs() ) {
+        _c._opArenaDepth++;
+    }
+
+    Client::OpArenaScope::~OpArenaScope() {
+        // nested operations (e.g. from DBDirectClient) leave the arena to the outermost one,
+        // whose temporaries may still be in use
+        if ( --_c._opArenaDepth == 0 )
+            _c._opArena.reset();
+    }
+
     void OpDebug::reset() {
         extra.reset();
 
@@ -605,6 +618,8 @@ namespace mongo {
         fastmodinsert = false;
         upsert = false;
         keyUpdates = 0;  // unsigned, so -1 not possible
+        arenaAllocs = -1;
+        arenaMallocs = -1;
         
         exceptionInfo.reset();
         
@@ -650,6 +665,8 @@ namespace mongo {
         OPDEBUG_TOSTRING_HELP_BOOL( fastmodinsert );
         OPDEBUG_TOSTRING_HELP_BOOL( upsert );
         OPDEBUG_TOSTRING_HELP( keyUpdates );
+        OPDEBUG_TOSTRING_HELP( arenaAllocs );
+        OPDEBUG_TOSTRING_HELP( arenaMallocs );
         
         if ( extra.len() )
             s << " " << extra.str();
@@ -694,6 +711,8 @@ namespace mongo {
         OPDEBUG_APPEND_BOOL( fastmodinsert );
         OPDEBUG_APPEND_BOOL( upsert );
         OPDEBUG_APPEND_NUMBER( keyUpdates );
+        OPDEBUG_APPEND_NUMBER( arenaAllocs );
+        OPDEBUG_APPEND_NUMBER( arenaMallocs );
 
         if ( ! exceptionInfo.empty() ) 
             exceptionInfo.append( b , "exception" , "exceptionCode" );
@@ -129,6 +129,27 @@ namespace mongo {
         
         bool allowedToThrowPageFaultException() const;
 
+        /** memory for the temporaries of the operation being run (see OpArenaScope), or 0 when
+            there isn't one.  whatever is built in it must be gone by the end of the operation.
+        */
+        Arena* opArena() { return _opArenaDepth ? &_opArena : 0; }
+
+        /** an operation's use of opArena(); everything in it is released when the outermost
+            operation's scope ends */
+        class OpArenaScope : boost::noncopyable {
+        public:
+            OpArenaScope( Client& c );
+            ~OpArenaScope();
+            /** @return allocations the arena served since this scope began */
+            long long allocs() const { return _c._opArena.allocs() - _allocs; }
+            /** @return mallocs the arena made since this scope began */
+            long long mallocs() const { return _c._opArena.mallocs() - _mallocs; }
+        private:
+            Client& _c;
+            unsigned long long _allocs;
+            unsigned long long _mallocs;
+        };
+
     private:
         Client(const char *desc, AbstractMessagingPort *p = 0);
         friend class CurOp;
@@ -148,6 +169,9 @@ namespace mongo {
 
         bool _hasWrittenThisPass;
         PageFaultRetryableSection *_pageFaultRetryableSection;
+
+        Arena _opArena;
+        int _opArenaDepth;
         
         friend class PageFaultRetryableSection; // TEMP
     public:
@@ -63,6 +63,7 @@ namespace mongo {
         ("bind_ip", po::value<string>(&cmdLine.bind_ip), "comma separated list of ip addresses to listen on - all local ips by default")
         ("maxConns",po::value<int>(), "max number of simultaneous connections")
         ("objcheck", "inspect client data for validity on receipt")
+        ("networkCompression", "compress large messages to and from other servers run with this option")
         ("logpath", po::value<string>() , "log file to send write to instead of stdout - has to be a file, not directory" )
         ("logappend" , "append to logpath instead of over-writing" )
         ("pidfilepath", po::value<string>(), "full path to pidfile (if not set, no pidfile is created)")
@@ -256,6 +257,10 @@ namespace mongo {
             cmdLine.objcheck = true;
         }
 
+        if (params.count("networkCompression")) {
+            cmdLine.networkCompression = true;
+        }
+
         if (params.count("bind_ip")) {
             // passing in wildcard is the same as default behavior; remove and warn
             if ( cmdLine.bind_ip ==  "0.0.0.0" ) {
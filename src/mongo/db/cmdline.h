@@ -102,6 +102,7 @@ namespace mongo {
         int durOptions;          // --durOptions <n> for debugging
 
         bool objcheck;         // --objcheck
+        bool networkCompression; // --networkCompression
 
         long long oplogSize;   // --oplogSize
         int defaultProfile;    // --profile
@@ -156,7 +157,7 @@ namespace mongo {
     inline CmdLine::CmdLine() :
         port(DefaultDBPort), rest(false), jsonp(false), quiet(false), noTableScan(false), prealloc(true), preallocj(true), smallfiles(sizeof(int*) == 4),
         configsvr(false),
-        quota(false), quotaFiles(8), cpu(false), durOptions(0), objcheck(false), oplogSize(0), defaultProfile(0), slowMS(100), pretouch(0), moveParanoia( true ),
+        quota(false), quotaFiles(8), cpu(false), durOptions(0), objcheck(false), networkCompression(false), oplogSize(0), defaultProfile(0), slowMS(100), pretouch(0), moveParanoia( true ),
         syncdelay(60), noUnixSocket(false), doFork(0), socket("/tmp") 
     {
         started = time(0);
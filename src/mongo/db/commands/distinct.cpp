@@ -63,6 +63,8 @@ namespace mongo {
 
             shared_ptr<Cursor> cursor;
             if ( ! query.isEmpty() ) {
+                // the optimizer picks the most selective plan, which is covered
+                // below when its index holds the key and every queried field
                 cursor = NamespaceDetailsTransient::getCursor(ns.c_str() , query , BSONObj() );
             }
             else {
@@ -93,6 +95,15 @@ namespace mongo {
             
             assert( cursor );
             string cursorName = cursor->toString();
+
+            // values come from the index key when the cursor's index has the key field, isn't
+            // multikey (a key holds one of an array's values, not the array), and the matcher
+            // never needs the full document
+            bool indexOnly =
+                ! cursor->modifiedKeys() &&
+                ! cursor->isMultiKey() &&
+                cursor->indexKeyPattern()[ key ].isNumber() &&
+                ( ! cursor->matcher() || ! cursor->matcher()->needRecord() );
             
             auto_ptr<ClientCursor> cc (new ClientCursor(QueryOption_NoCursorTimeout, cursor, ns));
 
@@ -147,6 +158,7 @@ namespace mongo {
                 b.appendNumber( "nscannedObjects" , nscannedObjects );
                 b.appendNumber( "timems" , t.millis() );
                 b.append( "cursor" , cursorName );
+                b.appendBool( "indexOnly" , indexOnly );
                 result.append( "stats" , b.obj() );
             }
 
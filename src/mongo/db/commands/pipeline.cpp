@@ -269,20 +269,45 @@ namespace mongo {
         while(!tempVector.empty()) {
             intrusive_ptr<DocumentSource> &pSource = tempVector.front();
 
-            /* hang on to this in advance, in case it is a group */
+            /* hang on to this in advance, in case it is a group or sort */
             DocumentSourceGroup *pGroup =
                 dynamic_cast<DocumentSourceGroup *>(pSource.get());
+            DocumentSourceSort *pSort =
+                dynamic_cast<DocumentSourceSort *>(pSource.get());
 
             /* move the source from the tempVector to the shard sourceVector */
             pShardPipeline->sourceVector.push_back(pSource);
             tempVector.erase(tempVector.begin());
 
             /*
-              If we found a group, that's a split point.
+              A sort followed by a group is left whole on the shards: the
+              group is the better split point, since its merger only sees
+              each shard's partial results.
              */
-            if (pGroup) {
-                /* start this pipeline with the group merger */
-                sourceVector.push_back(pGroup->createMerger());
+            if (pSort) {
+                for(size_t tempn = tempVector.size(), tempi = 0;
+                    tempi < tempn; ++tempi) {
+                    if (dynamic_cast<DocumentSourceGroup *>(
+                            tempVector[tempi].get())) {
+                        pSort = NULL;
+                        break;
+                    }
+                }
+            }
+
+            /*
+              If we found a group or a sort, that's a split point.
+
+              A sort is done on the shards, each of which only returns its
+              first limit documents if the sort has a limit.  The sort
+              merger then interleaves the shards' sorted results here.
+             */
+            if (pGroup || pSort) {
+                /* start this pipeline with the group or sort merger */
+                if (pGroup)
+                    sourceVector.push_back(pGroup->createMerger());
+                else
+                    sourceVector.push_back(pSort->createMerger());
 
                 /* and then add everything that remains and quit */
                 for(size_t tempn = tempVector.size(), tempi = 0;
@@ -114,8 +114,14 @@ namespace mongo {
                     fullName.c_str(), *pQueryObj, *pSortObj));
 
             if (pSortedCursor.get()) {
-                /* success:  remove the sort from the pipeline */
-                pSources->erase(pSources->begin());
+                /*
+                  success:  remove the sort from the pipeline, but keep any
+                  limit it absorbed
+                */
+                if (pSort->getLimit())
+                    pSources->front() = pSort->createLimit();
+                else
+                    pSources->erase(pSources->begin());
 
                 pCursor = pSortedCursor;
                 initSort = true;
@@ -35,8 +35,13 @@ namespace mongo {
         void addKeys(const IndexSpec& spec, const BSONObj& o, DiskLoc loc) { 
             BSONObjSet keys;
             spec.getKeys(o, keys);
+            addKeys(keys, loc);
+        }
+
+        /** keys already generated from the record at loc */
+        void addKeys(const BSONObjSet& keys, DiskLoc loc) { 
             int k = 0;
-            for ( BSONObjSet::iterator i=keys.begin(); i != keys.end(); i++ ) {
+            for ( BSONObjSet::const_iterator i=keys.begin(); i != keys.end(); i++ ) {
                 if( ++k == 2 ) {
                     multi = true;
                 }
@@ -47,4 +52,11 @@ namespace mongo {
         }
     };
 
+    /**
+     * Phase one for nidx bottom up index builds out of a single scan of ns: the keys of specs[i]
+     * go to phase1[i], whose sorter the caller has set up.  Key generation runs on worker
+     * threads when the collection is large enough; sorter insertion stays on this thread.
+     */
+    void sortPhaseOneScan(const char *ns, NamespaceDetails *d, const IndexSpec *specs, SortPhaseOne *phase1, int nidx, ProgressMeterHolder& pm);
+
 }
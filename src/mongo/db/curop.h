@@ -66,6 +66,8 @@ namespace mongo {
         bool fastmodinsert;  // upsert of an $operation. builds a default object
         bool upsert;         // true if the update actually did an insert
         int keyUpdates;
+        long long arenaAllocs;  // allocations served by the op's arena, see Client::opArena()
+        long long arenaMallocs; // mallocs the op's arena made for them
 
         // error handling
         ExceptionInfo exceptionInfo;
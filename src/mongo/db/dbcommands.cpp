@@ -957,11 +957,12 @@ namespace mongo {
                 return false;
             }
 
+            vector<BSONObj> infos;
             for ( list<BSONObj>::iterator i=all.begin(); i!=all.end(); i++ ) {
-                BSONObj o = *i;
-                log(1) << "reIndex ns: " << toDeleteNs << " index: " << o << endl;
-                theDataFileMgr.insertWithObjMod( Namespace( toDeleteNs.c_str() ).getSisterNS( "system.indexes" ).c_str() , o , true );
+                log(1) << "reIndex ns: " << toDeleteNs << " index: " << *i << endl;
+                infos.push_back( *i );
             }
+            buildIndexes( toDeleteNs.c_str(), infos );
 
             result.append( "nIndexes" , (int)all.size() );
             result.appendArray( "indexes" , b.obj() );
@@ -42,6 +42,7 @@
 #include "../util/ramlog.h"
 #include "repl/multicmd.h"
 #include "server.h"
+#include "../client/connpool.h"
 
 namespace mongo {
 
@@ -138,6 +139,9 @@ namespace mongo {
             help << "  notablescan\n";
             help << "  logLevel\n";
             help << "  syncdelay\n";
+            help << "  connPoolMaxInUsePerHost\n";
+            help << "  connPoolMinPerHost\n";
+            help << "  connPoolWaitTimeoutMillis\n";
             help << "{ getParameter:'*' } to get everything\n";
         }
         bool run(const string& dbname, BSONObj& cmdObj, int, string& errmsg, BSONObjBuilder& result, bool fromRepl ) {
@@ -160,6 +164,15 @@ namespace mongo {
             if( all || cmdObj.hasElement("replApplyBatchSize") ) {
                 result.append("replApplyBatchSize", replApplyBatchSize);
             }
+            if( all || cmdObj.hasElement("connPoolMaxInUsePerHost") ) {
+                result.append("connPoolMaxInUsePerHost", (int) PoolForHost::getMaxInUse());
+            }
+            if( all || cmdObj.hasElement("connPoolMinPerHost") ) {
+                result.append("connPoolMinPerHost", (int) PoolForHost::getMinPerHost());
+            }
+            if( all || cmdObj.hasElement("connPoolWaitTimeoutMillis") ) {
+                result.append("connPoolWaitTimeoutMillis", PoolForHost::getMaxWaitMillis());
+            }
 
             if ( before == result.len() ) {
                 errmsg = "no option found to get";
@@ -182,6 +195,9 @@ namespace mongo {
             help << "set administrative option(s)\n";
             help << "{ setParameter:1, <param>:<value> }\n";
             help << "supported so far:\n";
+            help << "  connPoolMaxInUsePerHost\n";
+            help << "  connPoolMinPerHost\n";
+            help << "  connPoolWaitTimeoutMillis\n";
             help << "  journalCommitInterval\n";
             help << "  logLevel\n";
             help << "  notablescan\n";
@@ -239,6 +255,36 @@ namespace mongo {
                 replApplyBatchSize = e.numberInt();
                 s++;
             }
+            if( cmdObj.hasElement( "connPoolMaxInUsePerHost" ) ) {
+                int x = cmdObj["connPoolMaxInUsePerHost"].numberInt();
+                if ( x < 0 ) {
+                    errmsg = "connPoolMaxInUsePerHost must be 0 (no limit) or more";
+                    return false;
+                }
+                if( s == 0 ) result.append( "was", (int) PoolForHost::getMaxInUse() );
+                PoolForHost::setMaxInUse( x );
+                s++;
+            }
+            if( cmdObj.hasElement( "connPoolMinPerHost" ) ) {
+                int x = cmdObj["connPoolMinPerHost"].numberInt();
+                if ( x < 0 ) {
+                    errmsg = "connPoolMinPerHost must be 0 or more";
+                    return false;
+                }
+                if( s == 0 ) result.append( "was", (int) PoolForHost::getMinPerHost() );
+                PoolForHost::setMinPerHost( x );
+                s++;
+            }
+            if( cmdObj.hasElement( "connPoolWaitTimeoutMillis" ) ) {
+                int x = cmdObj["connPoolWaitTimeoutMillis"].numberInt();
+                if ( x < 0 ) {
+                    errmsg = "connPoolWaitTimeoutMillis must be 0 or more";
+                    return false;
+                }
+                if( s == 0 ) result.append( "was", PoolForHost::getMaxWaitMillis() );
+                PoolForHost::setMaxWaitMillis( x );
+                s++;
+            }
             if( cmdObj.hasElement( "traceExceptions" ) ) {
                 if( s == 0 ) result.append( "was", DBException::traceExceptions );
                 DBException::traceExceptions = cmdObj["traceExceptions"].Bool();
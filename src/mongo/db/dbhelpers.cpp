@@ -197,7 +197,7 @@ namespace mongo {
         return me.obj();
     }
 
-    long long Helpers::removeRange( const string& ns , const BSONObj& min , const BSONObj& max , bool yield , bool maxInclusive , RemoveCallback * callback ) {
+    long long Helpers::removeRange( const string& ns , const BSONObj& min , const BSONObj& max , bool yield , bool maxInclusive , RemoveCallback * callback , long long maxToDelete ) {
         BSONObj keya , keyb;
         BSONObj minClean = toKeyFormat( min , keya );
         BSONObj maxClean = toKeyFormat( max , keyb );
@@ -219,7 +219,7 @@ namespace mongo {
         auto_ptr<ClientCursor> cc( new ClientCursor( QueryOption_NoCursorTimeout , c , ns ) );
         cc->setDoingDeletes( true );
 
-        while ( c->ok() ) {
+        while ( c->ok() && ( maxToDelete == 0 || num < maxToDelete ) ) {
 
             if ( yield && ! cc->yieldSometimes( ClientCursor::WillNeed) ) {
                 // cursor got finished by someone else, so we're done
@@ -109,8 +109,10 @@ namespace mongo {
             virtual ~RemoveCallback() {}
             virtual void goingToDelete( const BSONObj& o ) = 0;
         };
-        /* removeRange: operation is oplog'd */
-        static long long removeRange( const string& ns , const BSONObj& min , const BSONObj& max , bool yield = false , bool maxInclusive = false , RemoveCallback * callback = 0 );
+        /* removeRange: operation is oplog'd
+           @param maxToDelete stop after this many, 0 for the whole range
+        */
+        static long long removeRange( const string& ns , const BSONObj& min , const BSONObj& max , bool yield = false , bool maxInclusive = false , RemoveCallback * callback = 0 , long long maxToDelete = 0 );
 
         /* Remove all objects from a collection.
         You do not need to set the database before calling.
@@ -61,18 +61,17 @@ namespace mongo {
                       int nReturned, int startingFrom,
                       long long cursorId 
                       ) {
-        BufBuilder b(32768);
-        b.skip(sizeof(QueryResult));
-        b.appendBuf(data, size);
-        QueryResult *qr = (QueryResult *) b.buf();
-        qr->_resultFlags() = queryResultFlags;
-        qr->len = b.len();
-        qr->setOperation(opReply);
-        qr->cursorId = cursorId;
-        qr->startingFrom = startingFrom;
-        qr->nReturned = nReturned;
-        b.decouple();
-        Message resp(qr, true);
+        // reply() is done with the message when it returns, so the reply can point at data
+        // rather than copy it in after the header
+        QueryResult qr;
+        qr._resultFlags() = queryResultFlags;
+        qr.setOperation(opReply);
+        qr.cursorId = cursorId;
+        qr.startingFrom = startingFrom;
+        qr.nReturned = nReturned;
+        Message resp;
+        resp.appendBorrowedData( (char *) &qr, sizeof(QueryResult) );
+        resp.appendBorrowedData( (char *) data, size );
         p->reply(requestMsg, resp, requestMsg.header()->id);
     }
 
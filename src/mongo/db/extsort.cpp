@@ -20,7 +20,9 @@
 
 #include "extsort.h"
 #include "namespace-inl.h"
+#include "key.h"
 #include "../util/file.h"
+#include "../util/concurrency/thread_pool.h"
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <fcntl.h>
@@ -61,13 +63,104 @@ namespace mongo {
         wassert( removed == 1 + _files.size() );
     }
 
+    int BSONObjExternalSorter::parallelism() {
+        static const int n = max( 1, min( 8, (int)boost::thread::hardware_concurrency() ) );
+        return n;
+    }
+
+    template< class T, class Cmp >
+    static void sortRun( const Cmp *cmp, T *begin, T *end ) {
+        std::sort( begin, end, *cmp );
+    }
+
+    template< class T, class Cmp >
+    static void mergeRuns( const Cmp *cmp, T *begin, T *mid, T *end ) {
+        std::inplace_merge( begin, mid, end, *cmp );
+    }
+
+    /** below this many entries a run is sorted on the calling thread */
+    static const int ParallelSortMin = 64 * 1024;
+
+    /** sort a slice per thread, then merge neighbouring slices pairwise until one is left */
+    template< class T, class Cmp >
+    static void sortSlices( const Cmp &cmp, T *data, int n, int nthreads ) {
+        vector<int> bounds;
+        for ( int i = 0; i < nthreads; i++ )
+            bounds.push_back( (int)( (long long)n * i / nthreads ) );
+        bounds.push_back( n );
+
+        ThreadPool tp( nthreads );
+        for ( unsigned i = 0; i + 1 < bounds.size(); i++ )
+            tp.schedule( &sortRun<T,Cmp>, &cmp, data + bounds[i], data + bounds[i+1] );
+        tp.join();
+
+        while ( bounds.size() > 2 ) {
+            vector<int> merged;
+            for ( unsigned i = 0; i + 1 < bounds.size(); i += 2 ) {
+                merged.push_back( bounds[i] );
+                if ( i + 2 < bounds.size() )
+                    tp.schedule( &mergeRuns<T,Cmp>, &cmp, data + bounds[i], data + bounds[i+1], data + bounds[i+2] );
+            }
+            merged.push_back( n );
+            tp.join();
+            bounds.swap( merged );
+        }
+    }
+
     void BSONObjExternalSorter::_sortInMem() {
-        // extSortComp needs to use glbals
-        // qsort_r only seems available on bsd, which is what i really want to use
-        dblock l;
-        extSortIdxInterface = &_idxi;
-        extSortOrder = Ordering::make(_order);
-        _cur->sort( BSONObjExternalSorter::extSortComp );
+        // v:0 indexes order keys with oldCompare, which the encoding does not follow
+        if ( &_idxi != IndexDetails::iis[0] && _sortEncoded() )
+            return;
+
+        const int n = _cur->size();
+        const int nthreads = parallelism();
+        if ( nthreads < 2 || n < ParallelSortMin ) {
+            // extSortComp needs to use glbals
+            // qsort_r only seems available on bsd, which is what i really want to use
+            dblock l;
+            extSortIdxInterface = &_idxi;
+            extSortOrder = Ordering::make(_order);
+            _cur->sort( BSONObjExternalSorter::extSortComp );
+            return;
+        }
+
+        RunCmp cmp( _idxi, Ordering::make(_order) );
+        sortSlices( cmp, &(*_cur)[0], n, nthreads );
+    }
+
+    /** Encode every key once and sort the encodings, so each compare is a memcmp rather than a
+        walk over two BSON keys.
+        @return false, with _cur untouched, if some key has no encoding.
+    */
+    bool BSONObjExternalSorter::_sortEncoded() {
+        const int n = _cur->size();
+        Data *data = &(*_cur)[0];
+        const Ordering order = Ordering::make(_order);
+
+        string buf;
+        vector<EncodedKey> keys( n );
+        for ( int i = 0; i < n; i++ ) {
+            EncodedKey &k = keys[i];
+            k.ofs = buf.size();
+            if ( !KeyMemcmp::encode( data[i].first, order, buf ) )
+                return false;
+            k.len = buf.size() - k.ofs;
+            k.i = i;
+        }
+
+        EncodedCmp cmp( buf.data(), data );
+        const int nthreads = parallelism();
+        if ( nthreads < 2 || n < ParallelSortMin )
+            std::sort( keys.begin(), keys.end(), cmp );
+        else
+            sortSlices( cmp, &keys[0], n, nthreads );
+
+        vector<Data> sorted( n );
+        for ( int i = 0; i < n; i++ )
+            sorted[i] = data[ keys[i].i ];
+        for ( int i = 0; i < n; i++ )
+            data[i] = sorted[i];
+        return true;
     }
 
     void BSONObjExternalSorter::sort() {
@@ -58,6 +58,46 @@ namespace mongo {
             const Ordering _order;
         };
 
+        /** for the worker threads of _sortInMem: no interrupt checks (no Client) and no shared counters */
+        class RunCmp {
+        public:
+            RunCmp( IndexInterface& i, const Ordering& order ) : _i(i), _order(order) {}
+            bool operator()( const Data &l, const Data &r ) const {
+                int x = _i.keyCompare(l.first, r.first, _order);
+                if ( x )
+                    return x < 0;
+                return l.second.compare( r.second ) < 0;
+            }
+        private:
+            IndexInterface& _i;
+            const Ordering _order;
+        };
+
+        /** a key's KeyMemcmp encoding, within the buffer of a run's encodings, and the key's
+            position in the run */
+        struct EncodedKey {
+            unsigned ofs;
+            unsigned len;
+            int i;
+        };
+
+        /** orders EncodedKeys by their bytes, then by DiskLoc as _compare does */
+        class EncodedCmp {
+        public:
+            EncodedCmp( const char *buf, const Data *data ) : _buf(buf), _data(data) {}
+            bool operator()( const EncodedKey &l, const EncodedKey &r ) const {
+                int x = memcmp( _buf + l.ofs, _buf + r.ofs, min( l.len, r.len ) );
+                if ( x == 0 )
+                    x = (int) l.len - (int) r.len;
+                if ( x )
+                    return x < 0;
+                return _data[l.i].second.compare( _data[r.i].second ) < 0;
+            }
+        private:
+            const char *_buf;
+            const Data *_data;
+        };
+
         static IndexInterface *extSortIdxInterface;
         static Ordering extSortOrder;
         static int extSortComp( const void *lv, const void *rv ) {
@@ -122,6 +162,9 @@ namespace mongo {
 
         long getCurSizeSoFar() { return _curSizeSoFar; }
 
+        /** threads index builds may use for in memory sorting and key generation */
+        static int parallelism();
+
         void hintNumObjects( long long numObjects ) {
             if ( numObjects < _arraySize )
                 _arraySize = (int)(numObjects + 100);
@@ -130,6 +173,7 @@ namespace mongo {
     private:
 
         void _sortInMem();
+        bool _sortEncoded();
 
         void sort( string file );
         void finishMap();
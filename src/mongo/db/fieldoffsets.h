@@ -0,0 +1,120 @@
+// @file fieldoffsets.h
+
+/**
+*    Copyright (C) 2012 10gen Inc.
+*
+*    This program is free software: you can redistribute it and/or  modify
+*    it under the terms of the GNU Affero General Public License, version 3,
+*    as published by the Free Software Foundation.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Affero General Public License for more details.
+*
+*    You should have received a copy of the GNU Affero General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "jsobj.h"
+
+namespace mongo {
+
+    /** Where the top level fields of one BSONObj are, so that several lookups against the same
+        object (a matcher's predicates, an index's key fields) each search a small table rather
+        than walk the object from its start, sizing every element they pass.
+
+        The table is filled in lazily, only as far as the fields looked up so far.  It holds at
+        most MaxFields entries and never allocates; fields past those are found by walking the
+        rest of the object.  Keep one on the stack for the duration of the lookups.  Lookups
+        return the same elements as the BSONObj methods of the same name.  The object's data
+        must outlive this; it is not held.
+    */
+    class FieldOffsets : boost::noncopyable {
+    public:
+        explicit FieldOffsets( const BSONObj& obj ) :
+            _obj( obj.objdata() ), _n( 0 ), _next( obj.objdata() + 4 ) {
+        }
+
+        /** like BSONObj::getField(), for the first len bytes of name */
+        BSONElement getField( const char *name, unsigned len ) const {
+            for( int i = 0; i < _n; ++i ) {
+                const Entry& e = _entries[ i ];
+                if ( e.nameLen == len && memcmp( e.data + 1, name, len ) == 0 )
+                    return BSONElement( e.data );
+            }
+
+            // record the fields after those seen so far, up to the one wanted
+            const char *p = _next;
+            while ( *p != EOO ) {
+                BSONElement e( p );
+                unsigned nameLen = (unsigned) ( e.value() - p ) - 2;
+                p += e.size();
+                if ( _n < MaxFields ) {
+                    Entry& entry = _entries[ _n++ ];
+                    entry.data = e.rawdata();
+                    entry.nameLen = nameLen;
+                    _next = p;
+                }
+                if ( nameLen == len && memcmp( e.rawdata() + 1, name, len ) == 0 )
+                    return e;
+            }
+            return BSONElement();
+        }
+        BSONElement getField( const StringData& name ) const {
+            return getField( name.data(), name.size() );
+        }
+
+        /** like BSONObj::getFieldDotted() */
+        BSONElement getFieldDotted( const char *name ) const {
+            BSONElement e = getField( name, (unsigned) strlen( name ) );
+            const char *p;
+            if ( e.eoo() && ( p = strchr( name, '.' ) ) ) {
+                BSONElement left = getField( name, (unsigned) ( p - name ) );
+                BSONType t = left.type();
+                if ( t == Object || t == Array )
+                    return left.embeddedObject().getFieldDotted( p + 1 );
+            }
+            return e;
+        }
+
+        /** like BSONObj::getFieldDottedOrArray() */
+        BSONElement getFieldDottedOrArray( const char *&name ) const {
+            const char *p = strchr( name, '.' );
+            BSONElement sub;
+            if ( p ) {
+                sub = getField( name, (unsigned) ( p - name ) );
+                name = p + 1;
+            }
+            else {
+                unsigned len = (unsigned) strlen( name );
+                sub = getField( name, len );
+                name = name + len;
+            }
+
+            if ( sub.eoo() )
+                return BSONElement();
+            else if ( sub.type() == Array || name[0] == '\0' )
+                return sub;
+            else if ( sub.type() == Object )
+                return sub.embeddedObject().getFieldDottedOrArray( name );
+            else
+                return BSONElement();
+        }
+
+    private:
+        struct Entry {
+            const char *data; // the element
+            unsigned nameLen;
+        };
+        enum { MaxFields = 32 };
+
+        const BSONObj _obj;
+        mutable int _n; // entries recorded so far
+        mutable const char *_next; // the first field not recorded
+        mutable Entry _entries[ MaxFields ];
+    };
+
+}
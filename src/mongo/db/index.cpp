@@ -54,6 +54,10 @@ namespace mongo {
             DiskLoc thisLoc, DiskLoc _recordLoc, const BSONObj &_key,
             const Ordering& _order, IndexDetails& _idx, bool dupsAllowed) 
         { 
+            if( IndexSideTable *side = IndexSideTable::get(_idx) ) {
+                side->noteInsert(_key, _recordLoc);
+                return;
+            }
             if( idxNo >= n )
                 n = idxNo + 1;
             Cont *C = c[idxNo] = new Cont(thisLoc, _recordLoc, _key, _order, _idx);
@@ -80,11 +84,19 @@ namespace mongo {
             return thisLoc.btree<V>()->findSingle(indexdetails,thisLoc,key);
         } 
         virtual bool unindex(const DiskLoc thisLoc, IndexDetails& id, const BSONObj& key, const DiskLoc recordLoc) const {
+            if( IndexSideTable *side = IndexSideTable::get(id) ) {
+                side->noteRemove(key, recordLoc);
+                return true;
+            }
             return thisLoc.btree<V>()->unindex(thisLoc, id, key, recordLoc);
         }
         virtual int bt_insert(const DiskLoc thisLoc, const DiskLoc recordLoc,
                       const BSONObj& key, const Ordering &order, bool dupsAllowed,
                       IndexDetails& idx, bool toplevel = true) const {
+            if( IndexSideTable *side = IndexSideTable::get(idx) ) {
+                side->noteInsert(key, recordLoc);
+                return 0;
+            }
             return thisLoc.btree<V>()->bt_insert(thisLoc, recordLoc, key, order, dupsAllowed, idx, toplevel);
         }
         virtual DiskLoc addBucket(const IndexDetails& id) { 
@@ -125,6 +137,46 @@ namespace mongo {
         virtual DiskLoc advance(const DiskLoc& thisLoc, int& keyOfs, int direction, const char *caller) { 
             return thisLoc.btree<V>()->advance(thisLoc,keyOfs,direction,caller);
         }
+        virtual bool countRange(const IndexDetails &idx, BSONObj &startKey, DiskLoc &startLoc,
+                                const BSONObj &endKey, bool endInclusive, long long &maxKeys,
+                                long long &n) {
+            Ordering ordering = Ordering::make(idx.keyPattern());
+            int cmp = keyCompare(startKey, endKey, ordering);
+            if ( cmp > 0 || ( cmp == 0 && ( !endInclusive || startLoc == maxDiskLoc ) ) )
+                return true;
+            const BtreeBucket<V> *head = idx.head.btree<V>();
+            bool found;
+            int startOfs;
+            DiskLoc start = head->locate(idx, idx.head, startKey, ordering, startOfs, found, startLoc);
+            // when resuming, the last key read is still there and has been counted
+            if ( found )
+                start = start.btree<V>()->advance(start, startOfs, 1, "countRange");
+            if ( start.isNull() )
+                return true;
+            // the end position is the first key past the range
+            int endOfs = 0;
+            DiskLoc end = head->locate(idx, idx.head, endKey, ordering, endOfs, found,
+                                       endInclusive ? maxDiskLoc : minDiskLoc);
+            if ( BtreeBucket<V>::countKeys(start, startOfs, end, endOfs, maxKeys, n) )
+                return true;
+            typename BtreeBucket<V>::KeyNode kn = start.btree<V>()->keyNode(startOfs);
+            startKey = kn.key.toBson().getOwned();
+            startLoc = kn.recordLoc;
+            startLoc.GETOFS() &= ~1; // the unused bit isn't part of the position
+            return false;
+        }
+        virtual double estimateRank(const IndexDetails &idx, const BSONObj &key, bool after) {
+            KeyOwned k(key);
+            return BtreeBucket<V>::estimateRank(idx, k, after ? maxDiskLoc : minDiskLoc,
+                                                Ordering::make(idx.keyPattern()));
+        }
+        virtual BSONObj keyAtRank(const IndexDetails &idx, double rank) {
+            int keyOfs;
+            DiskLoc loc = BtreeBucket<V>::keyAtRank(idx, rank, keyOfs);
+            if ( loc.isNull() )
+                return BSONObj();
+            return loc.btree<V>()->keyAt(keyOfs).toBson();
+        }
     };
 
     int oldCompare(const BSONObj& l,const BSONObj& r, const Ordering &o); // key.cpp
@@ -139,18 +191,86 @@ namespace mongo {
         return l.woCompare(r, ordering, /*considerfieldname*/false);
     }
 
+    template <>
+    int IndexInterfaceImpl< V2 >::keyCompare(const BSONObj& l, const BSONObj& r, const Ordering &ordering) { 
+        return l.woCompare(r, ordering, /*considerfieldname*/false);
+    }
+
     IndexInterfaceImpl<V0> iii_v0;
     IndexInterfaceImpl<V1> iii_v1;
+    IndexInterfaceImpl<V2> iii_v2;
 
-    IndexInterface *IndexDetails::iis[] = { &iii_v0, &iii_v1 };
+    IndexInterface *IndexDetails::iis[] = { &iii_v0, &iii_v1, &iii_v2 };
 
     void IndexInterface::phasedBegin() { 
         iii_v0._phasedBegin();
         iii_v1._phasedBegin();
+        iii_v2._phasedBegin();
     }
     void IndexInterface::phasedFinish() { 
         iii_v0._phasedFinish();
         iii_v1._phasedFinish();
+        iii_v2._phasedFinish();
+    }
+
+    map<const IndexDetails*,IndexSideTable*> IndexSideTable::_active;
+
+    IndexSideTable::IndexSideTable( IndexDetails& idx ) : _idx( idx ), _bytes( 0 ), _full( false ) {
+        assertInWriteLock();
+        massert( 16064, "index already has a side table", _active.count( &idx ) == 0 );
+        _active[ &idx ] = this;
+    }
+
+    IndexSideTable::~IndexSideTable() {
+        _active.erase( &_idx );
+    }
+
+    void IndexSideTable::note( const Op& op ) {
+        if ( _full )
+            return;
+        _bytes += op.key.objsize() + sizeof( Op );
+        if ( _bytes > MaxBytes ) {
+            // the build will fail, so there is no point holding on to what we have
+            _full = true;
+            _ops.clear();
+            return;
+        }
+        _ops.push_back( op );
+    }
+
+    void IndexSideTable::assertNotFull() const {
+        uassert( 16072, str::stream() << "too many writes to " << _idx.indexNamespace()
+                 << " during background index build, more than " << MaxBytes / ( 1024 * 1024 ) << "MB",
+                 !_full );
+    }
+
+    unsigned long long IndexSideTable::replay() {
+        assertInWriteLock();
+        assertNotFull();
+        _active.erase( &_idx );
+
+        IndexInterface& ii = _idx.idxInterface();
+        Ordering ordering = Ordering::make( _idx.keyPattern() );
+        unsigned long long n = 0;
+        while( !_ops.empty() ) {
+            const Op& op = _ops.front();
+            if ( op.insert ) {
+                try {
+                    ii.bt_insert( _idx.head, op.loc, op.key, ordering, /*dupsAllowed*/true, _idx );
+                }
+                catch ( AssertionException& e ) {
+                    if ( e.getCode() != 10287 ) // key already in index, the build's scan saw this record
+                        throw;
+                }
+            }
+            else {
+                ii.unindex( _idx.head, _idx, op.key, op.loc );
+            }
+            _ops.pop_front();
+            n++;
+            getDur().commitIfNeeded();
+        }
+        return n;
     }
 
     int removeFromSysIndexes(const char *ns, const char *idxName) {
@@ -401,7 +521,7 @@ namespace mongo {
                 // note (one day) we may be able to fresh build less versions than we can use
                 // isASupportedIndexVersionNumber() is what we can use
                 uassert(14803, str::stream() << "this version of mongod cannot build new indexes of version number " << vv, 
-                    vv == 0 || vv == 1);
+                    vv == 0 || vv == 1 || vv == 2);
                 v = (int) vv;
             }
             // idea is to put things we use a lot earlier
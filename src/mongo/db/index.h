@@ -55,6 +55,26 @@ namespace mongo {
         virtual DiskLoc locate(const IndexDetails &idx , const DiskLoc& thisLoc, const BSONObj& key, const Ordering &order,
                                int& pos, bool& found, const DiskLoc &recordLoc, int direction=1) = 0;
         virtual DiskLoc advance(const DiskLoc& thisLoc, int& keyOfs, int direction, const char *caller) = 0;
+
+        /**
+         * Add to n the number of used keys after (startKey, startLoc) up to endKey, in index
+         * order, reading at most maxKeys keys.  A startLoc of minDiskLoc includes startKey and
+         * maxDiskLoc excludes it.
+         * @return true if endKey was reached.  Otherwise startKey and startLoc are set to the
+         * last key read, so counting can resume from them after a yield.
+         */
+        virtual bool countRange(const IndexDetails &idx, BSONObj &startKey, DiskLoc &startLoc,
+                                const BSONObj &endKey, bool endInclusive, long long &maxKeys,
+                                long long &n) = 0;
+
+        /**
+         * @return the estimated fraction of keys that sort before 'key', or before or at it if
+         * 'after', from the shape of the tree rather than a scan of it
+         */
+        virtual double estimateRank(const IndexDetails &idx, const BSONObj &key, bool after) = 0;
+
+        /** @return a key about 'rank' of the way through the index, empty if there are none */
+        virtual BSONObj keyAtRank(const IndexDetails &idx, double rank) = 0;
     };
 
     /* Details about a particular index. There is one of these effectively for each object in
@@ -199,7 +219,7 @@ namespace mongo {
                     it may not mean we can build the index version in question: we may not maintain building 
                     of indexes in old formats in the future.
         */
-        static bool isASupportedIndexVersionNumber(int v) { return (v&1)==v; } // v == 0 || v == 1
+        static bool isASupportedIndexVersionNumber(int v) { return v >= 0 && v <= 2; }
 
         /** @return the interface for this interface, which varies with the index version.
             used for backward compatibility of index versions/formats.
@@ -207,7 +227,7 @@ namespace mongo {
         IndexInterface& idxInterface() const { 
             int v = version();
             dassert( isASupportedIndexVersionNumber(v) );
-            return *iis[v&1];
+            return *iis[v];
         }
 
         static IndexInterface *iis[];
@@ -234,4 +254,58 @@ namespace mongo {
     // changedId should be initialized to false
     void getIndexChanges(vector<IndexChanges>& v, NamespaceDetails& d, BSONObj newObj, BSONObj oldObj, bool &cangedId);
     void dupCheck(vector<IndexChanges>& v, NamespaceDetails& d, DiskLoc curObjLoc);
+
+    /**
+     * Writes other operations make to an index while a background build bulk loads it.  For the
+     * lifetime of the table, IndexInterface inserts and unindexes on that index are recorded here
+     * instead of touching the btree; replay() then applies them in order to the finished tree.
+     * Replaying is idempotent per key/location pair (an insert of a key already present or a
+     * remove of one that is absent is a no-op), so whether the build's own scan saw a record
+     * before or after such a write doesn't matter.  All access is under the write lock.
+     *
+     * The table holds at most MaxBytes of keys.  Past that it stops recording and the build
+     * fails at its next assertNotFull(), rather than let a busy collection grow it unbounded.
+     */
+    class IndexSideTable : boost::noncopyable {
+    public:
+        IndexSideTable( IndexDetails& idx );
+        ~IndexSideTable();
+
+        /** @return the side table capturing writes to idx, or 0 */
+        static IndexSideTable* get( const IndexDetails& idx ) {
+            if ( _active.empty() )
+                return 0;
+            map<const IndexDetails*,IndexSideTable*>::const_iterator i = _active.find( &idx );
+            return i == _active.end() ? 0 : i->second;
+        }
+
+        void noteInsert( const BSONObj& key, const DiskLoc& loc ) { note( Op( key, loc, true ) ); }
+        void noteRemove( const BSONObj& key, const DiskLoc& loc ) { note( Op( key, loc, false ) ); }
+
+        /** uasserts if writes have been dropped because the table is full */
+        void assertNotFull() const;
+
+        /**
+         * Stops capturing and applies the recorded writes to the index's btree.
+         * @return the number of writes replayed
+         */
+        unsigned long long replay();
+
+        static const unsigned long long MaxBytes = 100 * 1024 * 1024;
+
+    private:
+        struct Op {
+            Op( const BSONObj& k, const DiskLoc& l, bool i ) : key( k.getOwned() ), loc( l ), insert( i ) {}
+            BSONObj key;
+            DiskLoc loc;
+            bool insert;
+        };
+        void note( const Op& op );
+        IndexDetails& _idx;
+        list<Op> _ops;
+        unsigned long long _bytes;
+        bool _full;
+        static map<const IndexDetails*,IndexSideTable*> _active;
+    };
+
 } // namespace mongo
@@ -23,6 +23,7 @@
 #include "ops/query.h"
 #include "background.h"
 #include "../util/text.h"
+#include "fieldoffsets.h"
 
 namespace mongo {
 
@@ -280,7 +281,9 @@ namespace mongo {
             }
             vector<const char*> fieldNames( _spec._fieldNames );
             vector<BSONElement> fixed( _spec._fixed );
-            _getKeys( fieldNames , fixed , obj, keys );
+            // a compound key looks up several fields of obj, so locate them all at once
+            FieldOffsets fields( obj );
+            _getKeys( fieldNames , fixed , obj, keys, 0, BSONObj(), _spec._nFields > 1 ? &fields : 0 );
             if ( keys.empty() && ! _spec._sparse )
                 keys.insert( _spec._nullKey );
         }     
@@ -288,10 +291,11 @@ namespace mongo {
     private:
         /**
          * @param arrayNestedArray - set if the returned element is an array nested directly within arr.
+         * @param objFields - if not null, where the top level fields of obj are
          */
-        BSONElement extractNextElement( const BSONObj &obj, const BSONObj &arr, const char *&field, bool &arrayNestedArray ) const {
+        BSONElement extractNextElement( const BSONObj &obj, const BSONObj &arr, const char *&field, bool &arrayNestedArray, const FieldOffsets *objFields ) const {
             string firstField = mongoutils::str::before( field, '.' );
-            bool haveObjField = !obj.getField( firstField ).eoo();
+            bool haveObjField = !( objFields ? objFields->getField( firstField ) : obj.getField( firstField ) ).eoo();
             BSONElement arrField = arr.getField( firstField );
             bool haveArrField = !arrField.eoo();
 
@@ -300,7 +304,7 @@ namespace mongo {
 
             arrayNestedArray = false;
 			if ( haveObjField ) {
-                return obj.getFieldDottedOrArray( field );
+                return objFields ? objFields->getFieldDottedOrArray( field ) : obj.getFieldDottedOrArray( field );
             }
             else if ( haveArrField ) {
                 if ( arrField.type() == Array ) {
@@ -330,8 +334,9 @@ namespace mongo {
          * @param numNotFound - number of index fields that have already been identified as missing
          * @param array - array from which keys should be extracted, based on names in fieldNames
          *        If obj and array are both nonempty, obj will be one of the elements of array.
+         * @param objFields - if not null, where the top level fields of obj are
          */        
-        void _getKeys( vector<const char*> fieldNames , vector<BSONElement> fixed , const BSONObj &obj, BSONObjSet &keys, int numNotFound = 0, const BSONObj &array = BSONObj() ) const {
+        void _getKeys( vector<const char*> fieldNames , vector<BSONElement> fixed , const BSONObj &obj, BSONObjSet &keys, int numNotFound = 0, const BSONObj &array = BSONObj(), const FieldOffsets *objFields = 0 ) const {
             BSONElement arrElt;
             set<unsigned> arrIdxs;
             bool mayExpandArrayUnembedded = true;
@@ -342,7 +347,7 @@ namespace mongo {
                 
                 bool arrayNestedArray;
                 // Extract element matching fieldName[ i ] from object xor array.
-                BSONElement e = extractNextElement( obj, array, fieldNames[ i ], arrayNestedArray );
+                BSONElement e = extractNextElement( obj, array, fieldNames[ i ], arrayNestedArray, objFields );
                 
                 if ( e.eoo() ) {
                     // if field not present, set to null
@@ -406,7 +411,8 @@ namespace mongo {
                 g.getKeys( obj, keys );
                 break;
             }
-            case 1: {
+            case 1:
+            case 2: { // v2 only changes how buckets store keys, not the keys themselves
                 KeyGeneratorV1 g( *this );
                 g.getKeys( obj, keys );
                 break;
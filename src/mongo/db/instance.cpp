@@ -247,7 +247,7 @@ namespace mongo {
             SendStaleConfigException* scex = NULL;
             if ( ex->getCode() == SendStaleConfigCode ) scex = static_cast<SendStaleConfigException*>( ex.get() );
 
-            BSONObjBuilder err;
+            BSONObjBuilder err( c.opArena() );
             ex->getInfo().append( err );
             if( scex ) err.append( "ns", scex->getns() );
             BSONObj errObj = err.done();
@@ -331,6 +331,7 @@ namespace mongo {
         globalOpCounters.gotOp( op , isCommand );
 
         Client& c = cc();
+        Client::OpArenaScope arenaScope( c );
 
         auto_ptr<CurOp> nestedOp;
         CurOp* currentOpP = c.curop();
@@ -416,6 +417,10 @@ namespace mongo {
         currentOp.ensureStarted();
         currentOp.done();
         debug.executionTime = currentOp.totalTimeMillis();
+        if ( arenaScope.allocs() || arenaScope.mallocs() ) {
+            debug.arenaAllocs = arenaScope.allocs();
+            debug.arenaMallocs = arenaScope.mallocs();
+        }
 
         //DEV log = true;
         if ( log || debug.executionTime > logThreshold ) {
@@ -57,30 +57,68 @@ namespace mongo {
     MinKeyLabeler MINKEY;
     MaxKeyLabeler MAXKEY;
 
+    /** as stringstream with precision 16 formats it, %.16g, but integral values print directly */
+    static void appendJsonDouble( StringBuilder& s, double x ) {
+        // -0.0, whose bits aren't all zero, keeps its sign under %g
+        if ( x > -1e16 && x < 1e16 && x == (long long) x &&
+             ( x != 0 || reinterpret_cast< const long long& >( x ) == 0 ) ) {
+            s << (long long) x;
+            return;
+        }
+        char buf[ 32 ];
+        int z = mongo_snprintf( buf, sizeof( buf ), "%.16g", x );
+        assert( z > 0 && z < (int) sizeof( buf ) );
+        s.write( buf, z );
+    }
+
+    static void appendHex( StringBuilder& s, const void *data, int len ) {
+        static const char hexchars[] = "0123456789abcdef";
+        const unsigned char *in = (const unsigned char *) data;
+        char buf[ 64 ];
+        for( int i = 0; i < len; ++i ) {
+            buf[ i * 2 ] = hexchars[ in[ i ] >> 4 ];
+            buf[ i * 2 + 1 ] = hexchars[ in[ i ] & 0x0F ];
+        }
+        s.write( buf, len * 2 );
+    }
+
     // need to move to bson/, but has dependency on base64 so move that to bson/util/ first.
-    inline string BSONElement::jsonString( JsonStringFormat format, bool includeFieldNames, int pretty ) const {
+    string BSONElement::jsonString( JsonStringFormat format, bool includeFieldNames, int pretty ) const {
+        StringBuilder s;
+        jsonString( s, format, includeFieldNames, pretty );
+        return s.str();
+    }
+
+    void BSONElement::jsonString( StringBuilder& s, JsonStringFormat format, bool includeFieldNames, int pretty ) const {
         BSONType t = type();
         int sign;
-        if ( t == Undefined )
-            return "undefined";
+        if ( t == Undefined ) {
+            s << "undefined";
+            return;
+        }
 
-        stringstream s;
-        if ( includeFieldNames )
-            s << '"' << escape( fieldName() ) << "\" : ";
+        if ( includeFieldNames ) {
+            s << '"';
+            escape( s, fieldName() );
+            s << "\" : ";
+        }
         switch ( type() ) {
         case mongo::String:
         case Symbol:
-            s << '"' << escape( string(valuestr(), valuestrsize()-1) ) << '"';
+            s << '"';
+            escape( s, StringData( valuestr(), valuestrsize()-1 ) );
+            s << '"';
             break;
         case NumberLong:
             s << _numberLong();
             break;
         case NumberInt:
+            s << _numberInt();
+            break;
         case NumberDouble:
             if ( number() >= -numeric_limits< double >::max() &&
                     number() <= numeric_limits< double >::max() ) {
-                s.precision( 16 );
-                s << number();
+                appendJsonDouble( s, number() );
             }
             else if ( mongo::isNaN(number()) ) {
                 s << "NaN";
@@ -102,7 +140,7 @@ namespace mongo {
             s << "null";
             break;
         case Object:
-            s << embeddedObject().jsonString( format, pretty );
+            embeddedObject().jsonString( s, format, pretty );
             break;
         case mongo::Array: {
             if ( embeddedObject().isEmpty() ) {
@@ -125,7 +163,7 @@ namespace mongo {
                         s << "undefined";
                     }
                     else {
-                        s << e.jsonString( format, false, pretty?pretty+1:0 );
+                        e.jsonString( s, format, false, pretty?pretty+1:0 );
                         e = i.next();
                     }
                     count++;
@@ -146,7 +184,9 @@ namespace mongo {
             s << '"' << valuestr() << "\", ";
             if ( format != TenGen )
                 s << "\"$id\" : ";
-            s << '"' << *x << "\" ";
+            s << '"';
+            appendHex( s, x->getData(), 12 );
+            s << "\" ";
             if ( format == TenGen )
                 s << ')';
             else
@@ -160,7 +200,9 @@ namespace mongo {
             else {
                 s << "{ \"$oid\" : ";
             }
-            s << '"' << __oid() << '"';
+            s << '"';
+            appendHex( s, value(), 12 );
+            s << '"';
             if ( format == TenGen ) {
                 s << " )";
             }
@@ -174,10 +216,10 @@ namespace mongo {
             s << "{ \"$binary\" : \"";
             char *start = ( char * )( value() ) + sizeof( int ) + 1;
             base64::encode( s , start , len );
-            s << "\", \"$type\" : \"" << hex;
-            s.width( 2 );
-            s.fill( '0' );
-            s << type << dec;
+            char buf[ 16 ];
+            int z = mongo_snprintf( buf, sizeof( buf ), "%02x", (unsigned) type );
+            s << "\", \"$type\" : \"";
+            s.write( buf, z );
             s << "\" }";
             break;
         }
@@ -193,7 +235,7 @@ namespace mongo {
                     s << '"' << date().toString() << '"';
             }
             else
-                s << date();
+                s << date().millis;
             if ( format == Strict )
                 s << " }";
             else
@@ -201,11 +243,14 @@ namespace mongo {
             break;
         case RegEx:
             if ( format == Strict ) {
-                s << "{ \"$regex\" : \"" << escape( regex() );
+                s << "{ \"$regex\" : \"";
+                escape( s, regex() );
                 s << "\", \"$options\" : \"" << regexFlags() << "\" }";
             }
             else {
-                s << "/" << escape( regex() , true ) << "/";
+                s << "/";
+                escape( s, regex(), true );
+                s << "/";
                 // FIXME Worry about alpha order?
                 for ( const char *f = regexFlags(); *f; ++f ) {
                     switch ( *f ) {
@@ -224,7 +269,9 @@ namespace mongo {
             BSONObj scope = codeWScopeObject();
             if ( ! scope.isEmpty() ) {
                 s << "{ \"$code\" : " << _asCode() << " , "
-                  << " \"$scope\" : " << scope.jsonString() << " }";
+                  << " \"$scope\" : ";
+                scope.jsonString( s );
+                s << " }";
                 break;
             }
         }
@@ -234,7 +281,7 @@ namespace mongo {
             break;
 
         case Timestamp:
-            s << "{ \"t\" : " << timestampTime() << " , \"i\" : " << timestampInc() << " }";
+            s << "{ \"t\" : " << timestampTime().millis << " , \"i\" : " << timestampInc() << " }";
             break;
 
         case MinKey:
@@ -252,7 +299,6 @@ namespace mongo {
             string message = ss.str();
             massert( 10312 ,  message.c_str(), false );
         }
-        return s.str();
     }
 
     int BSONElement::getGtLtOp( int def ) const {
@@ -387,16 +433,24 @@ namespace mongo {
     }
 
     string BSONObj::jsonString( JsonStringFormat format, int pretty ) const {
+        StringBuilder s;
+        jsonString( s, format, pretty );
+        return s.str();
+    }
 
-        if ( isEmpty() ) return "{}";
+    void BSONObj::jsonString( StringBuilder& s, JsonStringFormat format, int pretty ) const {
+
+        if ( isEmpty() ) {
+            s << "{}";
+            return;
+        }
 
-        StringBuilder s;
         s << "{ ";
         BSONObjIterator i(*this);
         BSONElement e = i.next();
         if ( !e.eoo() )
             while ( 1 ) {
-                s << e.jsonString( format, true, pretty?pretty+1:0 );
+                e.jsonString( s, format, true, pretty?pretty+1:0 );
                 e = i.next();
                 if ( e.eoo() )
                     break;
@@ -411,7 +465,6 @@ namespace mongo {
                 }
             }
         s << " }";
-        return s.str();
     }
 
     bool BSONObj::valid() const {
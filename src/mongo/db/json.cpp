@@ -18,610 +18,515 @@
 
 #include "pch.h"
 
-#define BOOST_SPIRIT_THREADSAFE
-#if BOOST_VERSION >= 103800
-#define BOOST_SPIRIT_USE_OLD_NAMESPACE
-#include <boost/spirit/include/classic_core.hpp>
-#include <boost/spirit/include/classic_loops.hpp>
-#include <boost/spirit/include/classic_lists.hpp>
-#else
-#include <boost/spirit/core.hpp>
-#include <boost/spirit/utility/loops.hpp>
-#include <boost/spirit/utility/lists.hpp>
-#endif
-#undef assert
-#define assert MONGO_assert
-
 #include "json.h"
 #include "../bson/util/builder.h"
 #include "../util/base64.h"
 #include "../util/hex.h"
 
-
-using namespace boost::spirit;
-
 namespace mongo {
 
-    struct ObjectBuilder : boost::noncopyable {
-        ~ObjectBuilder() {
-            DESTRUCTOR_GUARD(
-                unsigned i = builders.size();
-                if ( i ) {
-                    i--;
-                    for ( ; i>=1; i-- ) {
-                        if ( builders[i] ) {
-                            builders[i]->done();
-                        }
-                    }
-                }
-            );
-        }
-        BSONObjBuilder *back() {
-            return builders.back().get();
-        }
-        // Storage for field names of elements within builders.back().
-        const char *fieldName() {
-            return fieldNames.back().c_str();
-        }
-        bool empty() const {
-            return builders.size() == 0;
-        }
-        void init() {
-            boost::shared_ptr< BSONObjBuilder > b( new BSONObjBuilder() );
-            builders.push_back( b );
-            fieldNames.push_back( "" );
-            indexes.push_back( 0 );
-        }
-        void pushObject( const char *fieldName ) {
-            boost::shared_ptr< BSONObjBuilder > b( new BSONObjBuilder( builders.back()->subobjStart( fieldName ) ) );
-            builders.push_back( b );
-            fieldNames.push_back( "" );
-            indexes.push_back( 0 );
-        }
-        void pushArray( const char *fieldName ) {
-            boost::shared_ptr< BSONObjBuilder > b( new BSONObjBuilder( builders.back()->subarrayStart( fieldName ) ) );
-            builders.push_back( b );
-            fieldNames.push_back( "" );
-            indexes.push_back( 0 );
-        }
-        BSONObj pop() {
-            BSONObj ret;
-            if ( back()->owned() )
-                ret = back()->obj();
-            else
-                ret = back()->done();
-            builders.pop_back();
-            fieldNames.pop_back();
-            indexes.pop_back();
-            return ret;
-        }
-        void nameFromIndex() {
-            fieldNames.back() = BSONObjBuilder::numStr( indexes.back() );
-        }
-        string popString() {
-            string ret = ss.str();
-            ss.str( "" );
-            return ret;
-        }
-        // Cannot use auto_ptr because its copy constructor takes a non const reference.
-        vector< boost::shared_ptr< BSONObjBuilder > > builders;
-        vector< string > fieldNames;
-        vector< int > indexes;
-        stringstream ss;
-        string ns;
+    // NOTE s must be 24 characters.
+    OID stringToOid( const char *s ) {
         OID oid;
-        string binData;
-        BinDataType binDataType;
-        string regex;
-        string regexOptions;
-        Date_t date;
-        OpTime timestamp;
-    };
-
-    struct objectStart {
-        objectStart( ObjectBuilder &_b ) : b( _b ) {}
-        void operator() ( const char &c ) const {
-            if ( b.empty() )
-                b.init();
-            else
-                b.pushObject( b.fieldName() );
-        }
-        ObjectBuilder &b;
-    };
-
-    struct arrayStart {
-        arrayStart( ObjectBuilder &_b ) : b( _b ) {}
-        void operator() ( const char &c ) const {
-            b.pushArray( b.fieldName() );
-            b.nameFromIndex();
-        }
-        ObjectBuilder &b;
-    };
-
-    struct arrayNext {
-        arrayNext( ObjectBuilder &_b ) : b( _b ) {}
-        void operator() ( const char &c ) const {
-            ++b.indexes.back();
-            b.nameFromIndex();
-        }
-        ObjectBuilder &b;
-    };
+        char *oidP = (char *)( &oid );
+        for ( int i = 0; i < 12; ++i )
+            oidP[ i ] = fromHex( s + ( i * 2 ) );
+        return oid;
+    }
 
-    struct ch {
-        ch( ObjectBuilder &_b ) : b( _b ) {}
-        void operator() ( const char c ) const {
-            b.ss << c;
-        }
-        ObjectBuilder &b;
-    };
+    /** Recursive descent parser from JSON text straight into a BSONObjBuilder.
 
-    struct chE {
-        chE( ObjectBuilder &_b ) : b( _b ) {}
-        void operator() ( const char c ) const {
-            char o = '\0';
-            switch ( c ) {
-            case '\"':
-                o = '\"';
-                break;
+        Each production returns false on a syntax error, leaving pos() where parsing stopped.
+        Values are appended only once completely matched, so the one production that may have
+        to back off -- an object that looks like { "$date" : ... } but isn't -- has nothing to
+        undo.  Decoded strings go to buffers that are reused across the whole parse.
+    */
+    class JParse {
+    public:
+        explicit JParse( const char *str ) : _input( str ) {}
+
+        const char *pos() const { return _input; }
+
+        // object := '{' [ fieldName ':' value { ',' fieldName ':' value } ] '}'
+        bool object( BSONObjBuilder &b ) {
+            if ( !accept( '{' ) )
+                return false;
+            if ( accept( '}' ) )
+                return true;
+            do {
+                // _name is not needed again once value() has started appending, so nested
+                // objects may reuse it.
+                if ( !fieldName( _name ) || !accept( ':' ) || !value( _name.c_str(), b ) )
+                    return false;
+            } while ( accept( ',' ) );
+            return accept( '}' );
+        }
+
+        void skipWhite() {
+            while ( isWhite( *_input ) )
+                ++_input;
+        }
+
+    private:
+        static bool isWhite( char c ) {
+            return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' || c == '\r';
+        }
+        static bool isDigit( char c ) { return c >= '0' && c <= '9'; }
+        static bool isAlpha( char c ) { return ( c >= 'a' && c <= 'z' ) || ( c >= 'A' && c <= 'Z' ); }
+        static bool isHex( char c ) {
+            return isDigit( c ) || ( c >= 'a' && c <= 'f' ) || ( c >= 'A' && c <= 'F' );
+        }
+
+        /** skip white space, then consume c if it is next */
+        bool accept( char c ) {
+            skipWhite();
+            if ( *_input != c )
+                return false;
+            ++_input;
+            return true;
+        }
+
+        /** skip white space, then consume token if it is next */
+        bool accept( const char *token ) {
+            skipWhite();
+            const char *p = _input;
+            for( ; *token; ++token, ++p )
+                if ( *p != *token )
+                    return false;
+            _input = p;
+            return true;
+        }
+
+        bool fieldName( string &name ) {
+            skipWhite();
+            if ( *_input == '"' || *_input == '\'' ) {
+                if ( !quoted( name ) )
+                    return false;
+                massert( 10338 ,  "Invalid use of reserved field name: " + name,
+                         name != "$oid" &&
+                         name != "$binary" &&
+                         name != "$type" &&
+                         name != "$date" &&
+                         name != "$timestamp" &&
+                         name != "$regex" &&
+                         name != "$options" );
+                return true;
+            }
+            // We allow a subset of valid js identifier names here.
+            const char *start = _input;
+            if ( !isAlpha( *_input ) && *_input != '$' && *_input != '_' )
+                return false;
+            ++_input;
+            while ( isAlpha( *_input ) || isDigit( *_input ) || *_input == '$' || *_input == '_' )
+                ++_input;
+            name.assign( start, _input - start );
+            return true;
+        }
+
+        bool value( const char *fieldName, BSONObjBuilder &b ) {
+            skipWhite();
+            switch ( *_input ) {
+            case '"':
             case '\'':
-                o = '\'';
-                break;
-            case '\\':
-                o = '\\';
-                break;
+                if ( !quoted( _str ) )
+                    return false;
+                b.append( fieldName, _str );
+                return true;
+            case '{': {
+                const char *start = _input;
+                if ( extendedObject( fieldName, b ) )
+                    return true;
+                _input = start;
+                BSONObjBuilder sub( b.subobjStart( fieldName ) );
+                if ( !object( sub ) )
+                    return false;
+                sub.done();
+                return true;
+            }
+            case '[':
+                return array( fieldName, b );
             case '/':
-                o = '/';
-                break;
-            case 'b':
-                o = '\b';
-                break;
+                return regex( fieldName, b );
+            case 't':
+                if ( !accept( "true" ) )
+                    return false;
+                b.appendBool( fieldName, true );
+                return true;
             case 'f':
-                o = '\f';
-                break;
+                if ( !accept( "false" ) )
+                    return false;
+                b.appendBool( fieldName, false );
+                return true;
             case 'n':
-                o = '\n';
-                break;
-            case 'r':
-                o = '\r';
-                break;
-            case 't':
-                o = '\t';
-                break;
-            case 'v':
-                o = '\v';
-                break;
+                if ( accept( "null" ) ) {
+                    b.appendNull( fieldName );
+                    return true;
+                }
+                return date( fieldName, b );
+            case 'u':
+                if ( !accept( "undefined" ) )
+                    return false;
+                b.appendUndefined( fieldName );
+                return true;
+            case 'D':
+                if ( _input[ 1 ] == 'b' )
+                    return dbref( fieldName, b );
+                return date( fieldName, b );
+            case 'O':
+                return oid( fieldName, b );
             default:
-                assert( false );
+                return number( fieldName, b );
+            }
+        }
+
+        // array := '[' [ value { ',' value } ] ']'
+        bool array( const char *fieldName, BSONObjBuilder &b ) {
+            if ( !accept( '[' ) )
+                return false;
+            BSONObjBuilder sub( b.subarrayStart( fieldName ) );
+            if ( !accept( ']' ) ) {
+                int i = 0;
+                do {
+                    if ( !value( BSONObjBuilder::numStr( i++ ).c_str(), sub ) )
+                        return false;
+                } while ( accept( ',' ) );
+                if ( !accept( ']' ) )
+                    return false;
+            }
+            sub.done();
+            return true;
+        }
+
+        /** the extended json objects, { "$date" : ... } and the like */
+        bool extendedObject( const char *fieldName, BSONObjBuilder &b ) {
+            if ( !accept( '{' ) )
+                return false;
+            if ( accept( "\"$date\"" ) ) {
+                unsigned long long d;
+                if ( !accept( ':' ) || !unsignedNumber( d ) || !accept( '}' ) )
+                    return false;
+                b.appendDate( fieldName, Date_t( d ) );
+                return true;
+            }
+            if ( accept( "\"$oid\"" ) ) {
+                OID o;
+                if ( !accept( ':' ) || !quotedOid( o ) || !accept( '}' ) )
+                    return false;
+                b.appendOID( fieldName, &o );
+                return true;
+            }
+            if ( accept( "\"$binary\"" ) )
+                return binData( fieldName, b );
+            if ( accept( "\"$ref\"" ) ) {
+                OID o;
+                if ( !accept( ':' ) || !doubleQuoted( _str ) || !accept( ',' ) ||
+                     !accept( "\"$id\"" ) || !accept( ':' ) || !quotedOid( o ) || !accept( '}' ) )
+                    return false;
+                b.appendDBRef( fieldName, _str, o );
+                return true;
+            }
+            if ( accept( "\"$timestamp\"" ) ) {
+                unsigned long long t, i;
+                if ( !accept( ':' ) || !accept( '{' ) ||
+                     !accept( "\"t\"" ) || !accept( ':' ) || !unsignedNumber( t ) || !accept( ',' ) ||
+                     !accept( "\"i\"" ) || !accept( ':' ) || !unsignedNumber( i ) ||
+                     i > numeric_limits<unsigned>::max() || !accept( '}' ) || !accept( '}' ) )
+                    return false;
+                b.appendTimestamp( fieldName, OpTime( (unsigned) ( t / 1000 ), (unsigned) i ).asDate() );
+                return true;
+            }
+            if ( accept( "\"$regex\"" ) ) {
+                if ( !accept( ':' ) || !doubleQuoted( _str ) || !accept( ',' ) ||
+                     !accept( "\"$options\"" ) || !accept( ':' ) || !accept( '"' ) )
+                    return false;
+                const char *options = _input;
+                while ( isAlpha( *_input ) )
+                    ++_input;
+                const char *optionsEnd = _input;
+                if ( *_input++ != '"' || !accept( '}' ) )
+                    return false;
+                b.appendRegex( fieldName, _str, string( options, optionsEnd ) );
+                return true;
+            }
+            return false;
+        }
+
+        // after { "$binary" -- : "<base64>" , "$type" : "<hex byte>" }
+        bool binData( const char *fieldName, BSONObjBuilder &b ) {
+            if ( !accept( ':' ) || !accept( '"' ) )
+                return false;
+            const char *start = _input;
+            while ( isAlpha( *_input ) || isDigit( *_input ) || *_input == '+' || *_input == '/' )
+                ++_input;
+            while ( *_input == '=' )
+                ++_input;
+            const char *end = _input;
+            if ( *_input++ != '"' )
+                return false;
+            massert( 10339 ,  "Badly formatted bindata", ( end - start ) % 4 == 0 );
+            if ( !accept( ',' ) || !accept( "\"$type\"" ) || !accept( ':' ) || !accept( '"' ) ||
+                 !isHex( _input[ 0 ] ) || !isHex( _input[ 1 ] ) || _input[ 2 ] != '"' )
+                return false;
+            BinDataType type = BinDataType( fromHex( _input ) );
+            _input += 3;
+            if ( !accept( '}' ) )
+                return false;
+            string data = base64::decode( string( start, end ) );
+            b.appendBinData( fieldName, data.length(), type, data.data() );
+            return true;
+        }
+
+        // [ new ] Date( <millis> )
+        bool date( const char *fieldName, BSONObjBuilder &b ) {
+            accept( "new" );
+            unsigned long long d;
+            if ( !accept( "Date" ) || !accept( '(' ) || !unsignedNumber( d ) || !accept( ')' ) )
+                return false;
+            b.appendDate( fieldName, Date_t( d ) );
+            return true;
+        }
+
+        // ObjectId( "<24 hex digits>" )
+        bool oid( const char *fieldName, BSONObjBuilder &b ) {
+            OID o;
+            if ( !accept( "ObjectId" ) || !accept( '(' ) || !quotedOid( o ) || !accept( ')' ) )
+                return false;
+            b.appendOID( fieldName, &o );
+            return true;
+        }
+
+        // Dbref( "<ns>" , "<24 hex digits>" )
+        bool dbref( const char *fieldName, BSONObjBuilder &b ) {
+            OID o;
+            if ( !accept( "Dbref" ) || !accept( '(' ) || !doubleQuoted( _str ) || !accept( ',' ) ||
+                 !quotedOid( o ) || !accept( ')' ) )
+                return false;
+            b.appendDBRef( fieldName, _str, o );
+            return true;
+        }
+
+        bool quotedOid( OID &o ) {
+            if ( !accept( '"' ) )
+                return false;
+            for( int i = 0; i < 24; ++i )
+                if ( !isHex( _input[ i ] ) )
+                    return false;
+            if ( _input[ 24 ] != '"' )
+                return false;
+            o = stringToOid( _input );
+            _input += 25;
+            return true;
+        }
+
+        /** a regex literal, /re/flags.  Only the escapes below are understood. */
+        bool regex( const char *fieldName, BSONObjBuilder &b ) {
+            if ( !accept( '/' ) )
+                return false;
+            _str.clear();
+            while ( true ) {
+                const char *run = _input;
+                while ( (unsigned char) *_input >= 0x20 && *_input != '/' && *_input != '\\' )
+                    ++_input;
+                _str.append( run, _input - run );
+                if ( *_input == '/' )
+                    break;
+                if ( *_input != '\\' )
+                    return false;
+                char c = *++_input;
+                ++_input;
+                switch ( c ) {
+                case '"': _str += '"'; break;
+                case '\\': _str += '\\'; break;
+                case '/': _str += '/'; break;
+                case 'b': _str += '\b'; break;
+                case 'f': _str += '\f'; break;
+                case 'n': _str += '\n'; break;
+                case 'r': _str += '\r'; break;
+                case 't': _str += '\t'; break;
+                case 'u':
+                    if ( !unicode( _str ) )
+                        return false;
+                    break;
+                default:
+                    --_input;
+                    return false;
+                }
+            }
+            const char *options = ++_input;
+            while ( *_input == 'i' || *_input == 'g' || *_input == 'm' )
+                ++_input;
+            b.appendRegex( fieldName, _str, string( options, _input ) );
+            return true;
+        }
+
+        bool doubleQuoted( string &s ) {
+            skipWhite();
+            return *_input == '"' && quoted( s );
+        }
+
+        /** a string in single or double quotes, decoded into s */
+        bool quoted( string &s ) {
+            const char quote = *_input++;
+            s.clear();
+            while ( true ) {
+                // Copy the longest run of plain characters at once.
+                const char *run = _input;
+                while ( (unsigned char) *_input >= 0x20 && *_input != quote && *_input != '\\' )
+                    ++_input;
+                s.append( run, _input - run );
+                if ( *_input == quote ) {
+                    ++_input;
+                    return true;
+                }
+                if ( *_input != '\\' )
+                    return false; // a control character, or the end of the input
+                char c = *++_input;
+                ++_input;
+                switch ( c ) {
+                case 'b': s += '\b'; break;
+                case 'f': s += '\f'; break;
+                case 'n': s += '\n'; break;
+                case 'r': s += '\r'; break;
+                case 't': s += '\t'; break;
+                case 'v': s += '\v'; break;
+                case 'u':
+                    // Without four hex digits \u is just a u, like any other escaped character.
+                    if ( !unicode( s ) )
+                        s += 'u';
+                    break;
+                case 'x':
+                case '\0':
+                    --_input;
+                    return false;
+                default:
+                    // hex and octal aren't supported
+                    if ( isDigit( c ) ) {
+                        --_input;
+                        return false;
+                    }
+                    s += c;
+                }
             }
-            b.ss << o;
         }
-        ObjectBuilder &b;
-    };
 
-    struct chU {
-        chU( ObjectBuilder &_b ) : b( _b ) {}
-        void operator() ( const char *start, const char *end ) const {
-            unsigned char first = fromHex( start );
-            unsigned char second = fromHex( start + 2 );
+        /** after \u, four hex digits converted to utf8 */
+        bool unicode( string &s ) {
+            for( int i = 0; i < 4; ++i )
+                if ( !isHex( _input[ i ] ) )
+                    return false;
+            unsigned char first = fromHex( _input );
+            unsigned char second = fromHex( _input + 2 );
+            _input += 4;
             if ( first == 0 && second < 0x80 )
-                b.ss << second;
+                s += (char) second;
             else if ( first < 0x08 ) {
-                b.ss << char( 0xc0 | ( ( first << 2 ) | ( second >> 6 ) ) );
-                b.ss << char( 0x80 | ( ~0xc0 & second ) );
+                s += char( 0xc0 | ( ( first << 2 ) | ( second >> 6 ) ) );
+                s += char( 0x80 | ( ~0xc0 & second ) );
             }
             else {
-                b.ss << char( 0xe0 | ( first >> 4 ) );
-                b.ss << char( 0x80 | ( ~0xc0 & ( ( first << 2 ) | ( second >> 6 ) ) ) );
-                b.ss << char( 0x80 | ( ~0xc0 & second ) );
+                s += char( 0xe0 | ( first >> 4 ) );
+                s += char( 0x80 | ( ~0xc0 & ( ( first << 2 ) | ( second >> 6 ) ) ) );
+                s += char( 0x80 | ( ~0xc0 & second ) );
+            }
+            return true;
+        }
+
+        /** decimal digits, failing on overflow */
+        bool unsignedNumber( unsigned long long &x ) {
+            skipWhite();
+            if ( !isDigit( *_input ) )
+                return false;
+            x = 0;
+            for( ; isDigit( *_input ); ++_input ) {
+                unsigned d = *_input - '0';
+                if ( x > ( numeric_limits<unsigned long long>::max() - d ) / 10 )
+                    return false;
+                x = x * 10 + d;
+            }
+            return true;
+        }
+
+        /** A real, one with a point or an exponent, is a double; anything else an int if it
+            fits or else a long long.
+        */
+        bool number( const char *fieldName, BSONObjBuilder &b ) {
+            const char *start = _input;
+            const char *p = start;
+            if ( *p == '+' || *p == '-' )
+                ++p;
+            const char *digits = p;
+            while ( isDigit( *p ) )
+                ++p;
+            bool mantissa = p > digits;
+            bool real = false;
+            if ( *p == '.' ) {
+                const char *q = p + 1;
+                while ( isDigit( *q ) )
+                    ++q;
+                if ( mantissa || q > p + 1 ) {
+                    p = q;
+                    mantissa = real = true;
+                }
+            }
+            if ( mantissa && ( *p == 'e' || *p == 'E' ) ) {
+                const char *q = p + 1;
+                if ( *q == '+' || *q == '-' )
+                    ++q;
+                if ( isDigit( *q ) ) {
+                    while ( isDigit( *q ) )
+                        ++q;
+                    p = q;
+                    real = true;
+                }
             }
-        }
-        ObjectBuilder &b;
-    };
-
-    struct chClear {
-        chClear( ObjectBuilder &_b ) : b( _b ) {}
-        void operator() ( const char c ) const {
-            b.popString();
-        }
-        ObjectBuilder &b;
-    };
-
-    struct fieldNameEnd {
-        fieldNameEnd( ObjectBuilder &_b ) : b( _b ) {}
-        void operator() ( const char *start, const char *end ) const {
-            string name = b.popString();
-            massert( 10338 ,  "Invalid use of reserved field name: " + name,
-                     name != "$oid" &&
-                     name != "$binary" &&
-                     name != "$type" &&
-                     name != "$date" &&
-                     name != "$timestamp" &&
-                     name != "$regex" &&
-                     name != "$options" );
-            b.fieldNames.back() = name;
-        }
-        ObjectBuilder &b;
-    };
-
-    struct unquotedFieldNameEnd {
-        unquotedFieldNameEnd( ObjectBuilder &_b ) : b( _b ) {}
-        void operator() ( const char *start, const char *end ) const {
-            string name( start, end );
-            b.fieldNames.back() = name;
-        }
-        ObjectBuilder &b;
-    };
-
-    struct stringEnd {
-        stringEnd( ObjectBuilder &_b ) : b( _b ) {}
-        void operator() ( const char *start, const char *end ) const {
-            b.back()->append( b.fieldName(), b.popString() );
-        }
-        ObjectBuilder &b;
-    };
 
-    struct numberValue {
-        numberValue( ObjectBuilder &_b ) : b( _b ) {}
-        void operator() ( const char *start, const char *end ) const {
-            string raw(start);
-            double val;
+            if ( real ) {
+                // We use strtod rather than converting the digits ourselves to ensure
+                // consistency with other string to double conversions in our code.
+                b.append( fieldName, strtod( start, 0 ) );
+                _input = p;
+                return true;
+            }
 
             // strtod isn't able to deal with NaN and inf in a portable way.
             // Correspondingly, we perform the conversions explicitly.
-
-            if ( ! raw.compare(0, 3, "NaN" ) ) {
-                val = std::numeric_limits<double>::quiet_NaN();
-            } 
-            else if ( ! raw.compare(0, 8, "Infinity" ) ) {
-                val = std::numeric_limits<double>::infinity();
-            } 
-            else if ( ! raw.compare(0, 9, "-Infinity" ) ) {
-                val = -std::numeric_limits<double>::infinity();
+            if ( accept( "NaN" ) ) {
+                b.append( fieldName, numeric_limits<double>::quiet_NaN() );
+                return true;
             }
-            else {
-                // We re-parse the numeric string here because spirit parsing of strings
-                // to doubles produces different results from strtod in some cases and
-                // we want to use strtod to ensure consistency with other string to
-                // double conversions in our code.
-
-                val = strtod( start, 0 );
+            if ( accept( "Infinity" ) ) {
+                b.append( fieldName, numeric_limits<double>::infinity() );
+                return true;
+            }
+            if ( accept( "-Infinity" ) ) {
+                b.append( fieldName, -numeric_limits<double>::infinity() );
+                return true;
             }
 
-            b.back()->append( b.fieldName(), val );
-        }
-        ObjectBuilder &b;
-    };
-
-    struct intValue {
-        intValue( ObjectBuilder &_b ) : b( _b ) {}
-        void operator() ( long long num ) const {
-            if (num >= numeric_limits<int>::min() && num <= numeric_limits<int>::max())
-                b.back()->append( b.fieldName(), (int)num );
+            if ( !mantissa || p - digits > numeric_limits<long long>::digits10 + 1 )
+                return false;
+            unsigned long long limit = *start == '-' ?
+                (unsigned long long) numeric_limits<long long>::max() + 1 :
+                (unsigned long long) numeric_limits<long long>::max();
+            unsigned long long x = 0;
+            for( const char *q = digits; q < p; ++q ) {
+                unsigned d = *q - '0';
+                if ( x > ( limit - d ) / 10 )
+                    return false;
+                x = x * 10 + d;
+            }
+            long long num = *start == '-' ? (long long) ( 0 - x ) : (long long) x;
+            if ( num >= numeric_limits<int>::min() && num <= numeric_limits<int>::max() )
+                b.append( fieldName, (int) num );
             else
-                b.back()->append( b.fieldName(), num );
-        }
-        ObjectBuilder &b;
-    };
-
-    struct subobjectEnd {
-        subobjectEnd( ObjectBuilder &_b ) : b( _b ) {}
-        void operator() ( const char *start, const char *end ) const {
-            b.pop();
-        }
-        ObjectBuilder &b;
-    };
-
-    struct arrayEnd {
-        arrayEnd( ObjectBuilder &_b ) : b( _b ) {}
-        void operator() ( const char *start, const char *end ) const {
-            b.pop();
-        }
-        ObjectBuilder &b;
-    };
-
-    struct trueValue {
-        trueValue( ObjectBuilder &_b ) : b( _b ) {}
-        void operator() ( const char *start, const char *end ) const {
-            b.back()->appendBool( b.fieldName(), true );
-        }
-        ObjectBuilder &b;
-    };
-
-    struct falseValue {
-        falseValue( ObjectBuilder &_b ) : b( _b ) {}
-        void operator() ( const char *start, const char *end ) const {
-            b.back()->appendBool( b.fieldName(), false );
-        }
-        ObjectBuilder &b;
-    };
-
-    struct nullValue {
-        nullValue( ObjectBuilder &_b ) : b( _b ) {}
-        void operator() ( const char *start, const char *end ) const {
-            b.back()->appendNull( b.fieldName() );
-        }
-        ObjectBuilder &b;
-    };
-
-    struct undefinedValue {
-        undefinedValue( ObjectBuilder &_b ) : b( _b ) {}
-        void operator() ( const char *start, const char *end ) const {
-            b.back()->appendUndefined( b.fieldName() );
-        }
-        ObjectBuilder &b;
-    };
-    
-    struct dbrefNS {
-        dbrefNS( ObjectBuilder &_b ) : b( _b ) {}
-        void operator() ( const char *start, const char *end ) const {
-            b.ns = b.popString();
-        }
-        ObjectBuilder &b;
-    };
-
-// NOTE s must be 24 characters.
-    OID stringToOid( const char *s ) {
-        OID oid;
-        char *oidP = (char *)( &oid );
-        for ( int i = 0; i < 12; ++i )
-            oidP[ i ] = fromHex( s + ( i * 2 ) );
-        return oid;
-    }
-
-    struct oidValue {
-        oidValue( ObjectBuilder &_b ) : b( _b ) {}
-        void operator() ( const char *start, const char *end ) const {
-            b.oid = stringToOid( start );
-        }
-        ObjectBuilder &b;
-    };
-
-    struct dbrefEnd {
-        dbrefEnd( ObjectBuilder &_b ) : b( _b ) {}
-        void operator() ( const char *start, const char *end ) const {
-            b.back()->appendDBRef( b.fieldName(), b.ns, b.oid );
-        }
-        ObjectBuilder &b;
-    };
-
-    struct oidEnd {
-        oidEnd( ObjectBuilder &_b ) : b( _b ) {}
-        void operator() ( const char *start, const char *end ) const {
-            b.back()->appendOID( b.fieldName(), &b.oid );
-        }
-        ObjectBuilder &b;
-    };
-
-    struct timestampEnd {
-        timestampEnd( ObjectBuilder &_b ) : b( _b ) {}
-        void operator() ( const char *start, const char *end ) const {
-            b.back()->appendTimestamp( b.fieldName(), b.timestamp.asDate() );
-        }
-        ObjectBuilder &b;
-    };
-
-    struct binDataBinary {
-        binDataBinary( ObjectBuilder &_b ) : b( _b ) {}
-        void operator() ( const char *start, const char *end ) const {
-            massert( 10339 ,  "Badly formatted bindata", ( end - start ) % 4 == 0 );
-            string encoded( start, end );
-            b.binData = base64::decode( encoded );
-        }
-        ObjectBuilder &b;
-    };
-
-    struct binDataType {
-        binDataType( ObjectBuilder &_b ) : b( _b ) {}
-        void operator() ( const char *start, const char *end ) const {
-            b.binDataType = BinDataType( fromHex( start ) );
-        }
-        ObjectBuilder &b;
-    };
-
-    struct binDataEnd {
-        binDataEnd( ObjectBuilder &_b ) : b( _b ) {}
-        void operator() ( const char *start, const char *end ) const {
-            b.back()->appendBinData( b.fieldName(), b.binData.length(),
-                                     b.binDataType, b.binData.data() );
-        }
-        ObjectBuilder &b;
-    };
-
-    struct timestampSecs {
-        timestampSecs( ObjectBuilder &_b ) : b( _b ) {}
-        void operator() ( unsigned long long x) const {
-            b.timestamp = OpTime( (unsigned) (x/1000) , 0);
-        }
-        ObjectBuilder &b;
-    };
-
-    struct timestampInc {
-        timestampInc( ObjectBuilder &_b ) : b( _b ) {}
-        void operator() ( unsigned x) const {
-            b.timestamp = OpTime(b.timestamp.getSecs(), x);
+                b.append( fieldName, num );
+            _input = p;
+            return true;
         }
-        ObjectBuilder &b;
-    };
-
-    struct dateValue {
-        dateValue( ObjectBuilder &_b ) : b( _b ) {}
-        void operator() ( Date_t v ) const {
-            b.date = v;
-        }
-        ObjectBuilder &b;
-    };
-
-    struct dateEnd {
-        dateEnd( ObjectBuilder &_b ) : b( _b ) {}
-        void operator() ( const char *start, const char *end ) const {
-            b.back()->appendDate( b.fieldName(), b.date );
-        }
-        ObjectBuilder &b;
-    };
-
-    struct regexValue {
-        regexValue( ObjectBuilder &_b ) : b( _b ) {}
-        void operator() ( const char *start, const char *end ) const {
-            b.regex = b.popString();
-        }
-        ObjectBuilder &b;
-    };
 
-    struct regexOptions {
-        regexOptions( ObjectBuilder &_b ) : b( _b ) {}
-        void operator() ( const char *start, const char *end ) const {
-            b.regexOptions = string( start, end );
-        }
-        ObjectBuilder &b;
-    };
-
-    struct regexEnd {
-        regexEnd( ObjectBuilder &_b ) : b( _b ) {}
-        void operator() ( const char *start, const char *end ) const {
-            b.back()->appendRegex( b.fieldName(), b.regex, b.regexOptions );
-        }
-        ObjectBuilder &b;
-    };
-
-// One gotcha with this parsing library is probably best ilustrated with an
-// example.  Say we have a production like this:
-// z = ( ch_p( 'a' )[ foo ] >> ch_p( 'b' ) ) | ( ch_p( 'a' )[ foo ] >> ch_p( 'c' ) );
-// On input "ac", action foo() will be called twice -- once as the parser tries
-// to match "ab", again as the parser successfully matches "ac".  Sometimes
-// the grammar can be modified to eliminate these situations.  Here, for example:
-// z = ch_p( 'a' )[ foo ] >> ( ch_p( 'b' ) | ch_p( 'c' ) );
-// However, this is not always possible.  In my implementation I've tried to
-// stick to the following pattern: store fields fed to action callbacks
-// temporarily as ObjectBuilder members, then append to a BSONObjBuilder once
-// the parser has completely matched a nonterminal and won't backtrack.  It's
-// worth noting here that this parser follows a short-circuit convention.  So,
-// in the original z example on line 3, if the input was "ab", foo() would only
-// be called once.
-    struct JsonGrammar : public grammar< JsonGrammar > {
-    public:
-        JsonGrammar( ObjectBuilder &_b ) : b( _b ) {}
-
-        template < typename ScannerT >
-        struct definition {
-            definition( JsonGrammar const &self ) {
-                object = ch_p( '{' )[ objectStart( self.b ) ] >> !members >> '}';
-                members = list_p((fieldName >> ':' >> value) , ',');
-                fieldName =
-                    str[ fieldNameEnd( self.b ) ] |
-                    singleQuoteStr[ fieldNameEnd( self.b ) ] |
-                    unquotedFieldName[ unquotedFieldNameEnd( self.b ) ];
-                array = ch_p( '[' )[ arrayStart( self.b ) ] >> !elements >> ']';
-                elements = list_p(value, ch_p(',')[arrayNext( self.b )]);
-                value =
-                    str[ stringEnd( self.b ) ] |
-                    number[ numberValue( self.b ) ] |
-                    integer |
-                    array[ arrayEnd( self.b ) ] |
-                    lexeme_d[ str_p( "true" ) ][ trueValue( self.b ) ] |
-                    lexeme_d[ str_p( "false" ) ][ falseValue( self.b ) ] |
-                    lexeme_d[ str_p( "null" ) ][ nullValue( self.b ) ] |
-                    lexeme_d[ str_p( "undefined" ) ][ undefinedValue( self.b ) ] |
-                    singleQuoteStr[ stringEnd( self.b ) ] |
-                    date[ dateEnd( self.b ) ] |
-                    oid[ oidEnd( self.b ) ] |
-                    bindata[ binDataEnd( self.b ) ] |
-                    dbref[ dbrefEnd( self.b ) ] |
-                    timestamp[ timestampEnd( self.b ) ] |
-                    regex[ regexEnd( self.b ) ] |
-                    object[ subobjectEnd( self.b ) ] ;
-                // NOTE lexeme_d and rules don't mix well, so we have this mess.
-                // NOTE We use range_p rather than cntrl_p, because the latter is locale dependent.
-                str = lexeme_d[ ch_p( '"' )[ chClear( self.b ) ] >>
-                                *( ( ch_p( '\\' ) >>
-                                     (
-                                         ch_p( 'b' )[ chE( self.b ) ] |
-                                         ch_p( 'f' )[ chE( self.b ) ] |
-                                         ch_p( 'n' )[ chE( self.b ) ] |
-                                         ch_p( 'r' )[ chE( self.b ) ] |
-                                         ch_p( 't' )[ chE( self.b ) ] |
-                                         ch_p( 'v' )[ chE( self.b ) ] |
-                                         ( ch_p( 'u' ) >> ( repeat_p( 4 )[ xdigit_p ][ chU( self.b ) ] ) ) |
-                                         ( ~ch_p('x') & (~range_p('0','9'))[ ch( self.b ) ] ) // hex and octal aren't supported
-                                     )
-                                   ) |
-                                   ( ~range_p( 0x00, 0x1f ) & ~ch_p( '"' ) & ( ~ch_p( '\\' ) )[ ch( self.b ) ] ) ) >> '"' ];
-
-                singleQuoteStr = lexeme_d[ ch_p( '\'' )[ chClear( self.b ) ] >>
-                                           *( ( ch_p( '\\' ) >>
-                                                (
-                                                    ch_p( 'b' )[ chE( self.b ) ] |
-                                                    ch_p( 'f' )[ chE( self.b ) ] |
-                                                    ch_p( 'n' )[ chE( self.b ) ] |
-                                                    ch_p( 'r' )[ chE( self.b ) ] |
-                                                    ch_p( 't' )[ chE( self.b ) ] |
-                                                    ch_p( 'v' )[ chE( self.b ) ] |
-                                                    ( ch_p( 'u' ) >> ( repeat_p( 4 )[ xdigit_p ][ chU( self.b ) ] ) ) |
-                                                    ( ~ch_p('x') & (~range_p('0','9'))[ ch( self.b ) ] ) // hex and octal aren't supported
-                                                )
-                                              ) |
-                                              ( ~range_p( 0x00, 0x1f ) & ~ch_p( '\'' ) & ( ~ch_p( '\\' ) )[ ch( self.b ) ] ) ) >> '\'' ];
-
-                // real_p accepts numbers with nonsignificant zero prefixes, which
-                // aren't allowed in JSON.  Oh well.
-                number = strict_real_p | str_p( "NaN" ) | str_p( "Infinity" ) | str_p( "-Infinity" );
-
-                static int_parser<long long, 10,  1, numeric_limits<long long>::digits10 + 1> long_long_p;
-                integer = long_long_p[ intValue(self.b) ];
-
-                // We allow a subset of valid js identifier names here.
-                unquotedFieldName = lexeme_d[ ( alpha_p | ch_p( '$' ) | ch_p( '_' ) ) >> *( ( alnum_p | ch_p( '$' ) | ch_p( '_'  )) ) ];
-
-                dbref = dbrefS | dbrefT;
-                dbrefS = ch_p( '{' ) >> "\"$ref\"" >> ':' >>
-                         str[ dbrefNS( self.b ) ] >> ',' >> "\"$id\"" >> ':' >> quotedOid >> '}';
-                dbrefT = str_p( "Dbref" ) >> '(' >> str[ dbrefNS( self.b ) ] >> ',' >>
-                         quotedOid >> ')';
-
-                timestamp = ch_p( '{' ) >> "\"$timestamp\"" >> ':' >> '{' >>
-                    "\"t\"" >> ':' >> uint_parser<unsigned long long, 10, 1, -1>()[ timestampSecs(self.b) ] >> ',' >>
-                    "\"i\"" >> ':' >> uint_parser<unsigned int, 10, 1, -1>()[ timestampInc(self.b) ] >> '}' >>'}';
-
-                oid = oidS | oidT;
-                oidS = ch_p( '{' ) >> "\"$oid\"" >> ':' >> quotedOid >> '}';
-                oidT = str_p( "ObjectId" ) >> '(' >> quotedOid >> ')';
-
-                quotedOid = lexeme_d[ '"' >> ( repeat_p( 24 )[ xdigit_p ] )[ oidValue( self.b ) ] >> '"' ];
-
-                bindata = ch_p( '{' ) >> "\"$binary\"" >> ':' >>
-                          lexeme_d[ '"' >> ( *( range_p( 'A', 'Z' ) | range_p( 'a', 'z' ) | range_p( '0', '9' ) | ch_p( '+' ) | ch_p( '/' ) ) >> *ch_p( '=' ) )[ binDataBinary( self.b ) ] >> '"' ] >> ',' >> "\"$type\"" >> ':' >>
-                          lexeme_d[ '"' >> ( repeat_p( 2 )[ xdigit_p ] )[ binDataType( self.b ) ] >> '"' ] >> '}';
-
-                // TODO: this will need to use a signed parser at some point
-                date = dateS | dateT;
-                dateS = ch_p( '{' ) >> "\"$date\"" >> ':' >> uint_parser< Date_t >()[ dateValue( self.b ) ] >> '}';
-                dateT = !str_p("new") >> str_p( "Date" ) >> '(' >> uint_parser< Date_t >()[ dateValue( self.b ) ] >> ')';
-
-                regex = regexS | regexT;
-                regexS = ch_p( '{' ) >> "\"$regex\"" >> ':' >> str[ regexValue( self.b ) ] >> ',' >> "\"$options\"" >> ':' >> lexeme_d[ '"' >> ( *( alpha_p ) )[ regexOptions( self.b ) ] >> '"' ] >> '}';
-                // FIXME Obviously it would be nice to unify this with str.
-                regexT = lexeme_d[ ch_p( '/' )[ chClear( self.b ) ] >>
-                                   *( ( ch_p( '\\' ) >>
-                                        ( ch_p( '"' )[ chE( self.b ) ] |
-                                          ch_p( '\\' )[ chE( self.b ) ] |
-                                          ch_p( '/' )[ chE( self.b ) ] |
-                                          ch_p( 'b' )[ chE( self.b ) ] |
-                                          ch_p( 'f' )[ chE( self.b ) ] |
-                                          ch_p( 'n' )[ chE( self.b ) ] |
-                                          ch_p( 'r' )[ chE( self.b ) ] |
-                                          ch_p( 't' )[ chE( self.b ) ] |
-                                          ( ch_p( 'u' ) >> ( repeat_p( 4 )[ xdigit_p ][ chU( self.b ) ] ) ) ) ) |
-                                      ( ~range_p( 0x00, 0x1f ) & ~ch_p( '/' ) & ( ~ch_p( '\\' ) )[ ch( self.b ) ] ) ) >> str_p( "/" )[ regexValue( self.b ) ]
-                                   >> ( *( ch_p( 'i' ) | ch_p( 'g' ) | ch_p( 'm' ) ) )[ regexOptions( self.b ) ] ];
-            }
-            rule< ScannerT > object, members, array, elements, value, str, number, integer,
-                  dbref, dbrefS, dbrefT, timestamp, timestampS, timestampT, oid, oidS, oidT, 
-                  bindata, date, dateS, dateT, regex, regexS, regexT, quotedOid, fieldName, 
-                  unquotedFieldName, singleQuoteStr;
-            const rule< ScannerT > &start() const {
-                return object;
-            }
-        };
-        ObjectBuilder &b;
+        const char *_input;
+        string _name; // decoded field name
+        string _str;  // decoded string value
     };
 
     BSONObj fromjson( const char *str , int* len) {
@@ -630,20 +535,23 @@ namespace mongo {
             return BSONObj();
         }
 
-        ObjectBuilder b;
-        JsonGrammar parser( b );
-        parse_info<> result = parse( str, parser, space_p );
+        BSONObjBuilder b;
+        JParse parser( str );
+        bool ok = parser.object( b );
         if (len) {
-            *len = result.stop - str;
+            *len = parser.pos() - str;
+        }
+        else if ( ok ) {
+            // trailing white space, such as a line's end, is allowed
+            parser.skipWhite();
+            ok = *parser.pos() == '\0';
         }
-        else if ( !result.full ) {
-            int limit = strnlen(result.stop , 10);
+        if ( !ok ) {
+            int limit = strnlen( parser.pos() , 10 );
             if (limit == -1) limit = 10;
-            msgasserted(10340, "Failure parsing JSON string near: " + string( result.stop, limit ));
+            msgasserted(10340, "Failure parsing JSON string near: " + string( parser.pos(), limit ));
         }
-        BSONObj ret = b.pop();
-        assert( b.empty() );
-        return ret;
+        return b.obj();
     }
 
     BSONObj fromjson( const string &str ) {
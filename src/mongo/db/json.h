@@ -35,7 +35,9 @@ namespace mongo {
     */
     BSONObj fromjson(const string &str);
 
-    /** len will be size of JSON object in text chars. */
+    /** len will be size of JSON object in text chars.  Text may follow the object, so
+        newline delimited input can be parsed an object at a time by advancing str by len.
+    */
     BSONObj fromjson(const char *str, int* len=NULL);
 
 } // namespace mongo
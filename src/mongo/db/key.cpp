@@ -663,6 +663,264 @@ namespace mongo {
         return true;
     }
 
+    // KeyV2
+
+    KeyV2Owned::KeyV2Owned(const BSONObj& obj) : _k(obj) {
+        assign(KeyV2(_k));
+    }
+
+    void KeyV2::copyTo(int from, int to, char *dest) const {
+        if( from < _shared ) {
+            int n = min(to, _shared) - from;
+            memcpy(dest, _ref + from, n);
+            dest += n;
+            from += n;
+        }
+        if( from < to )
+            memcpy(dest, _suffix + (from - _shared), to - from);
+    }
+
+    /** Gives the elements of a compact format KeyV2 one at a time as contiguous bytes: in place,
+        except for the element spanning the end of the shared bytes, which is put together in a
+        buffer.
+    */
+    class KeyV2Elements : boost::noncopyable {
+    public:
+        KeyV2Elements(const KeyV2& k) : _k(k), _pos(0) { }
+        /** @return the next element, valid until the next call */
+        const unsigned char * next() {
+            unsigned char head[2];
+            head[0] = _k.at(_pos);
+            unsigned type = head[0] & cCANONTYPEMASK;
+            if( type == cstring || type == cbindata )
+                head[1] = _k.at(_pos + 1);
+            int from = _pos;
+            _pos += sizeOfElement(head);
+            if( _pos <= _k._shared )
+                return (const unsigned char *) _k._ref + from;
+            if( from >= _k._shared )
+                return (const unsigned char *) _k._suffix + (from - _k._shared);
+            _k.copyTo(from, _pos, (char *) _buf);
+            return _buf;
+        }
+    private:
+        const KeyV2& _k;
+        int _pos;
+        unsigned char _buf[257]; // the largest element, a string of 255 bytes
+    };
+
+    int KeyV2::woCompare(const KeyV2& right, const Ordering &order) const {
+        const char *l = contiguous();
+        const char *r = right.contiguous();
+        if( l && r )
+            return KeyV1(l).woCompare(KeyV1(r), order);
+
+        if( !isCompactFormat() || !right.isCompactFormat() )
+            return toBson().woCompare(right.toBson(), order, /*considerfieldname*/false);
+
+        KeyV2Elements L(*this);
+        KeyV2Elements R(right);
+        unsigned mask = 1;
+        while( 1 ) {
+            const unsigned char *lp = L.next();
+            const unsigned char *rp = R.next();
+            char lval = *lp;
+            char rval = *rp;
+            {
+                int x = compare(lp, rp);
+                if( x ) {
+                    if( order.descending(mask) )
+                        x = -x;
+                    return x;
+                }
+            }
+
+            {
+                int x = ((int)(lval & cHASMORE)) - ((int)(rval & cHASMORE));
+                if( x )
+                    return x;
+                if( (lval & cHASMORE) == 0 )
+                    break;
+            }
+
+            mask <<= 1;
+        }
+
+        return 0;
+    }
+
+    bool KeyV2::woEqual(const KeyV2& right) const {
+        // only for unique index checks, so a split key is simply put together
+        StackBufBuilder lb;
+        StackBufBuilder rb;
+        const char *l = contiguous();
+        if( !l ) {
+            char *p = lb.skip(_size);
+            copyTo(0, _size, p);
+            l = p;
+        }
+        const char *r = right.contiguous();
+        if( !r ) {
+            char *p = rb.skip(right._size);
+            right.copyTo(0, right._size, p);
+            r = p;
+        }
+        return KeyV1(l).woEqual(KeyV1(r));
+    }
+
+    BSONObj KeyV2::toBson() const {
+        if( const char *p = contiguous() )
+            return KeyV1(p).toBson();
+        // a split key is in compact format, so the BSON built from it owns its data
+        StackBufBuilder b;
+        char *p = b.skip(_size);
+        copyTo(0, _size, p);
+        return KeyV1(p).toBson();
+    }
+
+    // KeyMemcmp
+
+    static void appendBigEndian(string& out, unsigned long long x, int len) {
+        for( int i = len - 1; i >= 0; i-- )
+            out.push_back( (char) (x >> (8 * i)) );
+    }
+
+    static void appendCString(string& out, const char *s) {
+        out.append(s, strlen(s) + 1);
+    }
+
+    /** zeros within the string are written 00 ff so that the 00 00 terminator sorts a string
+        before any longer one it is a prefix of */
+    static void appendEscaped(string& out, const char *s, int len) {
+        for( int i = 0; i < len; i++ ) {
+            out.push_back(s[i]);
+            if( s[i] == 0 )
+                out.push_back((char) 0xff);
+        }
+        out.push_back(0);
+        out.push_back(0);
+    }
+
+    static bool appendMemcmpObject(const BSONObj& o, string& out);
+
+    /** the value of e, after the canonical type byte its caller wrote. follows compareElementValues() */
+    static bool appendMemcmpValue(const BSONElement& e, string& out) {
+        switch( e.type() ) {
+        case MinKey:
+        case MaxKey:
+        case Undefined:
+        case jstNULL:
+            break;
+        case Bool:
+            // compared as signed chars
+            out.push_back( (char) (*e.value() ^ 0x80) );
+            break;
+        case Date:
+        case Timestamp:
+            {
+                // Date compares signed and Timestamp unsigned; they agree below 2^63
+                unsigned long long t = e.date();
+                if( t >> 63 )
+                    return false;
+                appendBigEndian(out, t, 8);
+                break;
+            }
+        case NumberLong:
+        case NumberInt:
+        case NumberDouble:
+            {
+                if( e.type() == NumberLong ) {
+                    long long n = e._numberLong();
+                    long long m = 2LL << 52;
+                    if( n > m || n < -m )
+                        return false;
+                }
+                double d = e.number();
+                unsigned long long bits = 0; // NaN is less than every other number
+                if( !isNaN(d) ) {
+                    if( d == 0 )
+                        d = 0; // -0 == 0
+                    memcpy(&bits, &d, sizeof(bits));
+                    const unsigned long long sign = 1ULL << 63;
+                    bits = ( bits & sign ) ? ~bits : ( bits | sign );
+                }
+                appendBigEndian(out, bits, 8);
+                break;
+            }
+        case jstOID:
+            out.append(e.value(), 12);
+            break;
+        case String:
+        case Symbol:
+        case Code:
+            appendEscaped(out, e.valuestr(), e.valuestrsize() - 1);
+            break;
+        case Object:
+        case Array:
+            return appendMemcmpObject(e.embeddedObject(), out);
+        case DBRef:
+            appendBigEndian(out, e.valuesize(), 4);
+            out.append(e.value(), e.valuesize());
+            break;
+        case BinData:
+            // length first, then subtype and data
+            appendBigEndian(out, e.objsize(), 4);
+            out.append(e.value() + 4, e.objsize() + 1);
+            break;
+        case RegEx:
+            appendCString(out, e.regex());
+            appendCString(out, e.regexFlags());
+            break;
+        case CodeWScope:
+            // strcmp of the scope's data stops at its first zero byte, as the encoding does
+            appendCString(out, e.codeWScopeCode());
+            appendCString(out, e.codeWScopeScopeData());
+            break;
+        default:
+            return false;
+        }
+        return true;
+    }
+
+    /** an embedded object: its elements with their field names, then 00 */
+    static bool appendMemcmpObject(const BSONObj& o, string& out) {
+        BSONObjIterator i(o);
+        while( i.more() ) {
+            BSONElement e = i.next();
+            out.push_back( (char) (e.canonicalType() + 2) );
+            appendCString(out, e.fieldName());
+            if( !appendMemcmpValue(e, out) )
+                return false;
+        }
+        out.push_back(0);
+        return true;
+    }
+
+    bool KeyMemcmp::encode(const BSONObj& key, const Ordering& o, string& out) {
+        const size_t start = out.size();
+        BSONObjIterator i(key);
+        unsigned mask = 1;
+        while( i.more() ) {
+            BSONElement e = i.next();
+            const size_t begin = out.size();
+            // +2 keeps MinKey's type byte above the 00 that ends the key
+            out.push_back( (char) (e.canonicalType() + 2) );
+            if( !appendMemcmpValue(e, out) ) {
+                out.resize(start);
+                return false;
+            }
+            // each element's bytes are prefix free, so inverting them reverses their order
+            if( o.descending(mask) ) {
+                for( size_t j = begin; j < out.size(); j++ )
+                    out[j] = ~out[j];
+            }
+            mask <<= 1;
+        }
+        // a key that runs out first is less in either direction
+        out.push_back(0);
+        return true;
+    }
+
     struct CmpUnitTest : public UnitTest {
         void run() {
             char a[2];
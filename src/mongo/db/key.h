@@ -112,4 +112,72 @@ namespace mongo {
         void traditional(const BSONObj& obj); // store as traditional bson not as compact format
     };
 
+    /** A key in a v2 (prefix compressed) bucket, read in place: the first 'shared' bytes of the
+        bucket's reference key followed by the bytes stored for the key.  A key that isn't in a
+        bucket is one whole KeyV1.  Like KeyV1 it doesn't own its data, so nothing is copied to
+        look at a key; only the element that spans the end of the shared bytes is put together
+        when comparing.
+    */
+    class KeyV2 {
+    public:
+        KeyV2() : _ref(0), _suffix(0), _shared(0), _size(0) { }
+        /** the key made of the first 'shared' bytes of ref followed by suffix, 'size' bytes in all */
+        KeyV2(const char *ref, int shared, const char *suffix, int size) :
+            _ref(ref), _suffix(suffix), _shared(shared), _size(size) { }
+        /** a whole key */
+        KeyV2(const KeyV1& k) : _ref(k.data()), _suffix(0), _shared(k.dataSize()), _size(_shared) { }
+
+        int woCompare(const KeyV2& r, const Ordering &o) const;
+        bool woEqual(const KeyV2& r) const;
+        BSONObj toBson() const;
+        string toString() const { return toBson().toString(); }
+
+        /** @return size of the key data */
+        int dataSize() const { return _size; }
+        /** @return byte i of the key data */
+        char at(int i) const { return i < _shared ? _ref[i] : _suffix[i - _shared]; }
+        /** copy bytes [from, to) of the key data to dest */
+        void copyTo(int from, int to, char *dest) const;
+
+        /** only used by geo.  keys in BSON format are never split, see sharedPrefix() in btree.cpp */
+        BSONElement _firstElement() const { return KeyV1(contiguous())._firstElement(); }
+        bool isCompactFormat() const { return KeyV1(_shared ? _ref : _suffix).isCompactFormat(); }
+        void assign(const KeyV2& rhs) { *this = rhs; }
+    private:
+        friend class KeyV2Elements;
+        /** @return the key data if it is in one piece, otherwise 0 */
+        const char *contiguous() const { return _shared == _size ? _ref : _shared == 0 ? _suffix : 0; }
+        const char *_ref;
+        const char *_suffix;
+        int _shared;
+        int _size;
+    };
+
+    /** A KeyV2 translated from a BSON object, for finding and inserting keys */
+    class KeyV2Owned : public KeyV2 {
+    public:
+        KeyV2Owned(const BSONObj& obj);
+    private:
+        KeyV1Owned _k;
+    };
+
+    /** Encodes keys as byte strings that order, under memcmp (shorter first on a common prefix),
+        as the keys order under BSONObj::woCompare(r, ordering, false).  A sorter can encode each
+        key once and then compare bytes instead of walking BSON on every compare.
+
+        Unlike KeyV1 any key pattern and direction is handled; descending fields are stored
+        inverted.  A few values have no exact encoding, see encode().
+    */
+    class KeyMemcmp {
+    public:
+        /** append the encoding of key under ordering o to out.
+            @return false, leaving out as it was, if key holds a Date before the epoch or a
+                    Timestamp of 2^63 or more (Dates compare signed and Timestamps unsigned, but
+                    they share a canonical type), or a NumberLong beyond 2^53.  woCompare agrees
+                    with memcmp on all other keys, so such keys may be compared the traditional
+                    way among encoded ones.
+        */
+        static bool encode(const BSONObj& key, const Ordering& o, string& out);
+    };
+
 };
@@ -29,6 +29,7 @@
 #include "client.h"
 
 #include "pdfile.h"
+#include "fieldoffsets.h"
 
 namespace {
     inline pcrecpp::RE_Options flags2options(const char* flags) {
@@ -583,8 +584,8 @@ namespace mongo {
         return (op & z);
     }
 
-    int Matcher::inverseMatch(const char *fieldName, const BSONElement &toMatch, const BSONObj &obj, const ElementMatcher& bm , MatchDetails * details ) const {
-        int inverseRet = matchesDotted( fieldName, toMatch, obj, bm.inverseOfNegativeCompareOp(), bm , false , details );
+    int Matcher::inverseMatch(const char *fieldName, const BSONElement &toMatch, const BSONObj &obj, const ElementMatcher& bm , MatchDetails * details , const FieldOffsets *fields ) const {
+        int inverseRet = matchesDotted( fieldName, toMatch, obj, bm.inverseOfNegativeCompareOp(), bm , false , details , fields );
         if ( bm.negativeCompareOpContainsNull() ) {
             return ( inverseRet <= 0 ) ? 1 : 0;
         }
@@ -602,6 +603,7 @@ namespace mongo {
        obj       - database object to check against
        compareOp - Equality, LT, GT, etc.  This may be different than, and should supersede, the compare op in em. 
        isArr     -
+       fields    - if not null, where the top level fields of obj are
 
        Special forms:
 
@@ -614,7 +616,7 @@ namespace mongo {
         0 missing element
         1 match
     */
-    int Matcher::matchesDotted(const char *fieldName, const BSONElement& toMatch, const BSONObj& obj, int compareOp, const ElementMatcher& em , bool isArr, MatchDetails * details ) const {
+    int Matcher::matchesDotted(const char *fieldName, const BSONElement& toMatch, const BSONObj& obj, int compareOp, const ElementMatcher& em , bool isArr, MatchDetails * details , const FieldOffsets *fields ) const {
         DEBUGMATCHER( "\t matchesDotted : " << fieldName << " hasDetails: " << ( details ? "yes" : "no" ) );
 
         if ( compareOp == BSONObj::opALL ) {
@@ -622,7 +624,7 @@ namespace mongo {
             if ( em._allMatchers.size() ) {
                 // $all query matching will not be performed against indexes, so the field
                 // to match is always extracted from the full document.
-                BSONElement e = obj.getFieldDotted( fieldName );
+                BSONElement e = fields ? fields->getFieldDotted( fieldName ) : obj.getFieldDotted( fieldName );
                 // The $all/$elemMatch operator only matches arrays.
                 if ( e.type() != Array ) {
                     return -1;
@@ -683,7 +685,7 @@ namespace mongo {
         } // end opALL
 
         if ( compareOp == BSONObj::NE || compareOp == BSONObj::NIN ) {
-            return inverseMatch( fieldName, toMatch, obj, em , details );
+            return inverseMatch( fieldName, toMatch, obj, em , details , fields );
         }
 
         BSONElement e;
@@ -701,9 +703,14 @@ namespace mongo {
 
             const char *p = strchr(fieldName, '.');
             if ( p ) {
-                string left(fieldName, p-fieldName);
-
-                BSONElement se = obj.getField(left.c_str());
+                BSONElement se;
+                if ( fields ) {
+                    se = fields->getField(fieldName, (unsigned) (p-fieldName));
+                }
+                else {
+                    string left(fieldName, p-fieldName);
+                    se = obj.getField(left.c_str());
+                }
                 if ( se.eoo() )
                     ;
                 else if ( se.type() != Object && se.type() != Array )
@@ -755,7 +762,7 @@ namespace mongo {
                 return 0;
             }
             else {
-                e = obj.getField(fieldName);
+                e = fields ? fields->getField(fieldName) : obj.getField(fieldName);
             }
         }
 
@@ -823,15 +830,18 @@ namespace mongo {
     bool Matcher::matches(const BSONObj& jsobj , MatchDetails * details ) const {
         LOG(5) << "Matcher::matches() " << jsobj.toString() << endl;
 
-        /* assuming there is usually only one thing to match.  if more this
-           could be slow sometimes. */
+        /* with more than one thing to match, locate jsobj's fields once rather than
+           scanning for each of them.  an index key is looked up by index names instead. */
+        FieldOffsets fields( jsobj );
+        const FieldOffsets *pFields =
+            ( _basics.size() > 1 && _constrainIndexKey.isEmpty() ) ? &fields : 0;
 
         // check normal non-regex cases:
         for ( unsigned i = 0; i < _basics.size(); i++ ) {
             const ElementMatcher& bm = _basics[i];
             const BSONElement& m = bm._toMatch;
             // -1=mismatch. 0=missing element. 1=match
-            int cmp = matchesDotted(m.fieldName(), m, jsobj, bm._compareOp, bm , false , details );
+            int cmp = matchesDotted(m.fieldName(), m, jsobj, bm._compareOp, bm , false , details , pFields );
             if ( cmp == 0 && bm._compareOp == BSONObj::opEXISTS ) {
                 // If missing, match cmp is opposite of $exists spec.
                 cmp = -retExistsFound(bm);
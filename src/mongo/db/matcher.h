@@ -27,6 +27,7 @@ namespace mongo {
 
     class Cursor;
     class CoveredIndexMatcher;
+    class FieldOffsets;
     class Matcher;
     class FieldRangeVector;
 
@@ -123,10 +124,12 @@ namespace mongo {
        TODO: we should rewrite the matcher to be more an AST style.
     */
     class Matcher : boost::noncopyable {
+        /** @param fields if not null, locates the top level fields of obj */
         int matchesDotted(
             const char *fieldName,
             const BSONElement& toMatch, const BSONObj& obj,
-            int compareOp, const ElementMatcher& bm, bool isArr , MatchDetails * details ) const;
+            int compareOp, const ElementMatcher& bm, bool isArr , MatchDetails * details ,
+            const FieldOffsets *fields = 0 ) const;
 
         /**
          * Perform a NE or NIN match by returning the inverse of the opposite matching operation.
@@ -135,7 +138,8 @@ namespace mongo {
         int inverseMatch(
             const char *fieldName,
             const BSONElement &toMatch, const BSONObj &obj,
-            const ElementMatcher&bm, MatchDetails * details ) const;
+            const ElementMatcher&bm, MatchDetails * details ,
+            const FieldOffsets *fields = 0 ) const;
 
     public:
         static int opDirection(int op) {
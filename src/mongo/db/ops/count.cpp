@@ -18,13 +18,83 @@
 
 #include "count.h"
 
+#include "../btree.h"
 #include "../client.h"
 #include "../clientcursor.h"
 #include "../namespace.h"
 #include "../queryutil.h"
 
 namespace mongo {
-    
+
+    static bool exactBoundsValue( const BSONElement &e ) {
+        switch( e.type() ) {
+        case Object:
+        case Array:
+        case RegEx:
+        case jstNULL:
+        case Undefined:
+        case MinKey:
+        case MaxKey:
+        case CodeWScope:
+            return false;
+        default:
+            return true;
+        }
+    }
+
+    /**
+     * @return true if a document matches query exactly when its index keys fall within the
+     * index bounds generated for query: plain equalities, $in lists and $gt/$gte/$lt/$lte on
+     * scalar values.  Regexes, nulls, arrays, objects and other operators are not exact.
+     */
+    static bool exactBoundsQuery( const BSONObj &query ) {
+        BSONObjIterator i( query );
+        while( i.more() ) {
+            BSONElement e = i.next();
+            if ( e.fieldName()[ 0 ] == '$' ) {
+                return false;
+            }
+            if ( e.type() != Object ) {
+                if ( !exactBoundsValue( e ) ) {
+                    return false;
+                }
+                continue;
+            }
+            BSONObjIterator j( e.embeddedObject() );
+            if ( !j.more() ) {
+                return false;
+            }
+            while( j.more() ) {
+                BSONElement op = j.next();
+                switch( op.getGtLtOp( -1 ) ) {
+                case BSONObj::LT:
+                case BSONObj::LTE:
+                case BSONObj::GT:
+                case BSONObj::GTE:
+                    if ( !exactBoundsValue( op ) ) {
+                        return false;
+                    }
+                    break;
+                case BSONObj::opIN: {
+                    if ( op.type() != Array ) {
+                        return false;
+                    }
+                    BSONObjIterator k( op.embeddedObject() );
+                    while( k.more() ) {
+                        if ( !exactBoundsValue( k.next() ) ) {
+                            return false;
+                        }
+                    }
+                    break;
+                }
+                default:
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
     long long runCount( const char *ns, const BSONObj &cmd, string &err ) {
         Client::Context cx(ns);
         NamespaceDetails *d = nsdetails( ns );
@@ -45,9 +115,24 @@ namespace mongo {
         long long limit = cmd["limit"].numberLong();
         bool simpleEqualityMatch;
         shared_ptr<Cursor> cursor = NamespaceDetailsTransient::getCursor( ns, query, BSONObj(), false, &simpleEqualityMatch );
+
         ClientCursor::CleanupPointer ccPointer;
         ElapsedTracker timeToStartYielding( 256, 20 );
         try {
+            // When the index bounds express the query exactly, count the keys within them bucket
+            // by bucket instead of iterating and matching each one.
+            BtreeCursor *btreeCursor = dynamic_cast<BtreeCursor*>( cursor.get() );
+            if ( btreeCursor && !btreeCursor->matcher()->needRecord() && exactBoundsQuery( query ) ) {
+                ccPointer.reset( new ClientCursor( QueryOption_NoCursorTimeout, cursor, ns ) );
+                long long n = btreeCursor->countExactBounds( ccPointer.operator->() );
+                if ( n >= 0 ) {
+                    // if the collection went away while yielding, as in the loop below, the
+                    // keys counted until then are the answer
+                    ccPointer.reset();
+                    return applySkipLimit( n, cmd );
+                }
+            }
+
             while( cursor->ok() ) {
                 if ( !ccPointer ) {
                     if ( timeToStartYielding.intervalHasElapsed() ) {
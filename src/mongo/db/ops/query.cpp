@@ -350,6 +350,17 @@ namespace mongo {
             if ( qp().scanAndOrderRequired() ) {
                 _inMemSort = true;
                 _so.reset( new ScanAndOrder( _pq.getSkip() , _pq.getNumToReturn() , _pq.getOrder(), qp().multikeyFrs() ) );
+
+                // the in memory sort can work on hydrated keys if every sort field is projected
+                if ( _keyFieldsOnly && ! _pq.returnKey() ) {
+                    bool sortCovered = true;
+                    BSONObjIterator i( _pq.getOrder() );
+                    while ( sortCovered && i.more() ) {
+                        sortCovered = _keyFieldsOnly->includes( i.next().fieldName() );
+                    }
+                    if ( ! sortCovered )
+                        _keyFieldsOnly.reset();
+                }
             }
 
             if ( _pq.isExplain() ) {
@@ -444,7 +455,9 @@ namespace mongo {
                     _nscannedObjects++;
             }
             else {
-                _nscannedObjects++;
+                // the record is only read below if the key alone can't produce the result
+                if ( _details._loadedObject || ! indexOnly() )
+                    _nscannedObjects++;
                 DiskLoc cl = _c->currLoc();
                 if ( _chunkManager && ! _chunkManager->belongsToMe( cl.obj() ) ) { // TODO: should make this covered at some point
                     _nChunkSkips++;
@@ -458,7 +471,12 @@ namespace mongo {
 
                     if ( _inMemSort ) {
                         // note: no cursors for non-indexed, ordered results.  results must be fairly small.
-                        _so->add( _pq.returnKey() ? _c->currKey() : _c->current(), _pq.showDiskLoc() ? &cl : 0 );
+                        if ( _pq.returnKey() )
+                            _so->add( _c->currKey(), _pq.showDiskLoc() ? &cl : 0 );
+                        else if ( _keyFieldsOnly )
+                            _so->add( _keyFieldsOnly->hydrate( _c->currKey() ), _pq.showDiskLoc() ? &cl : 0 );
+                        else
+                            _so->add( _c->current(), _pq.showDiskLoc() ? &cl : 0 );
                     }
                     else if ( _ntoskip > 0 ) {
                         _ntoskip--;
@@ -546,7 +564,7 @@ namespace mongo {
             if ( _pq.isExplain() ) {
                 _eb.noteScan( _c.get(), _nscanned, _nscannedObjects, _n, scanAndOrderRequired(),
                               _curop.elapsedMillis(), useHints && !_pq.getHint().eoo(), _nYields ,
-                              _nChunkSkips, _keyFieldsOnly.get() > 0 );
+                              _nChunkSkips, indexOnly() && !matcher( _c )->needRecord() );
             }
             else {
                 if ( _buf.len() ) {
@@ -590,6 +608,8 @@ namespace mongo {
         }
 
         bool scanAndOrderRequired() const { return _inMemSort; }
+        /** true if matching documents are returned from the index key without reading the record */
+        bool indexOnly() const { return _keyFieldsOnly && ! _chunkManager; }
         shared_ptr<Cursor> cursor() { return _c; }
         int n() const { return _oldN + _n; }
         long long totalNscanned() const { return _nscanned + _oldNscanned; }
@@ -667,7 +687,8 @@ namespace mongo {
         if ( pq.couldBeCommand() ) {
             BufBuilder bb;
             bb.skip(sizeof(QueryResult));
-            BSONObjBuilder cmdResBuf;
+            // the result is copied into bb, so it is built in the op's arena
+            BSONObjBuilder cmdResBuf( cc().opArena() );
             if ( runCommands(ns, jsobj, curop, bb, cmdResBuf, false, queryOptions) ) {
                 curop.debug().iscommand = true;
                 curop.debug().query = jsobj;
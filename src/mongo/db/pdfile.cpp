@@ -31,6 +31,7 @@ _ disallow system* manipulations from the database.
 #include "../util/file_allocator.h"
 #include "../util/processinfo.h"
 #include "../util/file.h"
+#include "../util/concurrency/thread_pool.h"
 #include "btree.h"
 #include "btreebuilder.h"
 #include <algorithm>
@@ -1358,18 +1359,126 @@ namespace mongo {
 
     SortPhaseOne *precalced = 0;
 
+    /** a run of records from the phase one scan along with room for their keys */
+    struct PhaseOneBatch {
+        PhaseOneBatch(const IndexSpec *s, int n) : specs(s), nidx(n) { }
+        const IndexSpec *specs;
+        int nidx;
+        vector<BSONObj> objs;
+        vector<DiskLoc> locs;
+        vector<BSONObjSet> keys; // keys[i*nidx+j] are the keys of objs[i] for specs[j]
+        vector<ExceptionInfo> errs; // one per slice
+    };
+
+    /** generates keys for objs[from,to) of a batch.  runs on a pool thread, so no Client and no throwing */
+    static void phaseOneKeys(PhaseOneBatch *b, unsigned from, unsigned to, unsigned slice) {
+        try {
+            for( int j = 0; j < b->nidx; j++ ) {
+                IndexSpec spec( b->specs[j] ); // private copy, the spec's size tracker isn't thread safe
+                for( unsigned i = from; i < to; i++ )
+                    spec.getKeys( b->objs[i], b->keys[i * b->nidx + j] );
+            }
+        }
+        catch( DBException& e ) {
+            b->errs[slice] = e.getInfo();
+        }
+        catch( std::exception& e ) {
+            b->errs[slice] = ExceptionInfo( e.what(), 0 );
+        }
+    }
+
+    /** below this many records phase one generates keys on the calling thread */
+    static const long long PhaseOneParallelMin = 10000;
+
+    void sortPhaseOneScan(const char *ns, NamespaceDetails *d, const IndexSpec *specs, SortPhaseOne *phase1, int nidx, ProgressMeterHolder& pm) {
+        shared_ptr<Cursor> c = theDataFileMgr.findAll(ns);
+
+        int nthreads = BSONObjExternalSorter::parallelism();
+        for( int j = 0; j < nidx; j++ ) {
+            if( specs[j].getType() ) // plugin key generation (eg geo) isn't known to be thread safe
+                nthreads = 1;
+        }
+
+        if( nthreads < 2 || d->stats.nrecords < PhaseOneParallelMin ) {
+            while ( c->ok() ) {
+                BSONObj o = c->current();
+                DiskLoc loc = c->currLoc();
+                for( int j = 0; j < nidx; j++ )
+                    phase1[j].addKeys(specs[j], o, loc);
+                c->advance();
+                pm.hit();
+                if ( logLevel > 1 && phase1[0].n % 10000 == 0 ) {
+                    printMemInfo( "\t iterating objects" );
+                }
+            }
+            return;
+        }
+
+        // we hold the write lock throughout, so the records stay put while the pool reads them.
+        // keys go to the sorters in record order, as they would single threaded.
+        const unsigned sliceSize = 256;
+        const unsigned batchSize = sliceSize * nthreads * 4;
+        ThreadPool tp( nthreads );
+        PhaseOneBatch b( specs, nidx );
+        while( c->ok() ) {
+            b.objs.clear();
+            b.locs.clear();
+            while( c->ok() && b.objs.size() < batchSize ) {
+                b.objs.push_back( c->current() );
+                b.locs.push_back( c->currLoc() );
+                c->advance();
+            }
+
+            b.keys.clear();
+            b.keys.resize( b.objs.size() * nidx );
+            unsigned nslices = ( b.objs.size() + sliceSize - 1 ) / sliceSize;
+            b.errs.assign( nslices, ExceptionInfo() );
+            for( unsigned k = 0; k < nslices; k++ ) {
+                unsigned to = min( (unsigned) b.objs.size(), (k + 1) * sliceSize );
+                tp.schedule( phaseOneKeys, &b, k * sliceSize, to, k );
+            }
+            tp.join();
+
+            for( unsigned k = 0; k < nslices; k++ ) {
+                if( !b.errs[k].empty() )
+                    uasserted( b.errs[k].code > 0 ? b.errs[k].code : 16063, b.errs[k].msg );
+            }
+
+            for( unsigned i = 0; i < b.objs.size(); i++ ) {
+                for( int j = 0; j < nidx; j++ )
+                    phase1[j].addKeys( b.keys[i * nidx + j], b.locs[i] );
+                pm.hit();
+            }
+            if ( logLevel > 1 ) {
+                printMemInfo( "\t iterating objects" );
+            }
+            killCurrentOp.checkForInterrupt();
+        }
+    }
+
+    /** @param mayYield give up the lock now and then while adding keys, for background builds */
     template< class V >
     void buildBottomUpPhases2And3(bool dupsAllowed, IndexDetails& idx, BSONObjExternalSorter& sorter, 
         bool dropDups, list<DiskLoc> &dupsToDrop, CurOp * op, SortPhaseOne *phase1, ProgressMeterHolder &pm,
-        Timer& t
+        Timer& t, bool mayYield = false
         )
     {
         BtreeBuilder<V> btBuilder(dupsAllowed, idx);
         BSONObj keyLast;
         auto_ptr<BSONObjExternalSorter::Iterator> i = sorter.iterator();
         assert( pm == op->setMessage( "index: (2/3) btree bottom up" , phase1->nkeys , 10 ) );
+        unsigned long long nadded = 0;
         while( i->more() ) {
             RARELY killCurrentOp.checkForInterrupt();
+            if ( mayYield && ++nadded % 1024 == 0 ) {
+                int micros = ClientCursor::suggestYieldMicros();
+                if ( micros > 0 ) {
+                    ClientCursor::staticYield( micros, idx.parentNS(), 0 );
+                    btBuilder.relocked();
+                    if ( IndexSideTable *side = IndexSideTable::get( idx ) )
+                        side->assertNotFull();
+                }
+            }
             BSONObjExternalSorter::Data d = i->next();
 
             try {
@@ -1433,21 +1542,9 @@ namespace mongo {
         SortPhaseOne *phase1 = precalced;
         if( phase1 == 0 ) {
             phase1 = &_ours;
-            SortPhaseOne& p1 = *phase1;
-            shared_ptr<Cursor> c = theDataFileMgr.findAll(ns);
-            p1.sorter.reset( new BSONObjExternalSorter(idx.idxInterface(), order) );
-            p1.sorter->hintNumObjects( d->stats.nrecords );
-            const IndexSpec& spec = idx.getSpec();
-            while ( c->ok() ) {
-                BSONObj o = c->current();
-                DiskLoc loc = c->currLoc();
-                p1.addKeys(spec, o, loc);
-                c->advance();
-                pm.hit();
-                if ( logLevel > 1 && p1.n % 10000 == 0 ) {
-                    printMemInfo( "\t iterating objects" );
-                }
-            };
+            phase1->sorter.reset( new BSONObjExternalSorter(idx.idxInterface(), order) );
+            phase1->sorter->hintNumObjects( d->stats.nrecords );
+            sortPhaseOneScan( ns, d, &idx.getSpec(), phase1, 1, pm );
         }
         pm.finished();
 
@@ -1469,6 +1566,8 @@ namespace mongo {
             buildBottomUpPhases2And3<V0>(dupsAllowed, idx, sorter, dropDups, dupsToDrop, op, phase1, pm, t);
         else if( idx.version() == 1 ) 
             buildBottomUpPhases2And3<V1>(dupsAllowed, idx, sorter, dropDups, dupsToDrop, op, phase1, pm, t);
+        else if( idx.version() == 2 ) 
+            buildBottomUpPhases2And3<V2>(dupsAllowed, idx, sorter, dropDups, dupsToDrop, op, phase1, pm, t);
         else
             assert(false);
 
@@ -1556,6 +1655,78 @@ namespace mongo {
             return n;
         }
 
+        /**
+         * Keys for the existing records are generated while yielding, as in addExistingToIndex,
+         * but go to an external sorter rather than the live btree.  The btree is then built bottom
+         * up as in a foreground build and the writes other operations made to the index meanwhile,
+         * held in a side table, are replayed on top of it.  The final sort runs without the lock
+         * and the bottom level of the btree is built yielding, so only the upper levels and the
+         * replay hold the lock throughout.  Only for indexes allowing dups: a unique build must
+         * see concurrent inserts to reject them.
+         */
+        unsigned long long bulkLoadExisting(const char *ns, NamespaceDetails *d, IndexDetails& idx, int idxNo) {
+            CurOp *op = cc().curop();
+            Timer t;
+            getDur().writingDiskLoc(idx.head).Null(); // until the bulk load only the side table sees writes
+            IndexSideTable side(idx);
+
+            SortPhaseOne phase1;
+            phase1.sorter.reset( new BSONObjExternalSorter(idx.idxInterface(), idx.keyPattern()) );
+            phase1.sorter->hintNumObjects( d->stats.nrecords );
+            IndexSpec spec( idx.getSpec() ); // our own copy, as we yield
+
+            ProgressMeterHolder pm( op->setMessage( "bg index build (1/3) external sort" , d->stats.nrecords ) );
+            auto_ptr<ClientCursor> cc;
+            {
+                shared_ptr<Cursor> c = theDataFileMgr.findAll(ns);
+                cc.reset( new ClientCursor(QueryOption_NoCursorTimeout, c, ns) );
+            }
+            while ( cc->ok() ) {
+                phase1.addKeys(spec, cc->current(), cc->currLoc());
+                cc->advance();
+                pm.hit();
+                if ( cc->yieldSometimes( ClientCursor::WillNeed ) ) {
+                    pm->setTotalWhileRunning( d->stats.nrecords );
+                    side.assertNotFull();
+                }
+                else {
+                    cc.release();
+                    uasserted(12584, "cursor gone during bg index");
+                }
+            }
+            pm.finished();
+
+            if( phase1.multi )
+                d->setIndexIsMultikey(idxNo);
+            op->setMessage( "bg index build: sorting keys" );
+            {
+                // the sort only touches the sorter's own memory and files
+                dbtempreleasecond unlock;
+                phase1.sorter->sort();
+            }
+            killCurrentOp.checkForInterrupt();
+            uassert( 16073, "collection gone during bg index", nsdetails(ns) == d );
+            side.assertNotFull();
+
+            list<DiskLoc> dupsToDrop;
+            if( idx.version() == 0 )
+                buildBottomUpPhases2And3<V0>(true, idx, *phase1.sorter, false, dupsToDrop, op, &phase1, pm, t, true);
+            else if( idx.version() == 1 ) 
+                buildBottomUpPhases2And3<V1>(true, idx, *phase1.sorter, false, dupsToDrop, op, &phase1, pm, t, true);
+            else if( idx.version() == 2 ) 
+                buildBottomUpPhases2And3<V2>(true, idx, *phase1.sorter, false, dupsToDrop, op, &phase1, pm, t, true);
+            else
+                assert(false);
+
+            // from here on we keep the lock: no other writes to the index until the side table is replayed
+
+            op->setMessage( "bg index build: applying concurrent writes" );
+            unsigned long long replayed = side.replay();
+            log(t.seconds() > 5 ? 0 : 1) << "\t bg index build sorted " << phase1.nkeys << " keys, replayed "
+                                          << replayed << " concurrent writes in " << t.seconds() << " secs" << endl;
+            return phase1.n;
+        }
+
         /* we do set a flag in the namespace for quick checking, but this is our authoritative info -
            that way on a crash/restart, we don't think we are still building one. */
         set<NamespaceDetails*> bgJobsInProgress;
@@ -1579,8 +1750,13 @@ namespace mongo {
             prep(ns.c_str(), d);
             assert( idxNo == d->nIndexes );
             try {
-                idx.head.writing() = idx.idxInterface().addBucket(idx);
-                n = addExistingToIndex(ns.c_str(), d, idx, idxNo);
+                if( idx.unique() ) {
+                    idx.head.writing() = idx.idxInterface().addBucket(idx);
+                    n = addExistingToIndex(ns.c_str(), d, idx, idxNo);
+                }
+                else {
+                    n = bulkLoadExisting(ns.c_str(), d, idx, idxNo);
+                }
             }
             catch(...) {
                 if( cc().database() && nsdetails(ns.c_str()) == d ) {
@@ -1646,6 +1822,56 @@ namespace mongo {
         tlog() << "build index done " << n << " records " << t.millis() / 1000.0 << " secs" << endl;
     }
 
+    void buildIndexes(const char *ns, const vector<BSONObj>& infos) {
+        string si = nsToDatabase(ns) + ".system.indexes";
+        NamespaceDetails *d = nsdetails(ns);
+        int nidx = infos.size();
+
+        // background builds don't use phase one, and dropDups deletes records the other
+        // indexes' presorted keys still point at
+        bool shareScan = d != 0 && nidx > 1;
+        for( int i = 0; i < nidx; i++ ) {
+            if( infos[i]["background"].trueValue() || infos[i]["dropDups"].trueValue() )
+                shareScan = false;
+        }
+        if( !shareScan ) {
+            for( int i = 0; i < nidx; i++ ) {
+                BSONObj o = infos[i];
+                theDataFileMgr.insertWithObjMod( si.c_str(), o, true );
+            }
+            return;
+        }
+
+        scoped_array<IndexSpec> specs( new IndexSpec[nidx] );
+        scoped_array<SortPhaseOne> phase1( new SortPhaseOne[nidx] );
+        for( int i = 0; i < nidx; i++ ) {
+            specs[i].reset( infos[i] );
+            BSONElement v = infos[i]["v"];
+            IndexInterface& ii = *IndexDetails::iis[ v.eoo() ? DefaultIndexVersionNumber : v.numberInt() ];
+            phase1[i].sorter.reset( new BSONObjExternalSorter( ii, specs[i].keyPattern ) );
+            phase1[i].sorter->hintNumObjects( d->stats.nrecords );
+        }
+        {
+            ProgressMeterHolder pm( cc().curop()->setMessage( "index: (1/3) external sort, all indexes" , d->stats.nrecords , 10 ) );
+            sortPhaseOneScan( ns, d, specs.get(), phase1.get(), nidx, pm );
+            pm.finished();
+        }
+
+        for( int i = 0; i < nidx; i++ ) {
+            killCurrentOp.checkForInterrupt(false);
+            BSONObj o = infos[i];
+            try {
+                precalced = &phase1[i];
+                theDataFileMgr.insertWithObjMod( si.c_str(), o, true );
+            }
+            catch(...) { 
+                precalced = 0;
+                throw;
+            }
+            precalced = 0;
+        }
+    }
+
     /* add keys to indexes for a new record */
 #if 0
     static void oldIndexRecord__notused(NamespaceDetails *d, BSONObj obj, DiskLoc loc) {
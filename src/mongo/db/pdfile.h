@@ -550,6 +550,12 @@ namespace mongo {
 
     bool dropIndexes( NamespaceDetails *d, const char *ns, const char *name, string &errmsg, BSONObjBuilder &anObjBuilder, bool maydeleteIdIndex );
 
+    /**
+     * Creates the indexes described by infos (system.indexes documents) on ns.  Foreground builds
+     * share a single collection scan for their key generation.
+     */
+    void buildIndexes(const char *ns, const vector<BSONObj>& infos);
+
     inline BSONObj::BSONObj(const Record *r) {
         init(r->data);
     }
@@ -56,6 +56,10 @@ namespace mongo {
         }
     }
 
+    void DocMemMonitor::removeFromTotal(size_t amount) {
+        totalUsed -= min(amount, totalUsed);
+    }
+
     void DocMemMonitor::init(StringWriter *pW,
                              size_t warnLimit, size_t errorLimit) {
         this->pWriter = pW;
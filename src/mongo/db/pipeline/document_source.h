@@ -31,7 +31,9 @@ namespace mongo {
     class Accumulator;
     class Cursor;
     class DependencyTracker;
+    class DocMemMonitor;
     class Document;
+    class DocumentSourceSort;
     class Expression;
     class ExpressionContext;
     class ExpressionFieldPath;
@@ -223,6 +225,17 @@ namespace mongo {
         static intrusive_ptr<DocumentSourceCommandFutures> create(
             string &errmsg, FuturesList *pList);
 
+        /**
+          Merge the shards' results, each already sorted by pSort's key,
+          instead of returning them one shard after another.
+
+          Must be called before the first document is requested.
+
+          @param pSort the sort whose key orders the results; must outlive
+            this source
+         */
+        void mergeSorted(DocumentSourceSort *pSort);
+
     protected:
         // virtuals from DocumentSource
         virtual void sourceToBson(BSONObjBuilder *pBuilder) const;
@@ -239,12 +252,31 @@ namespace mongo {
          */
         void getNextDocument();
 
+        /*
+          The mergeSorted() counterpart of getNextDocument():  waits for all
+          the shards, then picks the least of their current documents each
+          time.
+         */
+        void getNextMerged();
+
+        /*
+          Wait for a command result, and return its "result" array as a
+          source, or NULL if the command failed.
+         */
+        intrusive_ptr<DocumentSourceBsonArray> joinResult(
+            const shared_ptr<Future::CommandResult> &pResult);
+
         bool newSource; // set to true for the first item of a new source
         intrusive_ptr<DocumentSourceBsonArray> pBsonSource;
         intrusive_ptr<Document> pCurrent;
         FuturesList::iterator iterator;
         FuturesList::iterator listEnd;
         string &errmsg;
+
+        /* for mergeSorted() */
+        DocumentSourceSort *pMergeSort;
+        vector<intrusive_ptr<DocumentSourceBsonArray> > vpMerge;
+        size_t mergeFrom; // the source pCurrent came from
     };
 
 
@@ -700,9 +732,17 @@ namespace mongo {
         /*
           TODO
           Adjacent sorts should reduce to the last sort.
-        virtual bool coalesce(const intrusive_ptr<DocumentSource> &pNextSource);
         */
 
+        /*
+          A following $limit is absorbed, so that only that many documents
+          need to be kept while sorting.
+         */
+        virtual bool coalesce(const intrusive_ptr<DocumentSource> &pNextSource);
+
+        /* a sort with a limit is written as a $sort followed by a $limit */
+        virtual void addToBsonArray(BSONArrayBuilder *pBuilder) const;
+
         /**
           Create a new sorting DocumentSource.
           
@@ -732,6 +772,38 @@ namespace mongo {
          */
         void sortKeyToBson(BSONObjBuilder *pBuilder, bool usePrefix) const;
 
+        /**
+          @returns the number of documents to keep, or 0 if there is no limit
+         */
+        long long getLimit() const { return limit; }
+
+        /**
+          Create a $limit with this sort's limit, for use where the sort
+          itself is done some other way.
+         */
+        intrusive_ptr<DocumentSource> createLimit() const;
+
+        /**
+          Create the sort that merges this sort's output from several
+          shards.
+
+          The merger has the same key and limit.  If its source is a
+          DocumentSourceCommandFutures, it merges the shards' sorted
+          results as they stream in instead of sorting them again.
+         */
+        intrusive_ptr<DocumentSourceSort> createMerger() const;
+
+        /*
+          Compare two documents according to the specified sort key.
+
+          @param rL reference to the left document
+          @param rR reference to the right document
+          @returns a number less than, equal to, or greater than zero,
+            indicating pL < pR, pL == pR, or pL > pR, respectively
+         */
+        int compare(const intrusive_ptr<Document> &pL,
+                    const intrusive_ptr<Document> &pR);
+
         /**
           Create a sorting DocumentSource from BSON.
 
@@ -766,11 +838,37 @@ namespace mongo {
         void populate();
         bool populated;
         long long count;
+        long long limit;
+
+        /* see createMerger() */
+        bool merger;
+        bool merging; // the source is merging for us
+        long long nMerged;
 
         /* these two parallel each other */
         vector<intrusive_ptr<ExpressionFieldPath> > vSortKey;
         vector<bool> vAscending;
 
+        /*
+          A document's sort key values, parallel to vSortKey.  These are
+          evaluated once, as the document arrives, rather than on every
+          compare.
+         */
+        class KeyValues :
+            public IntrusiveCounterUnsigned {
+        public:
+            vector<intrusive_ptr<const Value> > vValue;
+        };
+
+        intrusive_ptr<const KeyValues> evaluateKey(
+            const intrusive_ptr<Document> &pDocument) const;
+
+        /*
+          Compare two sets of key values as compare() compares the documents
+          they came from.
+         */
+        int compareKeys(const KeyValues &rL, const KeyValues &rR) const;
+
         class Carrier {
         public:
             /*
@@ -780,23 +878,31 @@ namespace mongo {
             DocumentSourceSort *pSort;
 
             intrusive_ptr<Document> pDocument;
+            intrusive_ptr<const KeyValues> pKey;
+
+            /* arrival order, for lessThanInOrder() */
+            size_t order;
 
             Carrier(DocumentSourceSort *pSort,
-                    const intrusive_ptr<Document> &pDocument);
+                    const intrusive_ptr<Document> &pDocument,
+                    size_t order = 0);
 
             static bool lessThan(const Carrier &rL, const Carrier &rR);
+
+            /*
+              As lessThan(), but ties go to the document that arrived
+              first, so that a sort with a limit keeps and orders the same
+              documents as the stable sort of everything would.
+            */
+            static bool lessThanInOrder(const Carrier &rL, const Carrier &rR);
         };
 
         /*
-          Compare two documents according to the specified sort key.
-
-          @param rL reference to the left document
-          @param rR reference to the right document
-          @returns a number less than, equal to, or greater than zero,
-            indicating pL < pR, pL == pR, or pL > pR, respectively
+          Drop all but the least keep documents from *pKept, and take
+          their memory off *pDmm's total.
          */
-        int compare(const intrusive_ptr<Document> &pL,
-                    const intrusive_ptr<Document> &pR);
+        static void trim(vector<Carrier> *pKept, size_t keep,
+                         DocMemMonitor *pDmm);
 
         typedef list<Carrier> ListType;
         ListType documents;
@@ -826,6 +932,9 @@ namespace mongo {
         static intrusive_ptr<DocumentSourceLimit> create(
             const intrusive_ptr<ExpressionContext> &pCtx);
 
+        long long getLimit() const { return limit; }
+        void setLimit(long long newLimit) { limit = newLimit; }
+
         /**
           Create a limiting DocumentSource from BSON.
 
@@ -1019,8 +1128,11 @@ namespace mongo {
 
     inline DocumentSourceSort::Carrier::Carrier(
         DocumentSourceSort *pTheSort,
-        const intrusive_ptr<Document> &pTheDocument):
+        const intrusive_ptr<Document> &pTheDocument,
+        size_t theOrder):
         pSort(pTheSort),
-        pDocument(pTheDocument) {
+        pDocument(pTheDocument),
+        pKey(pTheSort->evaluateKey(pTheDocument)),
+        order(theOrder) {
     }
 }
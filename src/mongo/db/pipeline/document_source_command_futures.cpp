@@ -25,8 +25,12 @@ namespace mongo {
 
     bool DocumentSourceCommandFutures::eof() {
         /* if we haven't even started yet, do so */
-        if (!pCurrent.get())
-            getNextDocument();
+        if (!pCurrent.get()) {
+            if (pMergeSort)
+                getNextMerged();
+            else
+                getNextDocument();
+        }
 
         return (pCurrent.get() == NULL);
     }
@@ -36,7 +40,10 @@ namespace mongo {
             return false;
 
         /* advance */
-        getNextDocument();
+        if (pMergeSort)
+            getNextMerged();
+        else
+            getNextDocument();
 
         return (pCurrent.get() != NULL);
     }
@@ -65,7 +72,10 @@ namespace mongo {
         pCurrent(),
         iterator(pList->begin()),
         listEnd(pList->end()),
-        errmsg(theErrmsg) {
+        errmsg(theErrmsg),
+        pMergeSort(NULL),
+        vpMerge(),
+        mergeFrom(0) {
     }
 
     intrusive_ptr<DocumentSourceCommandFutures>
@@ -76,6 +86,45 @@ namespace mongo {
         return pSource;
     }
 
+    void DocumentSourceCommandFutures::mergeSorted(DocumentSourceSort *pSort) {
+        /* this must be decided before anything has been read */
+        assert(!pCurrent.get() && !pBsonSource.get());
+
+        pMergeSort = pSort;
+    }
+
+    intrusive_ptr<DocumentSourceBsonArray>
+    DocumentSourceCommandFutures::joinResult(
+        const shared_ptr<Future::CommandResult> &pResult) {
+        intrusive_ptr<DocumentSourceBsonArray> pResultSource;
+
+        /* try to wait for it */
+        if (!pResult->join()) {
+            error() << "sharded pipeline failed on shard: " <<
+                pResult->getServer() << " error: " <<
+                pResult->result() << endl;
+            errmsg += "-- mongod pipeline failed: ";
+            errmsg += pResult->result().toString();
+            return pResultSource;
+        }
+
+        /* grab the result array out of the shard server's response */
+        BSONObj shardResult(pResult->result());
+        BSONObjIterator objIterator(shardResult);
+        while(objIterator.more()) {
+            BSONElement element(objIterator.next());
+            const char *pFieldName = element.fieldName();
+
+            /* find the result array and quit this loop */
+            if (strcmp(pFieldName, "result") == 0) {
+                pResultSource = DocumentSourceBsonArray::create(&element);
+                break;
+            }
+        }
+
+        return pResultSource;
+    }
+
     void DocumentSourceCommandFutures::getNextDocument() {
         while(true) {
             if (!pBsonSource.get()) {
@@ -89,32 +138,11 @@ namespace mongo {
                 shared_ptr<Future::CommandResult> pResult(*iterator);
                 ++iterator;
 
-                /* try to wait for it */
-                if (!pResult->join()) {
-                    error() << "sharded pipeline failed on shard: " <<
-                        pResult->getServer() << " error: " <<
-                        pResult->result() << endl;
-                    errmsg += "-- mongod pipeline failed: ";
-                    errmsg += pResult->result().toString();
-
-                    /* move on to the next command future */
+                /* if it failed, move on to the next command future */
+                pBsonSource = joinResult(pResult);
+                if (!pBsonSource.get())
                     continue;
-                }
-
-                /* grab the result array out of the shard server's response */
-                BSONObj shardResult(pResult->result());
-                BSONObjIterator objIterator(shardResult);
-                while(objIterator.more()) {
-                    BSONElement element(objIterator.next());
-                    const char *pFieldName = element.fieldName();
-
-                    /* find the result array and quit this loop */
-                    if (strcmp(pFieldName, "result") == 0) {
-                        pBsonSource = DocumentSourceBsonArray::create(&element);
-                        newSource = true;
-                        break;
-                    }
-                }
+                newSource = true;
             }
 
             /* if we're done with this shard's results, try the next */
@@ -129,4 +157,44 @@ namespace mongo {
             return;
         }
     }
+
+    void DocumentSourceCommandFutures::getNextMerged() {
+        if (!pCurrent.get()) {
+            /*
+              First time through:  every shard has to answer before we know
+              which document comes first.
+            */
+            for(; iterator != listEnd; ++iterator) {
+                intrusive_ptr<DocumentSourceBsonArray> pResultSource(
+                    joinResult(*iterator));
+                if (pResultSource.get() && !pResultSource->eof())
+                    vpMerge.push_back(pResultSource);
+            }
+        }
+        else {
+            /* move past the document we returned last time */
+            if (!vpMerge[mergeFrom]->advance())
+                vpMerge.erase(vpMerge.begin() + mergeFrom);
+        }
+
+        if (vpMerge.empty()) {
+            pCurrent.reset();
+            return;
+        }
+
+        /*
+          Each shard's results are already in order, so the next document
+          is the least of their current ones.  There are only as many of
+          these as there are shards, so a scan will do.
+         */
+        mergeFrom = 0;
+        pCurrent = vpMerge[0]->getCurrent();
+        for(size_t i = 1, n = vpMerge.size(); i < n; ++i) {
+            intrusive_ptr<Document> pDocument(vpMerge[i]->getCurrent());
+            if (pMergeSort->compare(pDocument, pCurrent) < 0) {
+                pCurrent = pDocument;
+                mergeFrom = i;
+            }
+        }
+    }
 }
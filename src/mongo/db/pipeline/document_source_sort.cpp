@@ -36,6 +36,9 @@ namespace mongo {
         if (!populated)
             populate();
 
+        if (merging)
+            return (pSource->eof() || (limit && (nMerged >= limit)));
+
         return (listIterator == documents.end());
     }
 
@@ -43,6 +46,14 @@ namespace mongo {
         if (!populated)
             populate();
 
+        if (merging) {
+            if (eof())
+                return false;
+
+            ++nMerged;
+            return (pSource->advance() && !eof());
+        }
+
         assert(listIterator != documents.end());
 
         ++listIterator;
@@ -60,9 +71,36 @@ namespace mongo {
         if (!populated)
             populate();
 
+        if (merging)
+            return pSource->getCurrent();
+
         return pCurrent;
     }
 
+    bool DocumentSourceSort::coalesce(
+        const intrusive_ptr<DocumentSource> &pNextSource) {
+        DocumentSourceLimit *pLimit =
+            dynamic_cast<DocumentSourceLimit *>(pNextSource.get());
+
+        /* if it's not a $limit, we can't coalesce */
+        if (!pLimit)
+            return false;
+
+        /* keep the smaller of the limits */
+        long long newLimit = pLimit->getLimit();
+        if (!limit || (newLimit < limit))
+            limit = newLimit;
+
+        return true;
+    }
+
+    void DocumentSourceSort::addToBsonArray(BSONArrayBuilder *pBuilder) const {
+        DocumentSource::addToBsonArray(pBuilder);
+
+        if (limit)
+            createLimit()->addToBsonArray(pBuilder);
+    }
+
     void DocumentSourceSort::sourceToBson(BSONObjBuilder *pBuilder) const {
         BSONObjBuilder insides;
         sortKeyToBson(&insides, false);
@@ -79,9 +117,33 @@ namespace mongo {
     DocumentSourceSort::DocumentSourceSort(
         const intrusive_ptr<ExpressionContext> &pTheCtx):
         populated(false),
+        count(0),
+        limit(0),
+        merger(false),
+        merging(false),
+        nMerged(0),
         pCtx(pTheCtx) {
     }
 
+    intrusive_ptr<DocumentSource> DocumentSourceSort::createLimit() const {
+        assert(limit);
+
+        intrusive_ptr<DocumentSourceLimit> pLimit(
+            DocumentSourceLimit::create(pCtx));
+        pLimit->setLimit(limit);
+        return pLimit;
+    }
+
+    intrusive_ptr<DocumentSourceSort> DocumentSourceSort::createMerger() const {
+        intrusive_ptr<DocumentSourceSort> pMerger(
+            DocumentSourceSort::create(pCtx));
+        pMerger->vSortKey = vSortKey;
+        pMerger->vAscending = vAscending;
+        pMerger->limit = limit;
+        pMerger->merger = true;
+        return pMerger;
+    }
+
     void DocumentSourceSort::addKey(const string &fieldPath, bool ascending) {
         intrusive_ptr<ExpressionFieldPath> pE(
             ExpressionFieldPath::create(fieldPath));
@@ -144,20 +206,63 @@ namespace mongo {
         /* make sure we've got a sort key */
         assert(vSortKey.size());
 
+        /*
+          If we're merging the shards' sorted results, and they arrive
+          through command futures, let those merge them as they stream in.
+         */
+        if (merger) {
+            DocumentSourceCommandFutures *pFutures =
+                dynamic_cast<DocumentSourceCommandFutures *>(pSource.get());
+            if (pFutures) {
+                pFutures->mergeSorted(this);
+                merging = true;
+                populated = true;
+                return;
+            }
+        }
+
         /* track and warn about how much physical memory has been used */
         DocMemMonitor dmm(this);
 
-        /* pull everything from the underlying source */
-        for(bool hasNext = !pSource->eof(); hasNext;
-            hasNext = pSource->advance()) {
-            intrusive_ptr<Document> pDocument(pSource->getCurrent());
-            documents.push_back(Carrier(this, pDocument));
+        if (limit) {
+            /*
+              Only the first limit documents are wanted, so there's no need
+              to hang on to the rest.  Collect documents until there are
+              twice as many as we need, then partition them around the
+              limit'th and drop the tail; this keeps the cost linear in the
+              number of documents seen.  Ties are broken by arrival order,
+              as the list sort below does, so the same documents are kept.
+            */
+            const size_t keep = (size_t)limit;
+            vector<Carrier> kept;
+            size_t nSeen = 0;
+            for(bool hasNext = !pSource->eof(); hasNext;
+                hasNext = pSource->advance()) {
+                intrusive_ptr<Document> pDocument(pSource->getCurrent());
+                kept.push_back(Carrier(this, pDocument, nSeen++));
+                dmm.addToTotal(pDocument->getApproximateSize());
+
+                if (kept.size() >= 2 * keep)
+                    trim(&kept, keep, &dmm);
+            }
 
-            dmm.addToTotal(pDocument->getApproximateSize());
+            sort(kept.begin(), kept.end(), Carrier::lessThanInOrder);
+            trim(&kept, keep, &dmm);
+            documents.assign(kept.begin(), kept.end());
         }
+        else {
+            /* pull everything from the underlying source */
+            for(bool hasNext = !pSource->eof(); hasNext;
+                hasNext = pSource->advance()) {
+                intrusive_ptr<Document> pDocument(pSource->getCurrent());
+                documents.push_back(Carrier(this, pDocument));
+
+                dmm.addToTotal(pDocument->getApproximateSize());
+            }
 
-        /* sort the list */
-        documents.sort(Carrier::lessThan);
+            /* sort the list */
+            documents.sort(Carrier::lessThan);
+        }
 
         /* start the sort iterator */
         listIterator = documents.begin();
@@ -167,6 +272,22 @@ namespace mongo {
         populated = true;
     }
 
+    void DocumentSourceSort::trim(vector<Carrier> *pKept, size_t keep,
+                                  DocMemMonitor *pDmm) {
+        if (pKept->size() <= keep)
+            return;
+
+        /* move the least keep documents to the front, in any order */
+        nth_element(pKept->begin(), pKept->begin() + keep, pKept->end(),
+                    Carrier::lessThanInOrder);
+
+        for(vector<Carrier>::iterator iter(pKept->begin() + keep),
+                listEnd(pKept->end()); iter != listEnd; ++iter)
+            pDmm->removeFromTotal(iter->pDocument->getApproximateSize());
+
+        pKept->erase(pKept->begin() + keep, pKept->end());
+    }
+
     int DocumentSourceSort::compare(
         const intrusive_ptr<Document> &pL, const intrusive_ptr<Document> &pR) {
 
@@ -205,12 +326,52 @@ namespace mongo {
         return 0;
     }
 
+    intrusive_ptr<const DocumentSourceSort::KeyValues>
+    DocumentSourceSort::evaluateKey(
+        const intrusive_ptr<Document> &pDocument) const {
+        intrusive_ptr<KeyValues> pKey(new KeyValues);
+
+        const size_t n = vSortKey.size();
+        pKey->vValue.reserve(n);
+        for(size_t i = 0; i < n; ++i)
+            pKey->vValue.push_back(vSortKey[i]->evaluate(pDocument));
+
+        return pKey;
+    }
+
+    int DocumentSourceSort::compareKeys(
+        const KeyValues &rL, const KeyValues &rR) const {
+        const size_t n = vSortKey.size();
+        for(size_t i = 0; i < n; ++i) {
+            int cmp = Value::compare(rL.vValue[i], rR.vValue[i]);
+            if (cmp) {
+                /* if necessary, adjust the return value by the key ordering */
+                if (!vAscending[i])
+                    cmp = -cmp;
+
+                return cmp;
+            }
+        }
+
+        return 0;
+    }
+
     bool DocumentSourceSort::Carrier::lessThan(
         const Carrier &rL, const Carrier &rR) {
         /* make sure these aren't from different lists */
         assert(rL.pSort == rR.pSort);
 
-        /* compare the documents according to the sort key */
-        return (rL.pSort->compare(rL.pDocument, rR.pDocument) < 0);
+        /* compare the documents' already evaluated sort keys */
+        return (rL.pSort->compareKeys(*rL.pKey, *rR.pKey) < 0);
+    }
+
+    bool DocumentSourceSort::Carrier::lessThanInOrder(
+        const Carrier &rL, const Carrier &rR) {
+        assert(rL.pSort == rR.pSort);
+
+        int cmp = rL.pSort->compareKeys(*rL.pKey, *rR.pKey);
+        if (cmp)
+            return (cmp < 0);
+        return (rL.order < rR.order);
     }
 }
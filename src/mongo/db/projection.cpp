@@ -241,17 +241,20 @@ namespace mongo {
         auto_ptr<KeyOnly> p( new KeyOnly() );
 
         int got = 0;
+        vector<string> paths;
         BSONObjIterator i( keyPattern );
         while ( i.more() ) {
             BSONElement k = i.next();
 
             if ( _source[k.fieldName()].type() ) {
 
-                if ( strchr( k.fieldName() , '.' ) ) {
-                    // TODO we currently don't support dotted fields
-                    //      SERVER-2104
-                    return 0;
+                // dotted paths are rebuilt as nested objects by hydrate(), so no output path
+                // may be a prefix of another, e.g. { a : 1 , "a.b" : 1 }
+                for ( unsigned j=0; j<paths.size(); j++ ) {
+                    if ( _pathsOverlap( paths[j] , k.fieldName() ) )
+                        return 0;
                 }
+                paths.push_back( k.fieldName() );
 
                 if ( ! _includeID && mongoutils::str::equals( k.fieldName() , "_id" ) ) {
                     p->addNo();
@@ -280,11 +283,75 @@ namespace mongo {
         return 0;
     }
 
+    bool Projection::_pathsOverlap( const string& a , const string& b ) {
+        const string& shorter = a.size() < b.size() ? a : b;
+        const string& longer = a.size() < b.size() ? b : a;
+        if ( longer.compare( 0 , shorter.size() , shorter ) != 0 )
+            return false;
+        return longer.size() == shorter.size() || longer[shorter.size()] == '.';
+    }
+
+    bool Projection::KeyOnly::includes( const string& name ) const {
+        for ( unsigned i=0; i<_names.size(); i++ ) {
+            if ( _include[i] && _names[i] == name )
+                return true;
+        }
+        return false;
+    }
+
+    /**
+     * appends fields, whose names are paths relative to the object being built,
+     * nesting the ones that share a leading path component into a single sub object
+     */
+    static void appendNested( BSONObjBuilder& b , const vector< pair<string,BSONElement> >& fields ) {
+        vector<bool> done( fields.size() , false );
+        for ( unsigned i=0; i<fields.size(); i++ ) {
+            if ( done[i] )
+                continue;
+
+            const string& name = fields[i].first;
+            size_t dot = name.find( '.' );
+            if ( dot == string::npos ) {
+                b.appendAs( fields[i].second , name );
+                continue;
+            }
+
+            string head = name.substr( 0 , dot );
+            vector< pair<string,BSONElement> > sub;
+            for ( unsigned j=i; j<fields.size(); j++ ) {
+                const string& other = fields[j].first;
+                if ( ! done[j] && other.size() > dot && other.compare( 0 , dot + 1 , name , 0 , dot + 1 ) == 0 ) {
+                    sub.push_back( make_pair( other.substr( dot + 1 ) , fields[j].second ) );
+                    done[j] = true;
+                }
+            }
+
+            BSONObjBuilder subb( b.subobjStart( head ) );
+            appendNested( subb , sub );
+            subb.done();
+        }
+    }
+
     BSONObj Projection::KeyOnly::hydrate( const BSONObj& key ) const {
         assert( _include.size() == _names.size() );
 
         BSONObjBuilder b( key.objsize() + _stringSize + 16 );
 
+        if ( _hasDotted ) {
+            vector< pair<string,BSONElement> > fields;
+            BSONObjIterator i(key);
+            unsigned n=0;
+            while ( i.more() ) {
+                assert( n < _include.size() );
+                BSONElement e = i.next();
+                if ( _include[n] )
+                    fields.push_back( make_pair( _names[n] , e ) );
+                n++;
+            }
+            appendNested( b , fields );
+            return b.obj();
+        }
+
         BSONObjIterator i(key);
         unsigned n=0;
         while ( i.more() ) {
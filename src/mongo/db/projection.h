@@ -33,10 +33,13 @@ namespace mongo {
         class KeyOnly {
         public:
 
-            KeyOnly() : _stringSize(0) {}
+            KeyOnly() : _stringSize(0) , _hasDotted(false) {}
 
             BSONObj hydrate( const BSONObj& key ) const;
 
+            /** @return true iff name is one of the fields hydrate() will output */
+            bool includes( const string& name ) const;
+
             void addNo() { _add( false , "" ); }
             void addYes( const string& name ) { _add( true , name ); }
 
@@ -46,12 +49,16 @@ namespace mongo {
                 _include.push_back( b );
                 _names.push_back( name );
                 _stringSize += name.size();
+                if ( b && name.find( '.' ) != string::npos )
+                    _hasDotted = true;
             }
 
             vector<bool> _include; // one entry per field in key.  true iff should be in output
             vector<string> _names; // name of field since key doesn't have names
 
             int _stringSize;
+            bool _hasDotted; // if any output field is a dotted path, hydrate() has to nest
+
         };
 
         Projection() :
@@ -109,6 +116,9 @@ namespace mongo {
         void add( const string& field, int skip, int limit );
         void appendArray( BSONObjBuilder& b , const BSONObj& a , bool nested=false) const;
 
+        /** @return true if a and b are the same path or one is a parent path of the other */
+        static bool _pathsOverlap( const string& a , const string& b );
+
         bool _include; // true if default at this level is to include
         bool _special; // true if this level can't be skipped or included without recursing
 
@@ -984,6 +984,118 @@ namespace mongo {
         return b.obj();
     }
 
+    /** @return true if r contains every value, in either traversal direction */
+    static bool universalInDirection( const FieldRange &r ) {
+        if ( r.intervals().size() != 1 )
+            return false;
+        const FieldInterval &fi = r.intervals().front();
+        if ( !fi._lower._inclusive || !fi._upper._inclusive )
+            return false;
+        BSONType l = fi._lower._bound.type();
+        BSONType u = fi._upper._bound.type();
+        return ( l == MinKey && u == MaxKey ) || ( l == MaxKey && u == MinKey );
+    }
+
+    /** @return true if e is the lowest or highest bound generated for values of type t */
+    static bool typeBoundary( const BSONElement &e, BSONType t ) {
+        BSONObjBuilder b;
+        b.appendMinForType( "min", t );
+        b.appendMaxForType( "max", t );
+        BSONObj o = b.obj();
+        return e.woCompare( o["min"], false ) == 0 || e.woCompare( o["max"], false ) == 0;
+    }
+
+    /**
+     * Bounds like the { "" : {} } upper bound of { $gt : "a" } are type boundaries rather than
+     * query values and keys equal to them never match, so they are made exclusive.
+     * @return false if the interval holds values of more than one canonical type.
+     */
+    static bool exactTypedInterval( const FieldInterval &fi, bool &lowerInclusive, bool &upperInclusive ) {
+        const BSONElement &l = fi._lower._bound;
+        const BSONElement &u = fi._upper._bound;
+        lowerInclusive = fi._lower._inclusive;
+        upperInclusive = fi._upper._inclusive;
+        if ( l.type() == MinKey || l.type() == MaxKey || u.type() == MinKey || u.type() == MaxKey ) {
+            return false;
+        }
+        if ( l.canonicalType() == u.canonicalType() ) {
+            return true;
+        }
+        if ( typeBoundary( l, u.type() ) ) {
+            lowerInclusive = false;
+            return true;
+        }
+        if ( typeBoundary( u, l.type() ) ) {
+            upperInclusive = false;
+            return true;
+        }
+        return false;
+    }
+
+    bool FieldRangeVector::exactKeyIntervals( vector<KeyInterval> &intervals ) const {
+        int last = -1;
+        for( int i = 0; i < (int)_ranges.size(); ++i ) {
+            if ( !universalInDirection( _ranges[ i ] ) ) {
+                last = i;
+            }
+        }
+        if ( last < 0 ) {
+            return false;
+        }
+        for( int i = 0; i < last; ++i ) {
+            if ( !_ranges[ i ].inQuery() ) {
+                return false;
+            }
+        }
+        const vector<FieldInterval> &lastIntervals = _ranges[ last ].intervals();
+        vector<bool> lowerInclusive( lastIntervals.size() ), upperInclusive( lastIntervals.size() );
+        for( unsigned j = 0; j < lastIntervals.size(); ++j ) {
+            bool l, u;
+            if ( !exactTypedInterval( lastIntervals[ j ], l, u ) ) {
+                return false;
+            }
+            lowerInclusive[ j ] = l;
+            upperInclusive[ j ] = u;
+        }
+
+        // odometer over the equality values of the leading fields, then each interval of the
+        // last constrained field
+        vector<int> pos( last + 1, 0 );
+        while( 1 ) {
+            const FieldInterval &fi = lastIntervals[ pos[ last ] ];
+            KeyInterval k;
+            k._startInclusive = lowerInclusive[ pos[ last ] ];
+            k._endInclusive = upperInclusive[ pos[ last ] ];
+            BSONObjBuilder start, end;
+            for( int i = 0; i < last; ++i ) {
+                const BSONElement &e = _ranges[ i ].intervals()[ pos[ i ] ]._lower._bound;
+                start.appendAs( e, "" );
+                end.appendAs( e, "" );
+            }
+            start.appendAs( fi._lower._bound, "" );
+            end.appendAs( fi._upper._bound, "" );
+            // pad the unconstrained fields so the keys sort before or after every key sharing
+            // the constrained prefix, as the inclusivity requires
+            for( int i = last + 1; i < (int)_ranges.size(); ++i ) {
+                const FieldInterval &u = _ranges[ i ].intervals().front();
+                start.appendAs( k._startInclusive ? u._lower._bound : u._upper._bound, "" );
+                end.appendAs( k._endInclusive ? u._upper._bound : u._lower._bound, "" );
+            }
+            k._start = start.obj();
+            k._end = end.obj();
+            intervals.push_back( k );
+
+            int i = last;
+            while( i >= 0 && ++pos[ i ] == (int)_ranges[ i ].intervals().size() ) {
+                pos[ i ] = 0;
+                --i;
+            }
+            if ( i < 0 ) {
+                return true;
+            }
+        }
+    }
+
     BSONObj FieldRangeVector::obj() const {
         BSONObjBuilder b;
         BSONObjIterator k( _indexSpec.keyPattern );
@@ -290,6 +290,14 @@ namespace mongo {
     
     class IndexSpec;
 
+    /** A contiguous range of index keys, bounded in index traversal order. */
+    struct KeyInterval {
+        BSONObj _start;
+        bool _startInclusive;
+        BSONObj _end;
+        bool _endInclusive;
+    };
+
     /**
      * An ordered list of fields and their FieldRanges, corresponding to valid
      * index keys for a given index spec.
@@ -328,6 +336,15 @@ namespace mongo {
          * index scan using this FieldRangeVector, BSONObj() if no such key.
          */
         BSONObj firstMatch( const BSONObj &obj ) const;
+
+        /**
+         * Splits the bounds into contiguous key intervals holding exactly the keys whose values
+         * match the field ranges.  This is only possible when every field before the last
+         * constrained one has equality intervals, the fields after it are unconstrained, and no
+         * interval of the last constrained field spans values of more than one canonical type.
+         * @return false if the bounds can't be split this way.
+         */
+        bool exactKeyIntervals( vector<KeyInterval> &intervals ) const;
         
     private:
         int matchingLowElement( const BSONElement &e, int i, bool direction, bool &lowEquality ) const;
@@ -228,7 +228,8 @@ namespace mongo {
         }
         virtual void help( stringstream &help ) const {
             help << "Check if this server is primary for a replica pair/set; also if it is --master or --slave in simple master/slave setups.\n";
-            help << "{ isMaster : 1 }";
+            help << "{ isMaster : 1 }\n";
+            help << "{ isMaster : 1 , compression : [ \"snappy\" ] } also asks that large replies on this connection be compressed";
         }
         virtual LockType locktype() const { return NONE; }
         CmdIsMaster() : Command("isMaster", true, "ismaster") { }
@@ -242,8 +243,27 @@ namespace mongo {
             appendReplicationInfo( result , authed );
 
             result.appendNumber("maxBsonObjectSize", BSONObjMaxUserSize);
+
+            if ( cmdLine.networkCompression && wantsSnappy( cmdObj ) ) {
+                AbstractMessagingPort *p = cc().port();
+                if ( p && p->enableCompression() )
+                    result.append( "compression" , BSON_ARRAY( "snappy" ) );
+            }
             return true;
         }
+    private:
+        static bool wantsSnappy( const BSONObj& cmdObj ) {
+            BSONElement e = cmdObj["compression"];
+            if ( e.type() != Array )
+                return false;
+            BSONObjIterator i( e.embeddedObject() );
+            while ( i.more() ) {
+                BSONElement c = i.next();
+                if ( c.type() == String && str::equals( c.valuestr() , "snappy" ) )
+                    return true;
+            }
+            return false;
+        }
     } cmdismaster;
 
     ReplSource::ReplSource() {
@@ -173,22 +173,27 @@ namespace mongo {
             }
 
             int howMany = 0;
+            StringBuilder json; // reused from document to document
             while ( cursor->more() ) {
                 if ( howMany++ && html == 0 )
                     out << " ,\n";
                 BSONObj obj = cursor->next();
+                json.reset();
                 if( html ) {
                     if( out.tellp() > 4 * 1024 * 1024 ) {
                         out << "Stopping output: more than 4MB returned and in html mode\n";
                         break;
                     }
-                    out << obj.jsonString(Strict, html?1:0) << "\n\n";
+                    obj.jsonString( json, Strict, html?1:0 );
+                    json << "\n\n";
                 }
                 else {
                     if( out.tellp() > 50 * 1024 * 1024 ) // 50MB limit - we are using ram
                         break;
-                    out << "    " << obj.jsonString();
+                    json << "    ";
+                    obj.jsonString( json );
                 }
+                out.write( json.stringData().data(), json.len() );
             }
 
             if( html ) {
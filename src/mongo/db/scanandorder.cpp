@@ -43,15 +43,19 @@ namespace mongo {
         if ( k.isEmpty() ) {
             return;   
         }
+        ScanAndOrderKey key;
+        key.key = k;
+        if ( _encode )
+            KeyMemcmp::encode( k, _ordering, key.bytes );
         if ( (int) _best.size() < _limit ) {
-            _add(k, o, loc);
+            _add(key, o, loc);
             return;
         }
         BestMap::iterator i;
         assert( _best.end() != _best.begin() );
         i = _best.end();
         i--;
-        _addIfBetter(k, o, i, loc);
+        _addIfBetter(key, o, i, loc);
     }
 
 
@@ -71,7 +75,7 @@ namespace mongo {
         nout = nFilled;
     }
 
-    void ScanAndOrder::_add(const BSONObj& k, const BSONObj& o, const DiskLoc* loc) {
+    void ScanAndOrder::_add(ScanAndOrderKey& k, const BSONObj& o, const DiskLoc* loc) {
         BSONObj docToReturn = o;
         if ( loc ) {
             BSONObjBuilder b;
@@ -79,17 +83,19 @@ namespace mongo {
             b.append("$diskLoc", loc->toBSONObj());
             docToReturn = b.obj();
         }
-        _validateAndUpdateApproxSize( k.objsize() + docToReturn.objsize() );
-        _best.insert(make_pair(k.getOwned(),docToReturn.getOwned()));
+        _validateAndUpdateApproxSize( k.key.objsize() + k.bytes.size() + docToReturn.objsize() );
+        k.key = k.key.getOwned();
+        _best.insert(make_pair(k,docToReturn.getOwned()));
     }
     
-    void ScanAndOrder::_addIfBetter(const BSONObj& k, const BSONObj& o, const BestMap::iterator& i,
+    void ScanAndOrder::_addIfBetter(ScanAndOrderKey& k, const BSONObj& o, const BestMap::iterator& i,
                                     const DiskLoc* loc) {
-        const BSONObj& worstBestKey = i->first;
-        int cmp = worstBestKey.woCompare(k, _order._spec.keyPattern);
+        const ScanAndOrderKey& worstBestKey = i->first;
+        int cmp = _best.key_comp().compare(worstBestKey, k);
         if ( cmp > 0 ) {
             // k is better, 'upgrade'
-            _validateAndUpdateApproxSize( -i->first.objsize() + -i->second.objsize() );
+            _validateAndUpdateApproxSize( -i->first.key.objsize() + -(int)i->first.bytes.size() +
+                                          -i->second.objsize() );
             _best.erase(i);
             _add(k, o, loc);
         }
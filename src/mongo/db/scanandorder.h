@@ -23,6 +23,7 @@
 #include "indexkey.h"
 #include "queryutil.h"
 #include "projection.h"
+#include "key.h"
 
 namespace mongo {
 
@@ -72,14 +73,38 @@ namespace mongo {
         }
     }
 
-    typedef multimap<BSONObj,BSONObj,BSONObjCmp> BestMap;
+    /** A sort key and, when it has one, its KeyMemcmp encoding. */
+    struct ScanAndOrderKey {
+        BSONObj key;
+        string bytes; // empty if the key has no exact encoding
+    };
+
+    /** Orders keys as woCompare with the sort pattern does, comparing bytes where both keys have them. */
+    class ScanAndOrderKeyCmp {
+    public:
+        ScanAndOrderKeyCmp( const BSONObj &order ) : _order( order ) {}
+        int compare( const ScanAndOrderKey &l, const ScanAndOrderKey &r ) const {
+            if ( l.bytes.empty() || r.bytes.empty() )
+                return l.key.woCompare( r.key, _order );
+            return l.bytes.compare( r.bytes );
+        }
+        bool operator()( const ScanAndOrderKey &l, const ScanAndOrderKey &r ) const {
+            return compare( l, r ) < 0;
+        }
+    private:
+        BSONObj _order;
+    };
+
+    typedef multimap<ScanAndOrderKey,BSONObj,ScanAndOrderKeyCmp> BestMap;
     class ScanAndOrder {
     public:
         static const unsigned MaxScanAndOrderBytes;
 
         ScanAndOrder(int startFrom, int limit, const BSONObj &order, const FieldRangeSet &frs) :
-            _best( BSONObjCmp( order ) ),
-            _startFrom(startFrom), _order(order, frs) {
+            _best( ScanAndOrderKeyCmp( order ) ),
+            _startFrom(startFrom), _order(order, frs),
+            _encode( order.nFields() <= 32 ),
+            _ordering( Ordering::make( _encode ? order : BSONObj() ) ) {
             _limit = limit > 0 ? limit + _startFrom : 0x7fffffff;
             _approxSize = 0;
         }
@@ -102,9 +127,9 @@ namespace mongo {
 
     private:
 
-        void _add(const BSONObj& k, const BSONObj& o, const DiskLoc* loc);
+        void _add(ScanAndOrderKey& k, const BSONObj& o, const DiskLoc* loc);
 
-        void _addIfBetter(const BSONObj& k, const BSONObj& o, const BestMap::iterator& i,
+        void _addIfBetter(ScanAndOrderKey& k, const BSONObj& o, const BestMap::iterator& i,
                           const DiskLoc* loc);
 
         /**
@@ -117,6 +142,8 @@ namespace mongo {
         int _startFrom;
         int _limit;   // max to send back.
         KeyType _order;
+        bool _encode; // false if the pattern has more fields than an Ordering can hold
+        Ordering _ordering;
         unsigned _approxSize;
 
     };
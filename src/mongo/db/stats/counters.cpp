@@ -19,6 +19,7 @@
 #include "pch.h"
 #include "../jsobj.h"
 #include "counters.h"
+#include "../../util/net/message_port.h"
 
 namespace mongo {
 
@@ -195,6 +196,13 @@ namespace mongo {
         b.appendNumber( "bytesOut" , _bytesOut );
         b.appendNumber( "numRequests" , _requests );
         _lock.unlock();
+
+        long long savedIn , savedOut;
+        MessagingPort::getBytesSaved( savedIn , savedOut );
+        BSONObjBuilder c( b.subobjStart( "compression" ) );
+        c.appendNumber( "bytesSavedIn" , savedIn );
+        c.appendNumber( "bytesSavedOut" , savedOut );
+        c.done();
     }
 
 
@@ -144,6 +144,7 @@ namespace mongo {
     public:
         NetworkCounter() : _bytesIn(0), _bytesOut(0), _requests(0), _overflows(0) {}
         void hit( long long bytesIn , long long bytesOut );
+        /** also reports the bytes message compression kept off the wire, from MessagingPort */
         void append( BSONObjBuilder& b );
     private:
         long long _bytesIn;
@@ -19,20 +19,19 @@
 #include "pch.h"
 #include "dbtests.h"
 
-// TODO SERVER-1822
-//#include "../s/config.h" // for ShardFields
-//#include "../s/balancer_policy.h"
+#include "../s/config.h" // for ShardFields
+#include "../s/balancer_policy.h"
 
 namespace BalancerPolicyTests {
 
+    typedef mongo::ShardFields sf;  // fields from 'shards' colleciton
+    typedef mongo::LimitsFields lf; // fields from the balancer's limits map
+
 //
 // TODO SERVER-1822
 //
 #if 0
 
-    typedef mongo::ShardFields sf;  // fields from 'shards' colleciton
-    typedef mongo::LimitsFields lf; // fields from the balancer's limits map
-
     class SizeMaxedShardTest {
     public:
         void run() {
@@ -184,6 +183,161 @@ namespace BalancerPolicyTests {
 //
 #endif // #if 0
 
+    class OpsPerSecTest {
+    public:
+        void run() {
+            ASSERT_EQUALS( -1 , BalancerPolicy::opsPerSec( BSONObj() ) );
+            ASSERT_EQUALS( -1 , BalancerPolicy::opsPerSec( BSON( sf::draining(false) ) ) );
+            ASSERT_EQUALS( 0 , BalancerPolicy::opsPerSec( BSON( lf::opsPerSec(0) ) ) );
+            ASSERT_EQUALS( 12.5 , BalancerPolicy::opsPerSec( BSON( lf::opsPerSec(12.5) ) ) );
+
+            ASSERT( BalancerPolicy::isLoadSkewed( 1000 , 10 ) );
+            ASSERT( BalancerPolicy::isLoadSkewed( 200 , 100 ) );
+            ASSERT( ! BalancerPolicy::isLoadSkewed( 199 , 100 ) );
+            ASSERT( ! BalancerPolicy::isLoadSkewed( 60 , 0 ) );
+            ASSERT( ! BalancerPolicy::isLoadSkewed( 10 , 1000 ) );
+        }
+    };
+
+    /**
+     * A cluster in which every chunk of one collection sees a fixed number of operations per
+     * second. Runs balancer rounds against it, applying each suggested migration, until the
+     * policy stops moving chunks.
+     */
+    class LoadSimulation {
+    public:
+        LoadSimulation( int shards ) : _shards( shards ) , _next( 0 ) {}
+
+        /** adds 'n' chunks, with keys following those of the chunks added before, to 'shard' */
+        void addChunks( int shard , int n , double opsPerSec ) {
+            for ( int i = 0; i < n; ++i, ++_next ) {
+                BSONObj chunk = BSON( "min" << BSON( "x" << _next ) << "max" << BSON( "x" << _next + 1 ) );
+                _chunks[ name( shard ) ].push_back( make_pair( chunk , opsPerSec ) );
+            }
+        }
+
+        /** @return the number of chunks moved; fails if the policy hasn't settled after 'maxRounds' */
+        int run( int maxRounds ) {
+            int moved = 0;
+            int movedLastRound = 0;
+            for ( int round = 0; round < maxRounds; ++round ) {
+                BalancerPolicy::ShardToLimitsMap limitsMap;
+                BalancerPolicy::ShardToChunksMap chunkMap;
+                for ( int s = 0; s < _shards; ++s ) {
+                    limitsMap[ name( s ) ] = BSON( sf::maxSize(0LL) << lf::currSize(0LL) <<
+                                                   sf::draining(false) << lf::hasOpsQueued(false) <<
+                                                   lf::opsPerSec( load( s ) ) );
+                    vector<BSONObj>& chunks = chunkMap[ name( s ) ];
+                    const Chunks& mine = _chunks[ name( s ) ];
+                    for ( Chunks::const_iterator i = mine.begin(); i != mine.end(); ++i )
+                        chunks.push_back( i->first );
+                }
+
+                auto_ptr<BalancerPolicy::ChunkInfo> c( BalancerPolicy::balance( "ns" , limitsMap , chunkMap , movedLastRound ) );
+                if ( ! c.get() )
+                    return moved;
+
+                move( c->chunk , c->from , c->to );
+                movedLastRound = 1;
+                ++moved;
+            }
+            ASSERT( false );
+            return moved;
+        }
+
+        int count( int shard ) { return _chunks[ name( shard ) ].size(); }
+
+        double load( int shard ) {
+            double total = 0;
+            const Chunks& chunks = _chunks[ name( shard ) ];
+            for ( Chunks::const_iterator i = chunks.begin(); i != chunks.end(); ++i )
+                total += i->second;
+            return total;
+        }
+
+    private:
+        typedef vector< pair<BSONObj,double> > Chunks;
+
+        static string name( int shard ) {
+            stringstream ss;
+            ss << "shard" << shard;
+            return ss.str();
+        }
+
+        void move( const BSONObj& chunk , const string& from , const string& to ) {
+            Chunks& src = _chunks[ from ];
+            for ( Chunks::iterator i = src.begin(); i != src.end(); ++i ) {
+                if ( i->first.woCompare( chunk ) != 0 )
+                    continue;
+                Chunks& dst = _chunks[ to ];
+                Chunks::iterator pos = dst.begin();
+                while ( pos != dst.end() && pos->first["min"].Obj().woCompare( chunk["min"].Obj() ) < 0 )
+                    ++pos;
+                dst.insert( pos , *i );
+                src.erase( i );
+                return;
+            }
+            ASSERT( false );
+        }
+
+        const int _shards;
+        int _next;
+        map<string,Chunks> _chunks;
+    };
+
+    /** chunk counts and load are even: nothing to do */
+    class LoadEvenTest {
+    public:
+        void run() {
+            LoadSimulation sim( 3 );
+            for ( int s = 0; s < 3; ++s )
+                sim.addChunks( s , 10 , 50 );
+            ASSERT_EQUALS( 0 , sim.run( 10 ) );
+        }
+    };
+
+    /** counts are even but two hot chunks sit on one shard: one of them moves, then all is quiet */
+    class LoadHotChunksTest {
+    public:
+        void run() {
+            LoadSimulation sim( 2 );
+            sim.addChunks( 0 , 18 , 1 );
+            sim.addChunks( 0 , 2 , 1000 );
+            sim.addChunks( 1 , 20 , 1 );
+            ASSERT_EQUALS( 1 , sim.run( 10 ) );
+            ASSERT_EQUALS( 19 , sim.count( 0 ) );
+            ASSERT_EQUALS( 21 , sim.count( 1 ) );
+            ASSERT( ! BalancerPolicy::isLoadSkewed( sim.load( 0 ) , sim.load( 1 ) ) );
+            ASSERT( ! BalancerPolicy::isLoadSkewed( sim.load( 1 ) , sim.load( 0 ) ) );
+        }
+    };
+
+    /** load can't be evened out without unbalancing counts: a single move, then it settles */
+    class LoadBoundedByCountTest {
+    public:
+        void run() {
+            LoadSimulation sim( 2 );
+            sim.addChunks( 0 , 30 , 100 );
+            sim.addChunks( 1 , 30 , 1 );
+            ASSERT_EQUALS( 1 , sim.run( 10 ) );
+            ASSERT_EQUALS( 29 , sim.count( 0 ) );
+            ASSERT_EQUALS( 31 , sim.count( 1 ) );
+        }
+    };
+
+    /** a large count imbalance is fixed even towards the busy shard, and doesn't flap back */
+    class LoadCountFirstTest {
+    public:
+        void run() {
+            LoadSimulation sim( 2 );
+            sim.addChunks( 0 , 10 , 1000 );
+            sim.addChunks( 1 , 30 , 1 );
+            ASSERT_EQUALS( 9 , sim.run( 50 ) );
+            ASSERT_EQUALS( 19 , sim.count( 0 ) );
+            ASSERT_EQUALS( 21 , sim.count( 1 ) );
+        }
+    };
+
     class All : public Suite {
     public:
         All() : Suite( "balancer_policy" ) {
@@ -197,6 +351,11 @@ namespace BalancerPolicyTests {
             // add< BalanceDrainingTest >();
             // add< BalanceEndedDrainingTest >();
             // add< BalanceImpasseTest >();
+            add< OpsPerSecTest >();
+            add< LoadEvenTest >();
+            add< LoadHotChunksTest >();
+            add< LoadBoundedByCountTest >();
+            add< LoadCountFirstTest >();
         }
     } allTests;
 
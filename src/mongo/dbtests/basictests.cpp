@@ -648,6 +648,55 @@ namespace BasicTests {
         }
     } ctest1;
 
+    /** compressing several buffers is compressing them concatenated */
+    struct CompressionTest2 {
+        void run() {
+            string all;
+            for( int i = 0; i < 20000; i++ )
+                all += "abcdefg"[ i % ( 1 + i / 5000 ) ];
+
+            Message::MsgVec pieces;
+            int cuts[] = { 0, 0, 1, 7, 7, 4000, 4001, 16000, (int) all.size() };
+            for( unsigned i = 1; i < sizeof( cuts ) / sizeof( cuts[0] ); i++ )
+                pieces.push_back( make_pair( (char *) all.data() + cuts[i-1], cuts[i] - cuts[i-1] ) );
+
+            boost::scoped_array<char> c( new char[ maxCompressedLength( all.size() ) ] );
+            size_t len;
+            rawCompress( pieces, c.get(), &len );
+            ASSERT( len < all.size() );
+
+            string out;
+            ASSERT( uncompress( c.get(), len, &out ) );
+            ASSERT( out == all );
+        }
+    };
+
+    /** a message that points at its parts, rather than owning them */
+    struct BorrowedMessageTest {
+        void run() {
+            MsgData header;
+            header.setOperation( opReply );
+            char body[] = "0123456789";
+
+            Message::MsgVec buffers;
+            {
+                Message m;
+                m.appendBorrowedData( (char *) &header, MsgDataHeaderSize );
+                m.appendBorrowedData( body, 10 );
+                ASSERT( ! m.doIFreeIt() );
+                ASSERT_EQUALS( MsgDataHeaderSize + 10, m.header()->len );
+                ASSERT_EQUALS( MsgDataHeaderSize + 10, m.size() );
+                m.getBuffers( buffers );
+            }
+            // still ours
+            ASSERT_EQUALS( 2U, buffers.size() );
+            ASSERT( buffers[0].first == (char *) &header );
+            ASSERT( buffers[1].first == body );
+            ASSERT_EQUALS( 10, buffers[1].second );
+            ASSERT_EQUALS( MsgDataHeaderSize + 10, header.len );
+        }
+    };
+
 
     class All : public Suite {
     public:
@@ -688,6 +737,8 @@ namespace BasicTests {
             add< CmdLineParseConfigTest >();
 
             add< CompressionTest1 >();
+            add< CompressionTest2 >();
+            add< BorrowedMessageTest >();
         }
     } myall;
 
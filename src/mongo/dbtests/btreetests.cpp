@@ -57,3 +57,20 @@ namespace BtreeTests1 {
 namespace BtreeTests2 {
  #include "btreetests.inl"
 }
+
+#undef BtreeBucket
+#undef btree
+#undef btreemod
+#undef Continuation
+#define BtreeBucket BtreeBucket<V2>
+#define btree btree<V2>
+#define btreemod btreemod<V2>
+#define Continuation Continuation<V2>
+#undef testName
+#define testName "btree2"
+#undef BTVERSION
+#define BTVERSION 2
+#undef TESTTWOSTEP
+namespace BtreeTests3 {
+ #include "btreetests.inl"
+}
@@ -273,6 +273,43 @@
         }
     };
 
+    /** estimateRank and keyAtRank agree with key order and land near the true ranks */
+    class EstimateRank : public Base {
+    public:
+        void run() {
+            const int n = 2000;
+            for ( int i = 0; i < n; ++i ) {
+                BSONObj k = BSON( "" << ( i * 7919 ) % n );
+                Base::insert( k );
+            }
+            IndexInterface& ii = id().idxInterface();
+            ASSERT_EQUALS( 0, ii.estimateRank( id(), BSON( "" << -1 ), false ) );
+            ASSERT_EQUALS( 0, ii.estimateRank( id(), BSON( "" << 0 ), false ) );
+            ASSERT( ii.estimateRank( id(), BSON( "" << n ), false ) > 0.99 );
+
+            double last = 0;
+            for ( int i = 0; i < n; i += 50 ) {
+                double rank = ii.estimateRank( id(), BSON( "" << i ), false );
+                ASSERT( rank >= last );
+                ASSERT( rank > (double)i / n - 0.25 );
+                ASSERT( rank < (double)i / n + 0.25 );
+                ASSERT( ii.estimateRank( id(), BSON( "" << i ), true ) >= rank );
+                // a key at the estimated rank is at or after the one it was estimated from
+                ASSERT( ii.keyAtRank( id(), rank ).firstElement().number() >= i );
+                last = rank;
+            }
+
+            int lastKey = -1;
+            for ( double rank = 0; rank < 1; rank += 0.01 ) {
+                int key = (int)ii.keyAtRank( id(), rank ).firstElement().number();
+                ASSERT( key >= lastKey );
+                lastKey = key;
+            }
+            ASSERT( ii.keyAtRank( id(), 0.5 ).firstElement().number() > n / 4 );
+            ASSERT( ii.keyAtRank( id(), 0.5 ).firstElement().number() < 3 * n / 4 );
+        }
+    };
+
     class SERVER983 : public Base {
     public:
         void run() {
@@ -1139,6 +1176,33 @@
         };
     };
 
+    /** Merging and balancing count on packedDataSize() bounding the room a packed bucket's keys take. */
+    class PackedDataSizeBound : public Base {
+    public:
+        void run() {
+            string ns = id().indexNamespace();
+            ArtificialTree::setTree( "{$10$40:null,$11$40:null,$12$40:null,$13$40:null}", id() );
+            BSONObj k = BSON( "" << bigNumString( 0x10, 0x40 ) );
+            ASSERT( unindex( k ) );
+            ArtificialTree *t = ArtificialTree::is( dl() );
+            t->forcePack();
+            Tester::checkBound( t, id() );
+            checkValid( 3 );
+        }
+        class Tester : public ArtificialTree {
+        public:
+            static void checkBound( ArtificialTree *a, const IndexDetails &id ) {
+                Tester *t = static_cast< Tester * >( a );
+                ASSERT_EQUALS( 3, t->n );
+                Ordering o = Ordering::make( id.keyPattern() );
+                int zero = 0;
+                t->_packReadyForMod( o, zero );
+                ASSERT( t->flags & Packed );
+                ASSERT( BtreeBucket::bodySize() - t->emptySize <= t->packedDataSize( zero ) );
+            }
+        };
+    };
+
     class BalanceSingleParentKeyPackParent : public Base {
     public:
         void run() {
@@ -1611,6 +1675,34 @@
         }
     };
 
+    class InsertDeleteSharedPrefix : public Base {
+    public:
+        void run() {
+            for ( int i = 0; i < 2000; ++i ) {
+                BSONObj k = key( i );
+                insert( k );
+            }
+            checkValid( 2000 );
+#if BTVERSION == 2
+            // keys differ only in their last few bytes, so v2 buckets hold many more of them
+            ASSERT( nsdetails( id().indexNamespace().c_str() )->stats.nrecords < 20 );
+#endif
+            for ( int i = 0; i < 2000; i += 2 ) {
+                BSONObj k = key( i );
+                ASSERT( unindex( k ) );
+            }
+            checkValid( 1000 );
+            for ( int i = 0; i < 2000; ++i ) {
+                BSONObj k = key( i );
+                ASSERT_EQUALS( i % 2 == 1, present( k, 1 ) );
+            }
+        }
+    private:
+        static BSONObj key( int i ) {
+            return BSON( "" << string( 200, 'x' ) + bigNumString( i, 16 ) );
+        }
+    };
+
     class SignedZeroDuplication : public Base {
     public:
         void run() {
@@ -1709,5 +1801,8 @@
             add< DelInternalSplitPromoteLeft >();
             add< DelInternalSplitPromoteRight >();
             add< SignedZeroDuplication >();
+            add< InsertDeleteSharedPrefix >();
+            add< EstimateRank >();
+            add< PackedDataSizeBound >();
         }
     } myall;
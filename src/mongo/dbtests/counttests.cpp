@@ -125,6 +125,69 @@ namespace CountTests {
         }
     };
     
+    /** Ranges exactly covered by index bounds are counted from btree buckets. */
+    class CountIndexedRange : public Base {
+    public:
+        void run() {
+            for( int i = 0; i < 2000; ++i ) {
+                insert( BSON( "a" << i ) );
+            }
+            string err;
+            ASSERT_EQUALS( 1899, runCount( ns(), fromjson( "{query:{a:{$gt:100}}}" ), err ) );
+            ASSERT_EQUALS( 100, runCount( ns(), fromjson( "{query:{a:{$gte:100,$lt:200}}}" ), err ) );
+            ASSERT_EQUALS( 2, runCount( ns(), fromjson( "{query:{a:{$in:[1,5,5000]}}}" ), err ) );
+            ASSERT_EQUALS( 0, runCount( ns(), fromjson( "{query:{a:{$gt:5,$lt:5}}}" ), err ) );
+            ASSERT_EQUALS( 10, runCount( ns(), fromjson( "{query:{a:{$lt:100}},skip:90}" ), err ) );
+            ASSERT_EQUALS( 5, runCount( ns(), fromjson( "{query:{a:{$lt:100}},limit:5}" ), err ) );
+        }
+    };
+
+    /** Type boundaries in the index bounds don't count keys of other types. */
+    class CountIndexedRangeTypeBoundary : public Base {
+    public:
+        void run() {
+            insert( "{a:'b'}" );
+            insert( "{a:'c'}" );
+            insert( "{a:{}}" );
+            insert( "{a:5}" );
+            insert( "{a:true}" );
+            insert( "{a:new Date(5)}" );
+            string err;
+            ASSERT_EQUALS( 2, runCount( ns(), fromjson( "{query:{a:{$gt:'a'}}}" ), err ) );
+            ASSERT_EQUALS( 1, runCount( ns(), fromjson( "{query:{a:{$lt:new Date(10)}}}" ), err ) );
+            ASSERT_EQUALS( 1, runCount( ns(), fromjson( "{query:{a:{$gte:0}}}" ), err ) );
+        }
+    };
+
+    /** Equality prefixes of a compound index give one key interval per value. */
+    class CountCompoundIndexedRange : public Base {
+    public:
+        void run() {
+            addIndex( fromjson( "{b:1,c:-1}" ) );
+            for( int i = 0; i < 300; ++i ) {
+                insert( BSON( "b" << i % 3 << "c" << i ) );
+            }
+            string err;
+            ASSERT_EQUALS( 50, runCount( ns(), fromjson( "{query:{b:1,c:{$gte:150}}}" ), err ) );
+            ASSERT_EQUALS( 100, runCount( ns(), fromjson( "{query:{b:{$in:[0,2]},c:{$lt:150}}}" ), err ) );
+            ASSERT_EQUALS( 100, runCount( ns(), fromjson( "{query:{b:2}}" ), err ) );
+        }
+    };
+    
+    /** Ranges longer than one count step resume after the last key read. */
+    class CountIndexedRangeInSteps : public Base {
+    public:
+        void run() {
+            for( int i = 0; i < 10000; ++i ) {
+                insert( BSON( "a" << i % 4 ) );
+            }
+            string err;
+            ASSERT_EQUALS( 7500, runCount( ns(), fromjson( "{query:{a:{$gte:1}}}" ), err ) );
+            ASSERT_EQUALS( 2500, runCount( ns(), fromjson( "{query:{a:2}}" ), err ) );
+            ASSERT_EQUALS( 5000, runCount( ns(), fromjson( "{query:{a:{$in:[0,3]}}}" ), err ) );
+        }
+    };
+
     class All : public Suite {
     public:
         All() : Suite( "count" ) {
@@ -136,6 +199,10 @@ namespace CountTests {
             add< CountFields >();
             add< CountQueryFields >();
             add< CountIndexedRegex >();
+            add< CountIndexedRange >();
+            add< CountIndexedRangeTypeBoundary >();
+            add< CountCompoundIndexedRange >();
+            add< CountIndexedRangeInSteps >();
         }
     } myall;
     
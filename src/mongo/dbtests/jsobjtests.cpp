@@ -28,6 +28,7 @@
 #include "../util/mongoutils/checksum.h"
 #include "../db/key.h"
 #include "../db/btree.h"
+#include "../db/fieldoffsets.h"
 
 namespace JsobjTests {
 
@@ -108,6 +109,54 @@ namespace JsobjTests {
         }
     };
 
+    /** builders drawing from an Arena */
+    class ArenaBuilders {
+    public:
+        void run() {
+            Arena arena;
+            BSONObj kept;
+            {
+                BSONObjBuilder b( &arena );
+                for( int i = 0; i < 100; i++ ) // grows past its initial size, in place
+                    b.append( BSONObjBuilder::numStr( i ), i );
+                BSONObj o = b.done();
+                ASSERT_EQUALS( 99, o[ "99" ].numberInt() );
+                kept = b.obj();
+            }
+            ASSERT_EQUALS( 1U, arena.mallocs() ); // the first block
+            ASSERT( arena.allocs() > 1 );
+
+            {
+                BufBuilder b( &arena, 16 );
+                b.appendStr( "foo" );
+                ASSERT_EQUALS( 4, b.len() );
+                ASSERT( strcmp( "foo", b.buf() ) == 0 );
+                ASSERT_THROWS( b.decouple(), MsgAssertionException );
+            }
+            {
+                // too large for the arena
+                BufBuilder b( &arena, Arena::MaxAlloc + 1 );
+                b.skip( Arena::MaxAlloc + 1 );
+                ASSERT_EQUALS( 2U, arena.mallocs() );
+            }
+            {
+                // more than a block's worth
+                vector< shared_ptr< BufBuilder > > v;
+                for( int i = 0; i * Arena::MaxAlloc <= Arena::BlockSize; i++ )
+                    v.push_back( shared_ptr< BufBuilder >( new BufBuilder( &arena, Arena::MaxAlloc ) ) );
+                ASSERT_EQUALS( 3U, arena.mallocs() );
+            }
+
+            arena.reset();
+            {
+                BufBuilder b( &arena );
+                memset( b.skip( 512 ), 0xff, 512 );
+            }
+            ASSERT_EQUALS( 3U, arena.mallocs() ); // the first block was kept
+            ASSERT_EQUALS( 99, kept[ "99" ].numberInt() );
+        }
+    };
+
     class BSONElementBasic {
     public:
         void run() {
@@ -804,6 +853,175 @@ namespace JsobjTests {
                 ASSERT_EQUALS( 3 , o.getFieldDotted( "c.0.a" ).numberInt() );
                 ASSERT_EQUALS( 4 , o.getFieldDotted( "c.1.a" ).numberInt() );
                 keyTest(o);
+
+                // names that are prefixes of one another, or the same length
+                BSONObj p = BSON( "ab" << 1 << "a" << 2 << "abc" << 3 << "" << 4 << "a.b" << 5 << "xy" << BSON( "z" << 6 ) );
+                ASSERT_EQUALS( 1 , p.getField( "ab" ).numberInt() );
+                ASSERT_EQUALS( 2 , p.getField( "a" ).numberInt() );
+                ASSERT_EQUALS( 3 , p.getField( "abc" ).numberInt() );
+                ASSERT_EQUALS( 4 , p.getField( "" ).numberInt() );
+                ASSERT( p.getField( "abcd" ).eoo() );
+                ASSERT( p.getField( "xz" ).eoo() );
+                ASSERT_EQUALS( 5 , p.getFieldDotted( "a.b" ).numberInt() );
+                ASSERT_EQUALS( 6 , p.getFieldDotted( "xy.z" ).numberInt() );
+                ASSERT( p.getFieldDotted( "x.z" ).eoo() );
+                ASSERT( p.getFieldDotted( "ab.z" ).eoo() );
+
+                ASSERT_EQUALS( 3 , mongo::strnlen( "abc" , 4 ) );
+                ASSERT_EQUALS( -1 , mongo::strnlen( "abc" , 3 ) );
+                ASSERT_EQUALS( -1 , mongo::strnlen( "abc" , 0 ) );
+            }
+        };
+
+        /** FieldOffsets finds the same elements as BSONObj's own lookups */
+        class FieldOffsetsLookup {
+        public:
+            void run() {
+                BSONObjBuilder b;
+                b.append( "a" , 1 );
+                b.append( "b" , BSON( "c" << 2 << "d" << BSON_ARRAY( 3 << 4 ) ) );
+                b.append( "e" , BSON_ARRAY( BSON( "f" << 5 ) << BSON( "f" << 6 ) ) );
+                b.append( "a.b" , 7 );
+                b.append( "" , 8 );
+                for( int i = 0; i < 40; ++i ) // more than the table records
+                    b.append( BSONObjBuilder::numStr( i ) , i );
+                b.append( "last" , 9 );
+                BSONObj o = b.obj();
+
+                FieldOffsets fields( o );
+                const char *names[] = { "a", "b", "b.c", "b.d", "b.d.1", "e.1.f", "a.b", "", "0", "39",
+                                        "last", "missing", "a.c", "b.x", "la", "lastt", 0 };
+                for( int i = 0; names[ i ]; ++i ) {
+                    ASSERT( same( o.getField( names[ i ] ) , fields.getField( names[ i ] ) ) );
+                    ASSERT( same( o.getFieldDotted( names[ i ] ) , fields.getFieldDotted( names[ i ] ) ) );
+                    const char *n1 = names[ i ];
+                    const char *n2 = names[ i ];
+                    ASSERT( same( o.getFieldDottedOrArray( n1 ) , fields.getFieldDottedOrArray( n2 ) ) );
+                    ASSERT_EQUALS( string( n1 ) , string( n2 ) );
+                }
+                ASSERT_EQUALS( 9 , fields.getField( "last" ).numberInt() );
+                ASSERT( fields.getField( "missing" ).eoo() );
+
+                // a lookup past the recorded fields first, then ones before it
+                FieldOffsets lastFirst( o );
+                ASSERT( same( o.getField( "last" ) , lastFirst.getField( "last" ) ) );
+                ASSERT( same( o.getField( "39" ) , lastFirst.getField( "39" ) ) );
+                ASSERT( same( o.getField( "a" ) , lastFirst.getField( "a" ) ) );
+
+                BSONObj empty;
+                FieldOffsets none( empty );
+                ASSERT( none.getField( "a" ).eoo() );
+            }
+        private:
+            static bool same( const BSONElement& a , const BSONElement& b ) {
+                return a.eoo() ? b.eoo() : a.rawdata() == b.rawdata();
+            }
+        };
+
+        /** KeyMemcmp encodings order as woCompare orders their keys, in either direction */
+        class KeyMemcmpOrder {
+        public:
+            void run() {
+                OID oid1 = OID( "000000000000000000000001" );
+                OID oid2 = OID( "0000000000000000000000ff" );
+                BSONObjBuilder b;
+                b.appendMinKey( "" );
+                b.appendMaxKey( "" );
+                b.appendNull( "" );
+                b.appendUndefined( "" );
+                b.append( "" , numeric_limits< double >::quiet_NaN() );
+                b.append( "" , -numeric_limits< double >::infinity() );
+                b.append( "" , -1e300 );
+                b.append( "" , -5 );
+                b.append( "" , -0.0 );
+                b.append( "" , 0 );
+                b.append( "" , 3 );
+                b.append( "" , 3LL );
+                b.append( "" , 3.5 );
+                b.append( "" , 1LL << 53 );
+                b.append( "" , numeric_limits< double >::infinity() );
+                b.append( "" , "" );
+                b.append( "" , "a" );
+                b.append( "" , string( "a\0b" , 3 ) );
+                b.append( "" , "ab" );
+                b.append( "" , "b" );
+                b.appendSymbol( "" , "ab" );
+                b.append( "" , BSONObj() );
+                b.append( "" , BSON( "a" << 1 ) );
+                b.append( "" , BSON( "a" << 1 << "b" << 2 ) );
+                b.append( "" , BSON( "a" << "x" ) );
+                b.append( "" , BSON( "b" << 0 ) );
+                b.appendArray( "" , BSONObj() );
+                b.appendArray( "" , BSON_ARRAY( 1 ) );
+                b.appendArray( "" , BSON_ARRAY( 1 << 2 ) );
+                b.appendArray( "" , BSON_ARRAY( BSON( "a" << 1 ) ) );
+                b.appendBinData( "" , 2 , BinDataGeneral , "ab" );
+                b.appendBinData( "" , 2 , Function , "ab" );
+                b.appendBinData( "" , 3 , BinDataGeneral , "aaa" );
+                b.appendOID( "" , &oid1 );
+                b.appendOID( "" , &oid2 );
+                b.appendBool( "" , false );
+                b.appendBool( "" , true );
+                b.appendDate( "" , 0 );
+                b.appendDate( "" , 1000 );
+                b.appendRegex( "" , "a" , "i" );
+                b.appendRegex( "" , "a" );
+                b.appendRegex( "" , "b" );
+                b.appendDBRef( "" , "ns" , oid1 );
+                b.appendDBRef( "" , "ns2" , oid1 );
+                b.appendCode( "" , "f()" );
+                b.appendCodeWScope( "" , "f()" , BSON( "x" << 1 ) );
+                b.appendCodeWScope( "" , "g()" , BSONObj() );
+                BSONObj values = b.obj();
+
+                vector< BSONObj > keys;
+                for( BSONObjIterator i( values ); i.more(); ) {
+                    BSONElement e = i.next();
+                    keys.push_back( e.wrap( "" ) );
+                    for( BSONObjIterator j( values ); j.more(); ) {
+                        BSONObjBuilder k;
+                        k.append( e );
+                        k.append( j.next() );
+                        keys.push_back( k.obj() );
+                    }
+                }
+
+                BSONObj patterns[] = { BSON( "a" << 1 << "b" << 1 ), BSON( "a" << -1 << "b" << 1 ),
+                                       BSON( "a" << 1 << "b" << -1 ), BSON( "a" << -1 << "b" << -1 ) };
+                for( int p = 0; p < 4; ++p ) {
+                    Ordering o = Ordering::make( patterns[ p ] );
+                    vector< string > encoded( keys.size() );
+                    for( unsigned i = 0; i < keys.size(); ++i )
+                        ASSERT( KeyMemcmp::encode( keys[ i ] , o , encoded[ i ] ) );
+                    for( unsigned i = 0; i < keys.size(); ++i ) {
+                        for( unsigned j = 0; j < keys.size(); ++j ) {
+                            int expected = sign( keys[ i ].woCompare( keys[ j ] , o , false ) );
+                            int actual = sign( encoded[ i ].compare( encoded[ j ] ) );
+                            ASSERT_EQUALS( expected , actual );
+                        }
+                    }
+                }
+
+                // timestamps are left out above, as woCompare asserts against a Date
+                string t1, t2;
+                ASSERT( KeyMemcmp::encode( BSONObjBuilder().appendTimestamp( "" , 500 ).obj() ,
+                                           Ordering::make( BSONObj() ) , t1 ) );
+                ASSERT( KeyMemcmp::encode( BSONObjBuilder().appendTimestamp( "" , 1ULL << 40 ).obj() ,
+                                           Ordering::make( BSONObj() ) , t2 ) );
+                ASSERT( t1 < t2 );
+
+                // no exact encoding; the output is left as it was
+                Ordering o = Ordering::make( BSONObj() );
+                string out = "x";
+                ASSERT( !KeyMemcmp::encode( BSON( "" << 1 << "" << ( 1LL << 53 ) + 1 ) , o , out ) );
+                ASSERT( !KeyMemcmp::encode( BSONObjBuilder().appendDate( "" , -1 ).obj() , o , out ) );
+                ASSERT( !KeyMemcmp::encode( BSON( "" << BSON( "a" << BSONObjBuilder().appendTimestamp( "" , 1ULL << 63 ).obj() ) ) ,
+                                            o , out ) );
+                ASSERT_EQUALS( "x" , out );
+            }
+        private:
+            static int sign( int x ) {
+                return x < 0 ? -1 : ( x > 0 ? 1 : 0 );
             }
         };
 
@@ -1632,6 +1850,37 @@ namespace JsobjTests {
             }
         };
 
+        /** one in memory run big enough to be sorted in parallel slices and merged */
+        class BigInMem {
+        public:
+            void run() {
+                const int total = 200000;
+                BSONObjExternalSorter sorter( indexInterfaceForTheseTests );
+                for ( int i=0; i<total; i++ ) {
+                    sorter.add( BSON( "x" << rand() % 1000 ) , 5 , total - i );
+                }
+
+                sorter.sort();
+                ASSERT_EQUALS( 0 , sorter.numFiles() );
+
+                auto_ptr<BSONObjExternalSorter::Iterator> i = sorter.iterator();
+                int num=0;
+                int prevX = -1;
+                DiskLoc prevLoc;
+                while ( i->more() ) {
+                    pair<BSONObj,DiskLoc> p = i->next();
+                    num++;
+                    int x = p.first["x"].numberInt();
+                    ASSERT( x >= prevX );
+                    if ( x == prevX )
+                        ASSERT( prevLoc.compare( p.second ) < 0 );
+                    prevX = x;
+                    prevLoc = p.second;
+                }
+                ASSERT_EQUALS( total , num );
+            }
+        };
+
         class D1 {
         public:
             void run() {
@@ -2098,6 +2347,7 @@ namespace JsobjTests {
 
         void setupTests() {
             add< BufBuilderBasic >();
+            add< ArenaBuilders >();
             add< BSONElementBasic >();
             add< BSONObjTests::NullString >();
             add< BSONObjTests::Create >();
@@ -2119,6 +2369,8 @@ namespace JsobjTests {
             add< BSONObjTests::AppendAs >();
             add< BSONObjTests::ArrayAppendAs >();
             add< BSONObjTests::GetField >();
+            add< BSONObjTests::FieldOffsetsLookup >();
+            add< BSONObjTests::KeyMemcmpOrder >();
 
             add< BSONObjTests::Validation::BadType >();
             add< BSONObjTests::Validation::EooBeforeEnd >();
@@ -2183,6 +2435,7 @@ namespace JsobjTests {
             add< external_sort::ByDiskLock >();
             add< external_sort::Big1 >();
             add< external_sort::Big2 >();
+            add< external_sort::BigInMem >();
             add< external_sort::D1 >();
             add< CompatBSON >();
             add< CompareDottedFieldNamesTest >();
@@ -127,6 +127,37 @@ namespace JsonTests {
             }
         };
 
+        /** doubles print as a stringstream of precision 16 would print them */
+        class DoublePrecision {
+        public:
+            void run() {
+                double values[] = { 0.0, -0.0, 1.0, -1.0, 0.1, 1.5, -3.14, 1e15, 1e16, -1e16,
+                                    9007199254740993.0, 123456789012345.6, 1.0/3, 1e-7, 5e300,
+                                    numeric_limits< double >::max(), numeric_limits< double >::min() };
+                for( unsigned i = 0; i < sizeof( values ) / sizeof( values[ 0 ] ); ++i ) {
+                    stringstream ss;
+                    ss.precision( 16 );
+                    ss << "{ \"a\" : " << values[ i ] << " }";
+                    ASSERT_EQUALS( ss.str(), BSON( "a" << values[ i ] ).jsonString( Strict ) );
+                }
+            }
+        };
+
+        /** one StringBuilder may collect the json of many objects */
+        class AppendToBuilder {
+        public:
+            void run() {
+                StringBuilder s;
+                BSON( "a" << 1 ).jsonString( s );
+                s << '\n';
+                BSON( "b" << BSON_ARRAY( "x" << 2.5 ) ).jsonString( s, TenGen );
+                ASSERT_EQUALS( "{ \"a\" : 1 }\n{ \"b\" : [ \"x\", 2.5 ] }", s.str() );
+                s.reset();
+                BSON( "c" << "d\"e" ).firstElement().jsonString( s, Strict );
+                ASSERT_EQUALS( "\"c\" : \"d\\\"e\"", s.str() );
+            }
+        };
+
         class NegativeNumber {
         public:
             void run() {
@@ -1087,6 +1118,68 @@ namespace JsonTests {
             }
         };
 
+        class TrailingWhiteSpace : public Base {
+            virtual BSONObj bson() const {
+                return BSON( "a" << 1 );
+            }
+            virtual string json() const {
+                return "{ \"a\" : 1 } \r\n";
+            }
+        };
+
+        class TrailingGarbage : public Bad {
+            virtual string json() const {
+                return "{ \"a\" : 1 } x";
+            }
+        };
+
+        class LongOverflow : public Bad {
+            virtual string json() const {
+                return "{ \"a\" : 9223372036854775808 }";
+            }
+        };
+
+        class DateOverflow : public Bad {
+            virtual string json() const {
+                return "{ \"a\" : new Date( 18446744073709551616 ) }";
+            }
+        };
+
+        /** a reserved name that is not one of the extended types is just an error */
+        class NotExtended : public Bad {
+            virtual string json() const {
+                return "{ \"a\" : { \"$date\" : 1, \"b\" : 2 } }";
+            }
+        };
+
+        /** an object that starts like a Dbref but isn't one is an ordinary object */
+        class NotDBRef : public Base {
+            virtual BSONObj bson() const {
+                return BSON( "a" << BSON( "$ref" << "foo" << "b" << 2 ) );
+            }
+            virtual string json() const {
+                return "{ \"a\" : { \"$ref\" : \"foo\", \"b\" : 2 } }";
+            }
+        };
+
+        /** with len, each object of newline delimited input is parsed in turn */
+        class Consecutive {
+        public:
+            void run() {
+                const char *json = "{ \"a\" : 1 }\n{ \"a\" : [ 2 ] }\n";
+                int len;
+                ASSERT_EQUALS( BSON( "a" << 1 ), fromjson( json, &len ) );
+                ASSERT_EQUALS( 11, len );
+                json += len;
+                ASSERT_EQUALS( BSON( "a" << BSON_ARRAY( 2 ) ), fromjson( json, &len ) );
+                ASSERT_EQUALS( 16, len );
+                json += len;
+                ASSERT_THROWS( fromjson( json, &len ), MsgAssertionException );
+                ASSERT( fromjson( "", &len ).isEmpty() );
+                ASSERT_EQUALS( 0, len );
+            }
+        };
+
     } // namespace FromJsonTests
 
     class All : public Suite {
@@ -1105,6 +1198,8 @@ namespace JsonTests {
             add< JsonStringTests::SingleNumberMember >();
             add< JsonStringTests::InvalidNumbers >();
             add< JsonStringTests::NumberPrecision >();
+            add< JsonStringTests::DoublePrecision >();
+            add< JsonStringTests::AppendToBuilder >();
             add< JsonStringTests::NegativeNumber >();
             add< JsonStringTests::SingleBoolMember >();
             add< JsonStringTests::SingleNullMember >();
@@ -1178,6 +1273,13 @@ namespace JsonTests {
             add< FromJsonTests::EmbeddedDatesFormat2 >();
             add< FromJsonTests::EmbeddedDatesFormat3 >();
             add< FromJsonTests::NullString >();
+            add< FromJsonTests::TrailingWhiteSpace >();
+            add< FromJsonTests::TrailingGarbage >();
+            add< FromJsonTests::LongOverflow >();
+            add< FromJsonTests::DateOverflow >();
+            add< FromJsonTests::NotExtended >();
+            add< FromJsonTests::NotDBRef >();
+            add< FromJsonTests::Consecutive >();
         }
     } myall;
 
@@ -282,6 +282,38 @@ private:
     IncreasingInsertRangedUniformRemoveOID _gen;
 };
 
+/**
+ * String Keys with long shared prefixes, like compound tenant / path keys
+ * Inserts increasing within a random tenant
+ * Uniform Removes
+ * Compare an _id index of version 1 and 2 (prefix compressed) by passing the
+ * version on the command line.
+ */
+class TenantPathInsertUniformRemoveString : public InsertAndUniformRemoveStrategy< string > {
+public:
+    enum { Tenants = 100 };
+    TenantPathInsertUniformRemoveString() :
+        _uniform_tenant( 0, Tenants - 1 ),
+        _nextTenant( randomNumberGenerator, _uniform_tenant ),
+        _count( 0 ) {
+    }
+    virtual string insertVal() {
+        char buf[ 128 ];
+        sprintf( buf, "%s/home/shared/projects/reports/%.10lld", tenantPrefix( _nextTenant() ).c_str(), ++_count );
+        return buf;
+    }
+    /** @return a key prefix selecting one tenant's keys */
+    static string tenantPrefix( int tenant ) {
+        char buf[ 64 ];
+        sprintf( buf, "org.example.customers.tenant%.6d", tenant );
+        return buf;
+    }
+private:
+    uniform_int< int > _uniform_tenant;
+    variate_generator< mt19937&, uniform_int< int > > _nextTenant;
+    long long _count;
+};
+
 /**
  * Integer Keys
  * Increasing Inserts
@@ -404,6 +436,13 @@ int main( int argc, const char **argv ) {
     conn.connect( "127.0.0.1:27017" );
     conn.dropCollection( ns );
 
+    // Optionally specify the _id index version, eg 2 for prefix compressed buckets.
+    if ( argc > 1 ) {
+        BSONObj info;
+        conn.runCommand( db, BSON( "create" << "btreeperf" << "autoIndexId" << false ), info );
+        conn.ensureIndex( ns, BSON( "_id" << 1 ), true, "_id_", false, false, atoi( argv[ 1 ] ) );
+    }
+
 //    UniformInsertRangedUniformRemoveInteger strategy;
 //    UniformInsertUniformRemoveInteger strategy;
 //    UniformInsertRangedUniformRemoveString strategy;
@@ -411,6 +450,7 @@ int main( int argc, const char **argv ) {
 //    IncreasingInsertRangedUniformRemoveOID strategy;
 //    IncreasingInsertUniformRemoveOID strategy;
 //    IncreasingInsertIncreasingRemoveInteger strategy;
+//    TenantPathInsertUniformRemoveString strategy;
 //    InsertAndRemoveScriptGenerator runner( strategy, 5 );
     InsertAndRemoveScriptRunner runner( conn );
 
@@ -418,7 +458,7 @@ int main( int argc, const char **argv ) {
     BSONObj statsCmd = BSON( "collstats" << index_collection );
 
     // Print header, unless we are generating a script (in that case, comment this out).
-    cout << "ops,milliseconds,docs,totalBucketSize" << endl;
+    cout << "ops,milliseconds,docs,totalBucketSize,lookupsPerSecond" << endl;
 
     long long i = 0;
     long long n = 10000000000;
@@ -436,7 +476,13 @@ int main( int argc, const char **argv ) {
             // The total number of bytes used for all allocated 8K buckets of the
             // btree.
             long long totalBucketSize = result.getField( "count" ).numberLong() * 8192;
-            cout << i << ',' << t.millis() << ',' << docs << ',' << totalBucketSize << endl;
+            // Point lookups, which descend the btree comparing keys in each bucket.
+            Timer lookups;
+            for( int j = 0; j < 1000; ++j ) {
+                conn.findOne( ns, QUERY( "_id" << GTE << TenantPathInsertUniformRemoveString::tenantPrefix( j % TenantPathInsertUniformRemoveString::Tenants ) ) );
+            }
+            long long lookupsPerSecond = 1000LL * 1000000 / ( lookups.micros() + 1 );
+            cout << i << ',' << t.millis() << ',' << docs << ',' << totalBucketSize << ',' << lookupsPerSecond << endl;
         }
     }
 }
@@ -37,7 +37,9 @@
 #include "../util/checksum.h"
 #include "../util/version.h"
 #include "../db/key.h"
+#include "../db/matcher.h"
 #include "../util/compress.h"
+#include "../s/chunk.h"
 
 #include <boost/filesystem/operations.hpp>
 
@@ -455,6 +457,65 @@ namespace PerfTests {
         }
     };
 
+    /** a typical 40 field document, as the matcher and insert validation see them */
+    class BSON40 : public NonDurTest {
+    public:
+        int n;
+        bo b;
+        BSON40() {
+            n = 0;
+            bob o;
+            o.append("_id", OID::gen());
+            for( int i = 1; i < 40; i++ ) {
+                stringstream ss;
+                ss << "field_" << i;
+                switch( i % 4 ) {
+                case 0: o.append(ss.str(), i); break;
+                case 1: o.append(ss.str(), i * 1.5); break;
+                case 2: o.append(ss.str(), "some string value"); break;
+                default: o.append(ss.str(), BSON("x" << i << "y" << "abc")); break;
+                }
+            }
+            b = o.obj();
+        }
+    };
+
+    class BSONValid40 : public BSON40 {
+    public:
+        string name() { return "BSONValid40"; }
+        void timed() {
+            if( b.valid() )
+                n++;
+        }
+    };
+
+    class BSONGetField40 : public BSON40 {
+    public:
+        string name() { return "BSONGetField40"; }
+        void timed() {
+            if( !b.getField("field_20").eoo() )
+                n++;
+            if( !b.getFieldDotted("field_39.y").eoo() )
+                n++;
+            if( b.getField("field_40").eoo() )
+                n++;
+        }
+    };
+
+    /** several predicates against the same document */
+    class Matcher40 : public BSON40 {
+    public:
+        Matcher m;
+        string name() { return "Matcher40"; }
+        Matcher40() : m( BSON( "field_4" << 4 << "field_21" << GT << 20.0 <<
+                               "field_38" << "some string value" << "field_39.x" << 39 ) ) {
+        }
+        void timed() {
+            if( m.matches( b ) )
+                n++;
+        }
+    };
+
     class KeyTest : public B {
     public:
         KeyV1Owned a,b,c;
@@ -472,6 +533,94 @@ namespace PerfTests {
         }
     };
 
+    /** two sort keys that differ only in their last field, under a mixed direction pattern */
+    class SortKeyBase : public B {
+    public:
+        BSONObj a, b;
+        Ordering o;
+        int n;
+        SortKeyBase() :
+          a(BSON(""<<"tenant5"<<""<<1234<<""<<"reports/100321"<<""<<3.5)),
+          b(BSON(""<<"tenant5"<<""<<1234<<""<<"reports/100321"<<""<<4.5)),
+          o(Ordering::make(BSON("t"<<1<<"n"<<-1<<"p"<<1<<"x"<<-1))), n(0)
+          {}
+        virtual bool showDurStats() { return false; }
+    };
+
+    class SortKeyWoCompare : public SortKeyBase {
+    public:
+        string name() { return "SortKey-woCompare"; }
+        void timed() {
+            if( a.woCompare(b, o, false) > 0 )
+                n++;
+        }
+    };
+
+    /** the same compare on KeyMemcmp encodings, as the in memory sorts do it */
+    class SortKeyMemcmp : public SortKeyBase {
+    public:
+        string ea, eb;
+        string name() { return "SortKey-memcmp"; }
+        SortKeyMemcmp() {
+            KeyMemcmp::encode(a, o, ea);
+            KeyMemcmp::encode(b, o, eb);
+        }
+        void timed() {
+            if( ea.compare(eb) > 0 )
+                n++;
+        }
+    };
+
+    /** what each key costs once, up front */
+    class SortKeyEncode : public SortKeyBase {
+    public:
+        string e;
+        string name() { return "SortKey-encode"; }
+        void timed() {
+            e.clear();
+            if( KeyMemcmp::encode(a, o, e) )
+                n++;
+        }
+    };
+
+    /** mongos routing lookups over 10k chunk boundaries on a compound shard key */
+    class ChunkRouteMap : public NonDurTest {
+    public:
+        map<BSONObj,int,BSONObjCmp> m;
+        vector<BSONObj> keys;
+        unsigned i, n;
+        string name() { return "ChunkRoute-map"; }
+        ChunkRouteMap() : i(0), n(0) {
+            for( int j = 0; j < 10000; j++ )
+                m[ BSON( "tenant" << j / 100 << "path" << path( j % 100 * 10 ) ) ] = j;
+            for( int j = 0; j < 4096; j++ )
+                keys.push_back( BSON( "tenant" << rand() % 100 << "path" << path( rand() % 1000 ) ) );
+        }
+        static string path( int j ) {
+            stringstream ss;
+            ss << "/home/shared/" << 100000 + j;
+            return ss.str();
+        }
+        void timed() {
+            if( m.upper_bound( keys[ i++ & 4095 ] ) != m.end() )
+                n++;
+        }
+    };
+
+    class ChunkRouteFlat : public ChunkRouteMap {
+    public:
+        ChunkBoundaries b;
+        string name() { return "ChunkRoute-flat"; }
+        ChunkRouteFlat() {
+            for( map<BSONObj,int,BSONObjCmp>::const_iterator j = m.begin(); j != m.end(); ++j )
+                b.append( j->first );
+        }
+        void timed() {
+            if( b.upperBound( keys[ i++ & 4095 ] ) != b.size() )
+                n++;
+        }
+    };
+
     unsigned long long aaa;
 
     class Timer : public B {
@@ -616,6 +765,38 @@ namespace PerfTests {
         }
     };
 
+    /** a mongoimport line, as mongoexport writes it */
+    class JsonParse : public B {
+    public:
+        string json;
+        int n;
+        string name() { return "fromjson"; }
+        JsonParse() : n(0) {
+            json = "{ \"_id\" : { \"$oid\" : \"4f2b8c0e6e1b1c3a5d000001\" }, \"name\" : \"Joe Bloggs\", "
+                   "\"age\" : 37, \"score\" : 12.5, \"tags\" : [ \"a\", \"bb\", \"ccc\" ], "
+                   "\"addr\" : { \"street\" : \"10 Main St\", \"zip\" : \"10001\" }, "
+                   "\"active\" : true, \"created\" : { \"$date\" : 1328253966000 } }";
+        }
+        virtual bool showDurStats() { return false; }
+        void timed() {
+            n += fromjson( json ).objsize();
+        }
+    };
+
+    /** a mongoexport line */
+    class JsonString : public JsonParse {
+    public:
+        BSONObj o;
+        StringBuilder s;
+        string name() { return "jsonString"; }
+        JsonString() : o( fromjson( json ) ) { }
+        void timed() {
+            s.reset();
+            o.jsonString( s );
+            n += s.len();
+        }
+    };
+
     class Bldr : public B {
     public:
         int n;
@@ -1077,11 +1258,21 @@ namespace PerfTests {
 #endif
                 add< CTM >();
                 add< KeyTest >();
+                add< SortKeyWoCompare >();
+                add< SortKeyMemcmp >();
+                add< SortKeyEncode >();
+                add< ChunkRouteMap >();
+                add< ChunkRouteFlat >();
+                add< JsonParse >();
+                add< JsonString >();
                 add< Bldr >();
                 add< StkBldr >();
                 add< BSONIter >();
                 add< BSONGetFields1 >();
                 add< BSONGetFields2 >();
+                add< BSONValid40 >();
+                add< BSONGetField40 >();
+                add< Matcher40 >();
                 add< TaskQueueTest >();
                 add< InsertDup >();
                 add< Insert1 >();
@@ -1329,11 +1329,33 @@ namespace QueryTests {
 
 
                 {
-                    // TODO: this is temporary SERVER-2104
                     Projection m;
                     m.init( BSON( "x.a" << 1 << "_id" << 0 ) );
 
                     scoped_ptr<Projection::KeyOnly> x( m.checkKey( BSON( "a" << 1 << "x.a" << 1 ) ) );
+                    ASSERT( x );
+
+                    ASSERT_EQUALS( BSON( "x" << BSON( "a" << 17 ) ) ,
+                                   x->hydrate( BSON( "" << 5 << "" << 17 ) ) );
+                }
+
+                {
+                    Projection m;
+                    m.init( BSON( "x.a" << 1 << "y" << 1 << "x.b.c" << 1 << "_id" << 0 ) );
+
+                    scoped_ptr<Projection::KeyOnly> x( m.checkKey( BSON( "x.a" << 1 << "y" << 1 << "x.b.c" << 1 ) ) );
+                    ASSERT( x );
+
+                    ASSERT_EQUALS( BSON( "x" << BSON( "a" << 1 << "b" << BSON( "c" << 3 ) ) << "y" << 2 ) ,
+                                   x->hydrate( BSON( "" << 1 << "" << 2 << "" << 3 ) ) );
+                }
+
+                {
+                    // a projected path can't be nested inside another projected path
+                    Projection m;
+                    m.init( BSON( "x" << 1 << "x.a" << 1 << "_id" << 0 ) );
+
+                    scoped_ptr<Projection::KeyOnly> x( m.checkKey( BSON( "x" << 1 << "x.a" << 1 ) ) );
                     ASSERT( ! x );
                 }
 
@@ -1407,6 +1429,31 @@ namespace QueryTests {
                 assertNumFilled( 1, t );
             }
         };
+
+        /** keys with and without a byte encoding sort together */
+        class MixedKeys : public Base {
+        public:
+            void run() {
+                FieldRangeSet frs( "n/a", BSONObj(), true );
+                Testable t( 0, 3, BSON( "a" << -1 ), frs );
+                t.add( BSON( "a" << 1 ), 0 );
+                t.add( BSONObjBuilder().appendDate( "a", -5 ).obj(), 0 ); // before the epoch
+                t.add( BSON( "a" << "x" ), 0 );
+                t.add( BSON( "a" << 2 ), 0 );
+
+                BufBuilder bb;
+                int nout;
+                t.fill( bb, 0, nout );
+                ASSERT_EQUALS( 3, nout );
+                const char *p = bb.buf();
+                BSONObj first( p );
+                BSONObj second( p += first.objsize() );
+                BSONObj third( p += second.objsize() );
+                ASSERT_EQUALS( Date, first[ "a" ].type() );
+                ASSERT_EQUALS( "x", second[ "a" ].str() );
+                ASSERT_EQUALS( 2, third[ "a" ].number() );
+            }
+        };
         
     } // namespace ScanAndOrderTests
 
@@ -1474,6 +1521,7 @@ namespace QueryTests {
             
             add< ScanAndOrderTests::Unlimited >();
             add< ScanAndOrderTests::LimitOne >();
+            add< ScanAndOrderTests::MixedKeys >();
         }
     } myall;
 
@@ -21,6 +21,7 @@
 #include "dbtests.h"
 
 #include "../client/parallel.h"
+#include "../s/chunk.h"
 
 namespace ShardingTests {
 
@@ -43,6 +44,60 @@ namespace ShardingTests {
         };
     }
 
+    namespace chunkboundariestests {
+        /** ChunkBoundaries::upperBound agrees with upper_bound on the map of BSONObj it stands in for */
+        class UpperBound {
+        public:
+            void run() {
+                map<BSONObj,int,BSONObjCmp> m;
+                ChunkBoundaries b;
+                for ( int i = -500; i < 500; i += 7 ) {
+                    BSONObj max = BSON( "a" << i << "b" << "x" );
+                    m[max] = 0;
+                    b.append( max );
+                }
+                BSONObjBuilder maxKeyBuilder;
+                maxKeyBuilder.appendMaxKey( "a" );
+                maxKeyBuilder.appendMaxKey( "b" );
+                BSONObj maxKey = maxKeyBuilder.obj();
+                m[maxKey] = 0;
+                b.append( maxKey );
+                ASSERT_EQUALS( m.size() , b.size() );
+
+                const char *strs[] = { "w", "x", "y" };
+                for ( int i = -510; i < 510; i++ ) {
+                    for ( int j = 0; j < 3; j++ ) {
+                        check( m , b , BSON( "a" << i << "b" << strs[j] ) );
+                    }
+                    check( m , b , BSON( "a" << i / 2.0 << "b" << "x" ) );
+                }
+                BSONObjBuilder minKey;
+                minKey.appendMinKey( "a" );
+                minKey.appendMinKey( "b" );
+                check( m , b , minKey.obj() );
+                check( m , b , maxKey );
+            }
+        private:
+            void check( const map<BSONObj,int,BSONObjCmp>& m , const ChunkBoundaries& b , const BSONObj& key ) {
+                unsigned expected = distance( m.begin() , m.upper_bound( key ) );
+                ASSERT_EQUALS( expected , b.upperBound( key ) );
+            }
+        };
+
+        class Empty {
+        public:
+            void run() {
+                ChunkBoundaries b;
+                ASSERT_EQUALS( 0U , b.upperBound( BSON( "a" << 1 ) ) );
+                b.append( BSON( "a" << 5 ) );
+                ASSERT_EQUALS( 0U , b.upperBound( BSON( "a" << 1 ) ) );
+                ASSERT_EQUALS( 1U , b.upperBound( BSON( "a" << 5 ) ) );
+                b.clear();
+                ASSERT_EQUALS( 0U , b.size() );
+            }
+        };
+    }
+
     class All : public Suite {
     public:
         All() : Suite( "sharding" ) {
@@ -50,6 +105,8 @@ namespace ShardingTests {
 
         void setupTests() {
             add< serverandquerytests::test1 >();
+            add< chunkboundariestests::UpperBound >();
+            add< chunkboundariestests::Empty >();
         }
     } myall;
 
@@ -195,6 +195,9 @@ namespace mongo {
             shardLimitsMap[ s.getName() ] = limitsObj;
         }
 
+        map< string , map<string,double> > opsPerSec;
+        _getOpRates( allShards , &opsPerSec );
+
         //
         // 3. For each collection, check if the balancing policy recommends moving anything around.
         //
@@ -224,11 +227,79 @@ namespace mongo {
                 shardToChunksMap[s.getName()].size();
             }
 
-            CandidateChunk* p = _policy->balance( ns , shardLimitsMap , shardToChunksMap , _balancedLastTime );
+            // the policy only weighs load if every shard has a rate for this collection
+            map< string, BSONObj > limitsMap = shardLimitsMap;
+            for ( map< string , map<string,double> >::const_iterator i = opsPerSec.begin(); i != opsPerSec.end(); ++i ) {
+                map<string,double>::const_iterator j = i->second.find( ns );
+                BSONObjBuilder b;
+                b.appendElements( limitsMap[ i->first ] );
+                b << LimitsFields::opsPerSec( j == i->second.end() ? 0 : j->second );
+                limitsMap[ i->first ] = b.obj();
+            }
+
+            CandidateChunk* p = _policy->balance( ns , limitsMap , shardToChunksMap , _balancedLastTime );
+
+            // When a single chunk carries most of a shard's operations, the load follows it to the
+            // receiver, which then looks like the one to take load off. Don't bounce it back.
+            if ( p && p->forLoad ) {
+                BSONObj min = p->chunk["min"].Obj();
+                map< string , pair<BSONObj,string> >::const_iterator last = _loadMoves.find( ns );
+                if ( last != _loadMoves.end() && last->second.second == p->to && last->second.first.woCompare( min ) == 0 ) {
+                    LOG(1) << "not moving " << p->chunk << " of " << ns << " back to " << p->to << endl;
+                    delete p;
+                    p = 0;
+                }
+                else {
+                    _loadMoves[ ns ] = make_pair( min.getOwned() , p->from );
+                }
+            }
+
             if ( p ) candidateChunks->push_back( CandidateChunkPtr( p ) );
         }
     }
 
+    void Balancer::_getOpRates( const vector<Shard>& shards, map< string , map<string,double> >* opsPerSec ) {
+        const unsigned long long now = curTimeMillis64();
+
+        for ( vector<Shard>::const_iterator it = shards.begin(); it != shards.end(); ++it ) {
+            const string& name = it->getName();
+
+            BSONObj totals;
+            try {
+                totals = it->runCommand( "admin" , "top" )["totals"].Obj().getOwned();
+            }
+            catch ( std::exception& e ) {
+                LOG(1) << "couldn't get operation counts from " << name << causedBy( e ) << endl;
+                _lastTotals.erase( name );
+                continue;
+            }
+
+            map< string , pair<BSONObj,unsigned long long> >::iterator last = _lastTotals.find( name );
+            if ( last != _lastTotals.end() && now > last->second.second + 1000 ) {
+                const double secs = ( now - last->second.second ) / 1000.0;
+                map<string,double>& rates = (*opsPerSec)[ name ];
+
+                BSONObjIterator i( totals );
+                while ( i.more() ) {
+                    BSONElement e = i.next();
+                    if ( e.type() != Object )
+                        continue;
+
+                    // counters restart with the shard, and with the collection when it is dropped
+                    long long count = e.Obj().getFieldDotted( "total.count" ).numberLong();
+                    BSONElement prev = last->second.first[ e.fieldName() ];
+                    long long before = prev.isABSONObj() ? prev.Obj().getFieldDotted( "total.count" ).numberLong() : 0;
+                    if ( count < before )
+                        before = 0;
+
+                    rates[ e.fieldName() ] = ( count - before ) / secs;
+                }
+            }
+
+            _lastTotals[ name ] = make_pair( totals , now );
+        }
+    }
+
     bool Balancer::_init() {
         try {
 
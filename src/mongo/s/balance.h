@@ -32,7 +32,8 @@ namespace mongo {
      *
      * The balancer does act continuously but in "rounds". At a given round, it would decide if there is an imbalance by
      * checking the difference in chunks between the most and least loaded shards. It would issue a request for a chunk
-     * migration per round, if it found so.
+     * migration per round, if it found so. Once chunk counts are close, the per collection operation rates each shard
+     * reports through 'top' may also call for a migration, from the busiest shard to the idlest one.
      */
     class Balancer : public BackgroundJob {
     public:
@@ -60,6 +61,12 @@ namespace mongo {
 
         // decide which chunks to move; owned here.
         scoped_ptr<BalancerPolicy> _policy;
+
+        // per shard 'top' totals as of the last round and when they were taken (millis)
+        map< string , pair<BSONObj,unsigned long long> > _lastTotals;
+
+        // per collection, the min key of the chunk last moved to even out load and the shard it left
+        map< string , pair<BSONObj,string> > _loadMoves;
         
         /**
          * Checks that the balancer can connect to all servers it needs to do its job.
@@ -79,6 +86,15 @@ namespace mongo {
          */
         void _doBalanceRound( DBClientBase& conn, vector<CandidateChunkPtr>* candidateChunks );
 
+        /**
+         * Samples the operation counters of each shard and works out the rates since the last round.
+         *
+         * @param shards to sample
+         * @param opsPerSec (OUT) shard name to namespace to operations per second; a shard is only
+         *        present if it was sampled in both rounds, and namespaces it did no work on are absent
+         */
+        void _getOpRates( const vector<Shard>& shards, map< string , map<string,double> >* opsPerSec );
+
         /**
          * Issues chunk migration request, one at a time.
          *
@@ -31,6 +31,12 @@ namespace mongo {
     // limits map fields
     BSONField<long long> LimitsFields::currSize( "currSize" );
     BSONField<bool> LimitsFields::hasOpsQueued( "hasOpsQueued" );
+    BSONField<double> LimitsFields::opsPerSec( "opsPerSec" );
+
+    // a shard is worth taking load off when it does at least this many times the operations of
+    // the least loaded one, and the difference is at least this many operations per second
+    static const double loadSkewRatio = 2.0;
+    static const double minLoadSkew = 100.0;
 
     BalancerPolicy::ChunkInfo* BalancerPolicy::balance( const string& ns,
             const ShardToLimitsMap& shardToLimitsMap,
@@ -42,6 +48,11 @@ namespace mongo {
 
         bool maxOpsQueued = false;
 
+        // Operation rates, used only when every shard reports one
+        bool haveLoad = true;
+        pair<string,double> hot("",-1);
+        pair<string,double> cold("",numeric_limits<double>::max());
+
         for (ShardToChunksIter i = shardToChunksMap.begin(); i!=shardToChunksMap.end(); ++i ) {
 
             // Find whether this shard's capacity or availability are exhausted
@@ -52,8 +63,9 @@ namespace mongo {
             const bool maxedOut = isSizeMaxed( shardLimits );
             const bool draining = isDraining( shardLimits );
             const bool opsQueued = hasOpsQueued( shardLimits );
+            const double ops = opsPerSec( shardLimits );
+            if ( ops < 0 ) haveLoad = false;
 
-            
             // Is this shard a better chunk receiver then the current one?
             // Shards that would be bad receiver candidates:
             // + maxed out shards
@@ -64,6 +76,9 @@ namespace mongo {
                 if ( size < min.second ) {
                     min = make_pair( shard , size );
                 }
+                if ( ops < cold.second ) {
+                    cold = make_pair( shard , ops );
+                }
             }
             else if ( opsQueued ) {
                 LOG(1) << "won't send a chunk to: " << shard << " because it has ops queued" << endl;
@@ -82,6 +97,11 @@ namespace mongo {
             if ( draining && (size > 0)) {
                 drainingShards.push_back( shard );
             }
+
+            // And whether it is the busiest shard that could give a chunk away for load's sake.
+            if ( ! draining && ! opsQueued && size > 0 && ops > hot.second ) {
+                hot = make_pair( shard , ops );
+            }
         }
 
         // If there is no candidate chunk receiver -- they may have all been maxed out,
@@ -104,15 +124,26 @@ namespace mongo {
             joinStringDelim( drainingShards, &drainingStr, ',' );
             LOG(1) << "draining           : " << ! drainingShards.empty() << "(" << drainingShards.size() << ")" << endl;
         }
+        if ( haveLoad ) {
+            LOG(1) << "busiest    : " << hot.second << " ops/sec on " << hot.first << endl;
+            LOG(1) << "idlest     : " << cold.second << " ops/sec on " << cold.first << endl;
+        }
 
         // Solving imbalances takes a higher priority than draining shards. Many shards can
         // be draining at once but we choose only one of them to cater to per round.
         // Important to start balanced, so when there are few chunks any imbalance must be fixed.
+        //
+        //
+        // When every shard reports its operation rate, counts within 'slack' of each other are
+        // left to load instead: a chunk moves off the busiest shard if that doesn't push the
+        // counts past 'slack', so the count rule never undoes a load move.
         const int imbalance = max.second - min.second;
-        int threshold = 8;
-        if (balancedLastTime || max.second < 20) threshold = 2;
-        else if (max.second < 80) threshold = 4;
+        int slack = 8;
+        if (max.second < 20) slack = 2;
+        else if (max.second < 80) slack = 4;
+        const int threshold = ( balancedLastTime && ! haveLoad ) ? 2 : slack;
         string from, to;
+        bool forLoad = false;
         if ( imbalance >= threshold ) {
             from = max.first;
             to = min.first;
@@ -122,6 +153,32 @@ namespace mongo {
             from = drainingShards[ rand() % drainingShards.size() ];
             to = min.first;
 
+        }
+        else if ( haveLoad && ! hot.first.empty() && hot.first != cold.first &&
+                  isLoadSkewed( hot.second , cold.second ) ) {
+            const int hotSize = shardToChunksMap.find( hot.first )->second.size();
+            const int coldSize = shardToChunksMap.find( cold.first )->second.size();
+            const int newMax = std::max( (int)max.second , coldSize + 1 );
+            const int newMin = std::min( (int)min.second , hotSize - 1 );
+            if ( newMax - newMin >= slack ) {
+                LOG(1) << "load imbalance between " << hot.first << " and " << cold.first
+                       << " but moving a chunk would unbalance chunk counts" << endl;
+                return NULL;
+            }
+
+            // Rates are per shard, not per chunk. Assuming the load is spread over the hot
+            // shard's chunks, a move must not leave the receiver the busier of the two.
+            const double perChunk = hot.second / hotSize;
+            if ( cold.second + perChunk > hot.second - perChunk ) {
+                LOG(1) << "load imbalance between " << hot.first << " and " << cold.first
+                       << " is within a chunk's share of load" << endl;
+                return NULL;
+            }
+
+            from = hot.first;
+            to = cold.first;
+            forLoad = true;
+
         }
         else {
             // Everything is balanced here!
@@ -133,7 +190,7 @@ namespace mongo {
         BSONObj chunkToMove = pickChunk( chunksFrom , chunksTo );
         log() << "chose [" << from << "] to [" << to << "] " << chunkToMove << endl;
 
-        return new ChunkInfo( ns, to, from, chunkToMove );
+        return new ChunkInfo( ns, to, from, chunkToMove, forLoad );
     }
 
     BSONObj BalancerPolicy::pickChunk( const vector<BSONObj>& from, const vector<BSONObj>& to ) {
@@ -189,4 +246,16 @@ namespace mongo {
         return true;
     }
 
+    double BalancerPolicy::opsPerSec( BSONObj limits ) {
+        BSONElement ops = limits[ LimitsFields::opsPerSec.name() ];
+        if ( ! ops.isNumber() ) {
+            return -1;
+        }
+        return ops.number();
+    }
+
+    bool BalancerPolicy::isLoadSkewed( double hot, double cold ) {
+        return hot >= loadSkewRatio * cold && hot - cold >= minLoadSkew;
+    }
+
 }  // namespace mongo
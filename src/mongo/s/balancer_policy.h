@@ -33,8 +33,9 @@ namespace mongo {
          * moving, it returns NULL.
          *
          * @param ns is the collections namepace.
-         * @param shardLimitMap is a map from shardId to an object that describes (for now) space
-         * cap and usage. E.g.: { "maxSize" : <size_in_MB> , "usedSize" : <size_in_MB> }.
+         * @param shardLimitMap is a map from shardId to an object that describes space cap and usage
+         * and, optionally, the rate of operations against this collection on that shard.
+         * E.g.: { "maxSize" : <size_in_MB> , "usedSize" : <size_in_MB> , "opsPerSec" : <double> }.
          * @param shardToChunksMap is a map from shardId to chunks that live there. A chunk's format
          * is { }.
          * @param balancedLastTime is the number of chunks effectively moved in the last round.
@@ -67,6 +68,18 @@ namespace mongo {
          */
         static bool hasOpsQueued( BSONObj shardLimits );
 
+        /**
+         * Returns the operations per second the collection sees on a shard, or -1 if 'shardLimits'
+         * carries no "opsPerSec" field.
+         */
+        static double opsPerSec( BSONObj shardLimits );
+
+        /**
+         * Returns true if a shard doing 'hot' operations per second is loaded enough more than one
+         * doing 'cold' that moving a chunk between them is worthwhile.
+         */
+        static bool isLoadSkewed( double hot, double cold );
+
     private:
         // Convenience types
         typedef ShardToChunksMap::const_iterator ShardToChunksIter;
@@ -79,9 +92,11 @@ namespace mongo {
         const string to;
         const string from;
         const BSONObj chunk;
+        const bool forLoad; // suggested to even out operation rates rather than chunk counts
 
-        ChunkInfo( const string& a_ns , const string& a_to , const string& a_from , const BSONObj& a_chunk )
-            : ns( a_ns ) , to( a_to ) , from( a_from ), chunk( a_chunk ) {}
+        ChunkInfo( const string& a_ns , const string& a_to , const string& a_from , const BSONObj& a_chunk ,
+                   bool a_forLoad = false )
+            : ns( a_ns ) , to( a_to ) , from( a_from ), chunk( a_chunk ) , forLoad( a_forLoad ) {}
     };
 
     /**
@@ -91,6 +106,7 @@ namespace mongo {
         // we use 'draining' and 'maxSize' from the 'shards' collection plus the following
         static BSONField<long long> currSize; // currently used disk space in bytes
         static BSONField<bool> hasOpsQueued;  // writeback queue is not empty?
+        static BSONField<double> opsPerSec;   // operations per second on the collection, if known
     };
 
 }  // namespace mongo
@@ -78,6 +78,11 @@ namespace mongo {
         : _manager(info), _min(min), _max(max), _shard(shard), _lastmod(0), _jumbo(false), _dataWritten(mkDataWritten())
     {}
 
+    Chunk::Chunk(const ChunkManager * info , const Chunk& other)
+        : _manager(info), _min(other._min), _max(other._max), _shard(other._shard), _lastmod(other._lastmod),
+          _jumbo(other._jumbo), _dataWritten(other._dataWritten)
+    {}
+
     long Chunk::mkDataWritten() {
         return rand() % ( MaxChunkSize / 5 );
     }
@@ -168,7 +173,7 @@ namespace mongo {
         conn.done();
     }
 
-    void Chunk::pickSplitVector( vector<BSONObj>& splitPoints , int chunkSize /* bytes */, int maxPoints, int maxObjs ) const {
+    void Chunk::pickSplitVector( vector<BSONObj>& splitPoints , int chunkSize /* bytes */, int maxPoints, int maxObjs, bool estimate ) const {
         // Ask the mongod holding this chunk to figure out the split points.
         ScopedDbConnection conn( getShard().getConnString() );
         BSONObj result;
@@ -180,6 +185,8 @@ namespace mongo {
         cmd.append( "maxChunkSizeBytes" , chunkSize );
         cmd.append( "maxSplitPoints" , maxPoints );
         cmd.append( "maxChunkObjects" , maxObjs );
+        if ( estimate )
+            cmd.appendBool( "estimate" , true );
         BSONObj cmdObj = cmd.obj();
 
         if ( ! conn->runCommand( "admin" , cmdObj , result )) {
@@ -202,10 +209,11 @@ namespace mongo {
         // if splitting is not obligatory we may return early if there are not enough data
         // we cap the number of objects that would fall in the first half (before the split point)
         // the rationale is we'll find a split point without traversing all the data
+        // the shard estimates the split points from its index, so this doesn't read the chunk at all
         if ( ! force ) {
             vector<BSONObj> candidates;
             const int maxPoints = 2;
-            pickSplitVector( candidates , getManager()->getCurrentDesiredChunkSize() , maxPoints , MaxObjectPerChunk );
+            pickSplitVector( candidates , getManager()->getCurrentDesiredChunkSize() , maxPoints , MaxObjectPerChunk , true );
             if ( candidates.size() <= 1 ) {
                 // no split points means there isn't enough data to split on
                 // 1 split point means we have between half the chunk size to full chunk size
@@ -541,7 +549,7 @@ namespace mongo {
 
     AtomicUInt ChunkManager::NextSequenceNumber = 1;
 
-    ChunkManager::ChunkManager( string ns , ShardKeyPattern pattern , bool unique ) :
+    ChunkManager::ChunkManager( string ns , ShardKeyPattern pattern , bool unique , ChunkManagerPtr oldManager ) :
         _ns( ns ) , _key( pattern ) , _unique( unique ) , _chunkRanges(), _mutex("ChunkManager"),
         _nsLock( ConnectionString( configServer.modelServer() , ConnectionString::SYNC ) , ns ),
 
@@ -559,10 +567,26 @@ namespace mongo {
             set<Shard> shards;
             ShardVersionMap shardVersions;
             Timer t;
-            _load(chunkMap, shards, shardVersions);
+            bool diff = false;
+            if ( oldManager ) {
+                try {
+                    diff = _loadDiff(*oldManager, chunkMap, shards, shardVersions);
+                }
+                catch ( DBException& e ) {
+                    warning() << "ChunkManager: couldn't patch chunks for " << ns << ", doing a full reload: " << e.what() << endl;
+                }
+            }
+            // only try the diff once, if it fails or comes out invalid we fall back to full loads
+            oldManager.reset();
+            if ( ! diff ) {
+                chunkMap.clear();
+                shards.clear();
+                shardVersions.clear();
+                _load(chunkMap, shards, shardVersions);
+            }
             {
                 int ms = t.millis();
-                log() << "ChunkManager: time to load chunks for " << ns << ": " << ms << "ms" 
+                log() << "ChunkManager: time to " << ( diff ? "patch" : "load" ) << " chunks for " << ns << ": " << ms << "ms" 
                       << " sequenceNumber: " << _sequenceNumber 
                       << " version: " << _version.toString() 
                       << endl;
@@ -576,6 +600,14 @@ namespace mongo {
                 const_cast<set<Shard>&>(_shards).swap(shards);
                 const_cast<ShardVersionMap&>(_shardVersions).swap(shardVersions);
                 const_cast<ChunkRangeManager&>(_chunkRanges).reloadAll(_chunkMap);
+
+                vector<ChunkPtr>& chunkVector = const_cast<vector<ChunkPtr>&>(_chunkVector);
+                ChunkBoundaries& chunkBoundaries = const_cast<ChunkBoundaries&>(_chunkBoundaries);
+                chunkVector.reserve(_chunkMap.size());
+                for (ChunkMap::const_iterator it=_chunkMap.begin(), end=_chunkMap.end(); it != end; ++it) {
+                    chunkVector.push_back(it->second);
+                    chunkBoundaries.append(it->first);
+                }
                 return;
             }
             
@@ -627,6 +659,78 @@ namespace mongo {
         conn.done();
     }
 
+    bool ChunkManager::_loadDiff(const ChunkManager& oldManager, ChunkMap& chunkMap, set<Shard>& shards, ShardVersionMap& shardVersions) {
+        if ( oldManager._chunkMap.empty() || oldManager._key.key().woCompare( _key.key() ) != 0 )
+            return false;
+
+        ScopedDbConnection conn( configServer.modelServer() );
+
+        BSONObjBuilder q;
+        q.append( "ns" , _ns );
+        {
+            BSONObjBuilder lastmod( q.subobjStart( "lastmod" ) );
+            lastmod.appendTimestamp( "$gt" , oldManager._version.toLong() );
+            lastmod.done();
+        }
+
+        // oldest first, so a chunk changed twice since the old version ends up as its latest self
+        vector<ChunkPtr> changed;
+        auto_ptr<DBClientCursor> cursor = conn->query( Chunk::chunkMetadataNS, Query( q.obj() ).sort( "lastmod" , 1 ) );
+        assert( cursor.get() );
+        while ( cursor->more() ) {
+            BSONObj d = cursor->next();
+            if ( d["isMaxMarker"].trueValue() ) {
+                conn.done();
+                return false;
+            }
+            changed.push_back( ChunkPtr( new Chunk( this, d ) ) );
+        }
+
+        // chunks are never removed without their range being covered by a newer chunk, so the
+        // count tells us if anything happened that the diff can't describe (e.g. a drop)
+        unsigned long long total = conn->count( Chunk::chunkMetadataNS , BSON( "ns" << _ns ) );
+        conn.done();
+
+        chunkMap = oldManager._chunkMap;
+        for ( vector<ChunkPtr>::const_iterator i = changed.begin(); i != changed.end(); ++i ) {
+            const ChunkPtr& c = *i;
+
+            // drop whatever the new chunk now covers
+            ChunkMap::iterator it = chunkMap.upper_bound( c->getMin() );
+            while ( it != chunkMap.end() && it->second->getMin().woCompare( c->getMax() ) < 0 )
+                chunkMap.erase( it++ );
+
+            chunkMap[c->getMax()] = c;
+        }
+
+        if ( chunkMap.size() != total ) {
+            log() << "ChunkManager: " << chunkMap.size() << " chunks after applying " << changed.size()
+                  << " changes but config has " << total << " for " << _ns << ", doing a full reload" << endl;
+            return false;
+        }
+
+        // the carried over chunks still point at the old manager
+        ShardChunkVersion version;
+        for ( ChunkMap::iterator it = chunkMap.begin(); it != chunkMap.end(); ++it ) {
+            if ( it->second->getManager() != this )
+                it->second.reset( new Chunk( this, *it->second ) );
+
+            const ChunkPtr& c = it->second;
+            shards.insert( c->getShard() );
+
+            if ( c->getLastmod() > version )
+                version = c->getLastmod();
+
+            ShardChunkVersion& shardMax = shardVersions[c->getShard()];
+            if ( c->getLastmod() > shardMax )
+                shardMax = c->getLastmod();
+        }
+        _version = version;
+
+        LOG(1) << "ChunkManager: applied " << changed.size() << " changed chunks to version " << oldManager._version.toString() << " of " << _ns << endl;
+        return true;
+    }
+
     bool ChunkManager::_isValid(const ChunkMap& chunkMap) {
 #define ENSURE(x) do { if(!(x)) { log() << "ChunkManager::_isValid failed: " #x << endl; return false; } } while(0)
 
@@ -759,10 +863,10 @@ namespace mongo {
             BSONObj foo;
             ChunkPtr c;
             {
-                ChunkMap::const_iterator it = _chunkMap.upper_bound(key);
-                if (it != _chunkMap.end()) {
-                    foo = it->first;
-                    c = it->second;
+                unsigned i = _chunkBoundaries.upperBound(key);
+                if (i < _chunkVector.size()) {
+                    c = _chunkVector[i];
+                    foo = c->getMax();
                 }
             }
 
@@ -850,15 +954,15 @@ namespace mongo {
             uassert(13406, str::stream() << "max value " << max << " does not have shard key", hasShardKey(max));
         }
 
-        ChunkRangeMap::const_iterator it = _chunkRanges.upper_bound(min);
-        ChunkRangeMap::const_iterator end = _chunkRanges.upper_bound(max);
+        unsigned it = _chunkRanges.upperBoundIndex(min);
+        unsigned end = _chunkRanges.upperBoundIndex(max);
 
-        massert( 13507 , str::stream() << "no chunks found between bounds " << min << " and " << max , it != _chunkRanges.ranges().end() );
+        massert( 13507 , str::stream() << "no chunks found between bounds " << min << " and " << max , it != _chunkRanges.numRanges() );
 
-        if( end != _chunkRanges.ranges().end() ) ++end;
+        if( end != _chunkRanges.numRanges() ) ++end;
 
         for( ; it != end; ++it ){
-            shards.insert(it->second->getShard());
+            shards.insert(_chunkRanges.rangeAt(it).getShard());
 
             // once we know we need to visit all shards no need to keep looping
             if (shards.size() == _shards.size()) break;
@@ -1020,9 +1124,15 @@ namespace mongo {
     }
 
     void ChunkRangeManager::reloadAll(const ChunkMap& chunks) {
-        _ranges.clear();
+        clear();
         _insertRange(chunks.begin(), chunks.end());
 
+        _rangeVector.reserve(_ranges.size());
+        for (ChunkRangeMap::const_iterator it=_ranges.begin(), end=_ranges.end(); it != end; ++it) {
+            _rangeVector.push_back(it->second);
+            _boundaries.append(it->first);
+        }
+
         DEV assertValid();
     }
 
@@ -1038,6 +1148,27 @@ namespace mongo {
         }
     }
 
+    void ChunkBoundaries::append( const BSONObj& max ) {
+        KeyV1Owned k( max );
+        _offsets.push_back( _keys.size() );
+        _keys.insert( _keys.end(), k.data(), k.data() + k.dataSize() );
+        dassert( size() < 2 || _at( size() - 2 ).woCompare( _at( size() - 1 ), _ordering ) < 0 );
+    }
+
+    unsigned ChunkBoundaries::upperBound( const BSONObj& key ) const {
+        KeyV1Owned k( key );
+        unsigned first = 0;
+        unsigned len = _offsets.size();
+        while ( len > 0 ) {
+            unsigned half = len >> 1;
+            // select rather than branch on the comparison, so the loop only mispredicts on exit
+            bool le = _at( first + half ).woCompare( k, _ordering ) <= 0;
+            first = le ? first + half + 1 : first;
+            len = le ? len - half - 1 : half;
+        }
+        return first;
+    }
+
     int ChunkManager::getCurrentDesiredChunkSize() const {
         // split faster in early chunks helps spread out an initial load better
         const int minChunkSize = 1 << 20;  // 1 MBytes
@@ -27,6 +27,7 @@
 #include "shardkey.h"
 #include "shard.h"
 #include "util.h"
+#include "../db/key.h"
 
 namespace mongo {
 
@@ -55,6 +56,8 @@ namespace mongo {
     public:
         Chunk( const ChunkManager * info , BSONObj from);
         Chunk( const ChunkManager * info , const BSONObj& min, const BSONObj& max, const Shard& shard);
+        /** a copy of other belonging to info, for carrying unchanged chunks over to a reloaded manager */
+        Chunk( const ChunkManager * info , const Chunk& other );
 
         //
         // serialization support
@@ -129,8 +132,10 @@ namespace mongo {
          * @param chunkSize chunk size to target in bytes
          * @param maxPoints limits the number of split points that are needed, zero is max (optional)
          * @param maxObjs limits the number of objects in each chunk, zero is as max (optional)
+         * @param estimate have the shard estimate split points from its index rather than scan the chunk (optional)
          */
-        void pickSplitVector( vector<BSONObj>& splitPoints , int chunkSize , int maxPoints = 0, int maxObjs = 0) const;
+        void pickSplitVector( vector<BSONObj>& splitPoints , int chunkSize , int maxPoints = 0, int maxObjs = 0,
+                              bool estimate = false ) const;
 
         //
         // migration support
@@ -267,11 +272,37 @@ namespace mongo {
     };
 
 
+    /**
+     * The max keys of a run of chunks or chunk ranges, in order, flattened into one buffer of KeyV1
+     * encoded keys.  Routing lookups binary search it rather than walking a map of BSONObj.
+     */
+    class ChunkBoundaries {
+    public:
+        ChunkBoundaries() : _ordering( Ordering::make( BSONObj() ) ) { }
+
+        void clear() { _keys.clear(); _offsets.clear(); }
+
+        /** @param max must be greater than every boundary already appended */
+        void append( const BSONObj& max );
+
+        /** @return index of the first boundary greater than key, or size() if there is none */
+        unsigned upperBound( const BSONObj& key ) const;
+
+        unsigned size() const { return _offsets.size(); }
+
+    private:
+        KeyV1 _at( unsigned i ) const { return KeyV1( &_keys[ _offsets[i] ] ); }
+
+        vector<char> _keys;
+        vector<unsigned> _offsets;
+        Ordering _ordering;
+    };
+
     class ChunkRangeManager {
     public:
         const ChunkRangeMap& ranges() const { return _ranges; }
 
-        void clear() { _ranges.clear(); }
+        void clear() { _ranges.clear(); _rangeVector.clear(); _boundaries.clear(); }
 
         void reloadAll(const ChunkMap& chunks);
 
@@ -281,11 +312,20 @@ namespace mongo {
         ChunkRangeMap::const_iterator upper_bound(const BSONObj& o) const { return _ranges.upper_bound(o); }
         ChunkRangeMap::const_iterator lower_bound(const BSONObj& o) const { return _ranges.lower_bound(o); }
 
+        /** index of the first range whose max is greater than o, numRanges() if none */
+        unsigned upperBoundIndex(const BSONObj& o) const { return _boundaries.upperBound(o); }
+        unsigned numRanges() const { return _rangeVector.size(); }
+        const ChunkRange& rangeAt(unsigned i) const { return *_rangeVector[i]; }
+
     private:
         // assumes nothing in this range exists in _ranges
         void _insertRange(ChunkMap::const_iterator begin, const ChunkMap::const_iterator end);
 
         ChunkRangeMap _ranges;
+
+        // _ranges in order, for routing
+        vector< shared_ptr<ChunkRange> > _rangeVector;
+        ChunkBoundaries _boundaries;
     };
 
     /* config.sharding
@@ -298,7 +338,11 @@ namespace mongo {
     public:
         typedef map<Shard,ShardChunkVersion> ShardVersionMap;
 
-        ChunkManager( string ns , ShardKeyPattern pattern , bool unique );
+        /**
+         * @param oldManager if set, only chunks changed since its version are read from the config
+         *                   server and the rest are carried over from it
+         */
+        ChunkManager( string ns , ShardKeyPattern pattern , bool unique , ChunkManagerPtr oldManager = ChunkManagerPtr() );
 
         string getns() const { return _ns; }
 
@@ -314,6 +358,8 @@ namespace mongo {
 
         void getShardsForQuery( set<Shard>& shards , const BSONObj& query ) const;
         void getAllShards( set<Shard>& all ) const;
+        /** the number of shards getAllShards() would give, without copying them */
+        int numShards() const { return _shards.size(); }
         void getShardsForRange(set<Shard>& shards, const BSONObj& min, const BSONObj& max, bool fullKeyReq = true) const; // [min, max)
 
         ChunkMap getChunkMap() const { return _chunkMap; }
@@ -358,6 +404,7 @@ namespace mongo {
 
         // helpers for constructor
         void _load(ChunkMap& chunks, set<Shard>& shards, ShardVersionMap& shardVersions);
+        bool _loadDiff(const ChunkManager& oldManager, ChunkMap& chunks, set<Shard>& shards, ShardVersionMap& shardVersions);
         static bool _isValid(const ChunkMap& chunks);
 
         // All members should be const for thread-safety
@@ -368,6 +415,10 @@ namespace mongo {
         const ChunkMap _chunkMap;
         const ChunkRangeManager _chunkRanges;
 
+        // _chunkMap in order, for routing
+        const vector<ChunkPtr> _chunkVector;
+        const ChunkBoundaries _chunkBoundaries;
+
         const set<Shard> _shards;
 
         const ShardVersionMap _shardVersions; // max version per shard
@@ -163,6 +163,18 @@ namespace mongo {
 
                 result.append( "shardCursorType" , shardedCursorTypes.getObj() );
 
+                {
+                    BSONObjBuilder bb( result.subobjStart( "shardedInserts" ) );
+                    shardedInserts.append( bb );
+                    bb.done();
+                }
+
+                {
+                    BSONObjBuilder bb( result.subobjStart( "shardedWrites" ) );
+                    shardedWrites.append( bb );
+                    bb.done();
+                }
+
                 {
                     BSONObjBuilder asserts( result.subobjStart( "asserts" ) );
                     asserts.append( "regular" , assertionCount.regular );
@@ -226,6 +226,7 @@ namespace mongo {
         BSONObj key;
         bool unique;
         ShardChunkVersion oldVersion;
+        ChunkManagerPtr oldManager;
 
         {
             scoped_lock lk( _lock );
@@ -246,8 +247,10 @@ namespace mongo {
 
             key = ci.key().copy();
             unique = ci.unique();
-            if ( ci.getCM() )
-                oldVersion = ci.getCM()->getVersion();
+            if ( ci.getCM() ) {
+                oldManager = ci.getCM();
+                oldVersion = oldManager->getVersion();
+            }
         }
         
         assert( ! key.isEmpty() );
@@ -297,7 +300,12 @@ namespace mongo {
                 
             }
             
-            temp.reset( new ChunkManager( ns , key , unique ) );
+            // if the config server is ahead of us, only read the chunks that changed since our version
+            ChunkManagerPtr base;
+            if ( ! forceReload && ! newest.isEmpty() && ShardChunkVersion( newest["lastmod"] ) > oldVersion )
+                base = oldManager;
+
+            temp.reset( new ChunkManager( ns , key , unique , base ) );
             if ( temp->numChunks() == 0 ) {
                 // maybe we're not sharded any more
                 reload(); // this is a full reload
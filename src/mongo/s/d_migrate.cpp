@@ -38,11 +38,13 @@
 
 #include "../client/connpool.h"
 #include "../client/distlock.h"
+#include "../client/parallel.h"
 
 #include "../util/queue.h"
 #include "../util/unittest.h"
 #include "../util/processinfo.h"
 #include "../util/ramlog.h"
+#include "../util/scopeguard.h"
 
 #include "shard.h"
 #include "d_logic.h"
@@ -105,6 +107,19 @@ namespace mongo {
         }
 
 
+        /** docs and bytes moved in a phase and the rates, so migrations of different sizes compare */
+        void throughput( const string& phase , long long docs , long long bytes , long long millis ) {
+            BSONObjBuilder bb( _b.subobjStart( phase ) );
+            bb.appendNumber( "docs" , docs );
+            bb.appendNumber( "bytes" , bytes );
+            bb.appendNumber( "millis" , millis );
+            if ( millis > 0 ) {
+                bb.append( "docsPerSec" , docs * 1000.0 / millis );
+                bb.append( "bytesPerSec" , bytes * 1000.0 / millis );
+            }
+            bb.done();
+        }
+
         void note( const string& s ) {
             string field = "note";
             if ( _nextNote > 0 ) {
@@ -131,42 +146,36 @@ namespace mongo {
 
     };
 
+    /** a range left behind by a migration out, waiting to be deleted */
     struct OldDataCleanup {
-        static AtomicUInt _numThreads; // how many threads are doing async cleanup
-
         string ns;
         BSONObj min;
         BSONObj max;
-        set<CursorId> initial;
+        set<CursorId> initial; // cursors open at commit, which may still be reading the range
 
-        OldDataCleanup(){
-            _numThreads++;
-        }
-        OldDataCleanup( const OldDataCleanup& other ) {
-            ns = other.ns;
-            min = other.min.getOwned();
-            max = other.max.getOwned();
-            initial = other.initial;
-            _numThreads++;
-        }
-        ~OldDataCleanup(){
-            _numThreads--;
-        }
+        Date_t queued;
+        long long numDeleted; // kept by RangeDeleter, under its lock
+        shared_ptr<RemoveSaver> saver;
+
+        OldDataCleanup() : queued( jsTime() ) , numDeleted( 0 ) {}
 
         string toString() const {
             return str::stream() << ns << " from " << min << " -> " << max;
         }
-        
-        void doRemove() {
+
+        /**
+         * deletes up to batchSize documents of the range under a single write lock
+         * @return number deleted, less than batchSize once the range is empty
+         */
+        long long removeBatch( int batchSize ) {
             ShardForceVersionOkModeBlock sf;
-            {
-                writelock lk(ns);
-                RemoveSaver rs("moveChunk",ns,"post-cleanup");
-                long long numDeleted = Helpers::removeRange( ns , min , max , true , false , cmdLine.moveParanoia ? &rs : 0 );
-                log() << "moveChunk deleted: " << numDeleted << migrateLog;
-            }
-            
-            
+            writelock lk(ns);
+            if ( cmdLine.moveParanoia && ! saver )
+                saver.reset( new RemoveSaver( "moveChunk" , ns , "post-cleanup" ) );
+            return Helpers::removeRange( ns , min , max , false , false , saver.get() , batchSize );
+        }
+
+        void waitForReplication() {
             ReplTime lastOpApplied = cc().getLastOp().asDate();
             Timer t;
             for ( int i=0; i<3600; i++ ) {
@@ -182,8 +191,6 @@ namespace mongo {
 
     };
 
-    AtomicUInt OldDataCleanup::_numThreads = 0;
-
     static const char * const cleanUpThreadName = "cleanupOldData";
 
     class ChunkCommandHelper : public Command {
@@ -538,19 +545,15 @@ namespace mongo {
 
         bool isActive() const { return _getActive(); }
         
-        void doRemove( OldDataCleanup& cleanup ) {
-            int it = 0;
-            while ( true ) { 
-                if ( it > 20 && it % 10 == 0 ) log() << "doRemote iteration " << it << " for: " << cleanup << endl;
-                {
-                    scoped_lock ll(_workLock);
-                    if ( ! _active ) {
-                        cleanup.doRemove();
-                        return;
-                    }
-                }
-                sleepmillis( 1000 );
-            }
+        /**
+         * deletes a batch of cleanup's range, unless a migration out is in progress
+         * @return number of documents deleted, or -1 if the migration has to finish first
+         */
+        long long removeBatch( OldDataCleanup& cleanup , int batchSize ) {
+            scoped_lock ll(_workLock);
+            if ( _active )
+                return -1;
+            return cleanup.removeBatch( batchSize );
         }
 
     private:
@@ -593,61 +596,202 @@ namespace mongo {
         }
     };
 
-    void _cleanupOldData( OldDataCleanup cleanup ) {
-        Client::initThread( cleanUpThreadName );
-        if (!noauth) {
-            cc().getAuthenticationInfo()->authorize("local", internalSecurity.user);
+    /**
+     * Deletes the ranges migrated away from this shard, oldest first.  A range waits until the
+     * cursors open when it was queued are gone (or 15 minutes), then goes in batches of
+     * batchSize documents per write lock, no faster than docsPerSec when that is set.
+     */
+    class RangeDeleter : public BackgroundJob {
+    public:
+        RangeDeleter() : _m( "RangeDeleter" ) , _docsPerSec( 0 ) , _batchSize( 100 ) , _started( false ) , _numDeleted( 0 ) {}
+
+        string name() const { return "RangeDeleter"; }
+
+        void queue( const OldDataCleanup& cleanup ) {
+            scoped_lock lk( _m );
+            _queue.push_back( cleanup );
+            log() << "queued range deletion of " << cleanup << "  # cursors:" << cleanup.initial.size() << migrateLog;
+            if ( ! _started ) {
+                _started = true;
+                go();
+            }
         }
-        log() << " (start) waiting to cleanup " << cleanup << "  # cursors:" << cleanup.initial.size() << migrateLog;
 
-        int loops = 0;
-        Timer t;
-        while ( t.seconds() < 900 ) { // 15 minutes
-            assert( d.dbMutex.getState() == 0 );
-            sleepmillis( 20 );
+        /** @return true if a range of ns waiting to be deleted overlaps [min, max) */
+        bool overlaps( const string& ns , const BSONObj& min , const BSONObj& max ) const {
+            scoped_lock lk( _m );
+            for ( list<OldDataCleanup>::const_iterator i = _queue.begin(); i != _queue.end(); ++i ) {
+                if ( i->ns == ns && i->min.woCompare( max ) < 0 && min.woCompare( i->max ) < 0 )
+                    return true;
+            }
+            return false;
+        }
 
-            set<CursorId> now;
-            ClientCursor::find( cleanup.ns , now );
+        int numPending() const { scoped_lock lk( _m ); return _queue.size(); }
+
+        void setDocsPerSec( int n ) { scoped_lock lk( _m ); _docsPerSec = n; }
+        void setBatchSize( int n ) { scoped_lock lk( _m ); _batchSize = n; }
+
+        void status( BSONObjBuilder& b ) const {
+            scoped_lock lk( _m );
+            b.append( "docsPerSec" , _docsPerSec );
+            b.append( "batchSize" , _batchSize );
+            b.appendNumber( "deleted" , _numDeleted );
+            BSONArrayBuilder arr( b.subarrayStart( "pending" ) );
+            for ( list<OldDataCleanup>::const_iterator i = _queue.begin(); i != _queue.end(); ++i ) {
+                BSONObjBuilder bb( arr.subobjStart() );
+                bb.append( "ns" , i->ns );
+                bb.append( "min" , i->min );
+                bb.append( "max" , i->max );
+                bb.appendDate( "queued" , i->queued );
+                bb.append( "cursors" , (int)i->initial.size() );
+                bb.appendNumber( "deleted" , i->numDeleted );
+                bb.done();
+            }
+            arr.done();
+        }
 
-            set<CursorId> left;
-            for ( set<CursorId>::iterator i=cleanup.initial.begin(); i!=cleanup.initial.end(); ++i ) {
-                CursorId id = *i;
-                if ( now.count(id) )
-                    left.insert( id );
+        void run() {
+            Client::initThread( cleanUpThreadName );
+            if (!noauth) {
+                cc().getAuthenticationInfo()->authorize("local", internalSecurity.user);
             }
 
-            if ( left.size() == 0 )
-                break;
-            cleanup.initial = left;
+            while ( ! inShutdown() ) {
+                OldDataCleanup* cleanup = _next();
+                if ( ! cleanup ) {
+                    sleepmillis( 20 );
+                    continue;
+                }
+
+                int batchSize, docsPerSec;
+                {
+                    scoped_lock lk( _m );
+                    batchSize = _batchSize;
+                    docsPerSec = _docsPerSec;
+                }
+
+                Timer t;
+                long long n = -1;
+                try {
+                    n = migrateFromStatus.removeBatch( *cleanup , batchSize );
+                }
+                catch ( std::exception& e ) {
+                    log() << " error cleaning old data " << *cleanup << causedBy( e ) << migrateLog;
+                    _finish( cleanup , true );
+                    continue;
+                }
+
+                if ( n < 0 ) {
+                    // a migration out is running
+                    sleepmillis( 100 );
+                    continue;
+                }
 
-            if ( ( loops++ % 200 ) == 0 ) {
-                log() << " (looping " << loops << ") waiting to cleanup " << cleanup.ns << " from " << cleanup.min << " -> " << cleanup.max << "  # cursors:" << cleanup.initial.size() << migrateLog;
+                {
+                    scoped_lock lk( _m );
+                    _numDeleted += n;
+                    cleanup->numDeleted += n;
+                }
+
+                if ( n < batchSize ) {
+                    log() << "moveChunk deleted: " << cleanup->numDeleted << " for " << *cleanup << migrateLog;
+                    cleanup->waitForReplication();
+                    _finish( cleanup , false );
+                    continue;
+                }
 
-                stringstream ss;
-                for ( set<CursorId>::iterator i=cleanup.initial.begin(); i!=cleanup.initial.end(); ++i ) {
-                    CursorId id = *i;
-                    ss << id << " ";
+                if ( docsPerSec > 0 ) {
+                    long long ms = n * 1000 / docsPerSec - t.millis();
+                    if ( ms > 0 )
+                        sleepmillis( ms );
                 }
-                log() << " cursors: " << ss.str() << migrateLog;
             }
+
+            cc().shutdown();
         }
 
-        migrateFromStatus.doRemove( cleanup );
+    private:
+        /** @return the oldest range no longer waited on by cursors, if any */
+        OldDataCleanup* _next() {
+            scoped_lock lk( _m );
+            for ( list<OldDataCleanup>::iterator i = _queue.begin(); i != _queue.end(); ++i ) {
+                if ( i->initial.empty() )
+                    return &*i;
+
+                set<CursorId> now;
+                ClientCursor::find( i->ns , now );
+
+                set<CursorId> left;
+                for ( set<CursorId>::iterator j=i->initial.begin(); j!=i->initial.end(); ++j ) {
+                    if ( now.count( *j ) )
+                        left.insert( *j );
+                }
+                i->initial = left;
 
-        cc().shutdown();
-    }
+                if ( left.empty() || jsTime() - i->queued > 900 * 1000 ) { // 15 minutes
+                    i->initial.clear();
+                    return &*i;
+                }
+            }
+            return 0;
+        }
 
-    void cleanupOldData( OldDataCleanup cleanup ) {
-        try {
-            _cleanupOldData( cleanup );
+        void _finish( OldDataCleanup* cleanup , bool failed ) {
+            scoped_lock lk( _m );
+            for ( list<OldDataCleanup>::iterator i = _queue.begin(); i != _queue.end(); ++i ) {
+                if ( &*i == cleanup ) {
+                    if ( failed )
+                        warning() << "giving up on deleting " << *i << " after " << i->numDeleted << " documents" << migrateLog;
+                    _queue.erase( i );
+                    return;
+                }
+            }
         }
-        catch ( std::exception& e ) {
-            log() << " error cleaning old data:" << e.what() << migrateLog;
+
+        // protects everything below, including the ranges' numDeleted, but not the rest of a range
+        // being worked on, which only the deleter thread touches
+        mutable mongo::mutex _m;
+        list<OldDataCleanup> _queue;
+        int _docsPerSec;
+        int _batchSize;
+        bool _started;
+        long long _numDeleted;
+
+    } rangeDeleter;
+
+    /** { rangeDeleter : 1 [, docsPerSec : <n>] [, batchSize : <n>] } */
+    class RangeDeleterCommand : public Command {
+    public:
+        RangeDeleterCommand() : Command( "rangeDeleter" ) {}
+        virtual void help( stringstream& help ) const {
+            help << "pending deletions of chunks migrated away, and their throttling\n"
+                 << "{ rangeDeleter : 1 [, docsPerSec : <n, 0 for no limit>] [, batchSize : <n>] }";
         }
-        catch ( ... ) {
-            log() << " unknown error cleaning old data" << migrateLog;
+        virtual bool slaveOk() const { return false; }
+        virtual bool adminOnly() const { return true; }
+        virtual LockType locktype() const { return NONE; }
+        bool run(const string& , BSONObj& cmdObj, int, string& errmsg, BSONObjBuilder& result, bool) {
+            if ( cmdObj["docsPerSec"].isNumber() ) {
+                int n = cmdObj["docsPerSec"].numberInt();
+                if ( n < 0 ) {
+                    errmsg = "docsPerSec has to be >= 0";
+                    return false;
+                }
+                rangeDeleter.setDocsPerSec( n );
+            }
+            if ( cmdObj["batchSize"].isNumber() ) {
+                int n = cmdObj["batchSize"].numberInt();
+                if ( n < 1 || n > 100000 ) {
+                    errmsg = "batchSize has to be >= 1 and <= 100000";
+                    return false;
+                }
+                rangeDeleter.setBatchSize( n );
+            }
+            rangeDeleter.status( result );
+            return true;
         }
-    }
+    } rangeDeleterCmd;
 
     void logOpForSharding( const char * opstr , const char * ns , const BSONObj& obj , BSONObj * patt ) {
         migrateFromStatus.logOp( opstr , ns , obj , patt );
@@ -910,6 +1054,7 @@ namespace mongo {
             timing.done( 3 );
 
             // 4.
+            BSONObj counts;
             for ( int i=0; i<86400; i++ ) { // don't want a single chunk move to take more than a day
                 assert( d.dbMutex.getState() == 0 );
                 sleepsecs( 1 );
@@ -937,8 +1082,10 @@ namespace mongo {
                     return false;
                 }
 
-                if ( res["state"].String() == "steady" )
+                if ( res["state"].String() == "steady" ) {
+                    counts = res["counts"].Obj().getOwned();
                     break;
+                }
 
                 if ( migrateFromStatus.mbUsed() > (500 * 1024 * 1024) ) {
                     // this is too much memory for us to use for this
@@ -956,6 +1103,7 @@ namespace mongo {
 
                 killCurrentOp.checkForInterrupt();
             }
+            timing.throughput( "clone" , counts["cloned"].numberLong() , counts["clonedBytes"].numberLong() , counts["cloneMillis"].numberLong() );
             timing.done(4);
 
             // 5.
@@ -1196,17 +1344,17 @@ namespace mongo {
                 c.min = min.getOwned();
                 c.max = max.getOwned();
                 ClientCursor::find( ns , c.initial );
-                if ( c.initial.size() ) {
-                    log() << "forking for cleaning up chunk data" << migrateLog;
-                    boost::thread t( boost::bind( &cleanupOldData , c ) );
-                }
-                else {
-                    log() << "doing delete inline" << migrateLog;
+                rangeDeleter.queue( c );
+
+                if ( c.initial.empty() ) {
                     // 7.
-                    c.doRemove();
+                    // nothing can be reading the range, so finish it before returning as we used to
+                    log() << "waiting for delete of " << c << migrateLog;
+                    while ( rangeDeleter.overlaps( ns , min , max ) ) {
+                        sleepmillis( 20 );
+                        killCurrentOp.checkForInterrupt();
+                    }
                 }
-
-
             }
             timing.done(6);
 
@@ -1247,6 +1395,7 @@ namespace mongo {
 
             numCloned = 0;
             clonedBytes = 0;
+            cloneMillis = 0;
             numCatchup = 0;
             numSteady = 0;
 
@@ -1283,6 +1432,11 @@ namespace mongo {
             ScopedDbConnection conn( from );
             conn->getLastError(); // just test connection
 
+            // secondary indexes held back until the initial clone is in, see step 1.  They are
+            // built however we leave, so a failed migrate doesn't leave the collection without them.
+            vector<BSONObj> deferredIndexes;
+            ON_BLOCK_EXIT_OBJ( *this , &MigrateStatus::buildDeferredIndexes , ByRef( deferredIndexes ) );
+
             {
                 // 1. copy indexes
                 auto_ptr<DBClientCursor> indexes = conn->getIndexes( ns );
@@ -1294,9 +1448,21 @@ namespace mongo {
                 writelock lk( ns );
                 Client::Context ct( ns );
 
+                // If we hold no documents for this collection yet, its secondary indexes are built
+                // after the initial clone rather than maintained insert by insert.  We may own other,
+                // empty, chunks of it that are written to meanwhile, so the build is a background
+                // one, see buildDeferredIndexes().  Unique ones can't wait, nor can _id which the
+                // clone upserts on.
+                NamespaceDetails *d = nsdetails( ns.c_str() );
+                bool deferIndexes = ! d || d->stats.nrecords == 0;
+
                 string system_indexes = cc().database()->name + ".system.indexes";
                 for ( unsigned i=0; i<all.size(); i++ ) {
                     BSONObj idx = all[i];
+                    if ( deferIndexes && ! IndexDetails::isIdIndexPattern( idx["key"].Obj() ) && ! idx["unique"].trueValue() ) {
+                        deferredIndexes.push_back( idx );
+                        continue;
+                    }
                     theDataFileMgr.insertAndLog( system_indexes.c_str() , idx );
                 }
 
@@ -1318,37 +1484,52 @@ namespace mongo {
             {
                 // 3. initial bulk clone
                 state = CLONE;
+                Timer t;
 
+                // The next batch is always requested before this one is applied, so the donor
+                // gathers it while we insert.  The previous request's result stays alive until
+                // we are done with its objects.
+                shared_ptr<Future::CommandResult> next = Future::spawnCommand( from , "admin" , BSON( "_migrateClone" << 1 ) , 0 , conn.get() );
                 while ( true ) {
-                    BSONObj res;
-                    if ( ! conn->runCommand( "admin" , BSON( "_migrateClone" << 1 ) , res ) ) {
+                    shared_ptr<Future::CommandResult> current = next;
+                    next.reset();
+
+                    if ( ! current->join() ) {
                         state = FAIL;
                         errmsg = "_migrateClone failed: ";
-                        errmsg += res.toString();
+                        errmsg += current->result().toString();
                         error() << errmsg << migrateLog;
                         conn.done();
                         return;
                     }
 
-                    BSONObj arr = res["objects"].Obj();
-                    int thisTime = 0;
+                    BSONObj arr = current->result()["objects"].Obj();
+                    if ( arr.isEmpty() )
+                        break;
+
+                    next = Future::spawnCommand( from , "admin" , BSON( "_migrateClone" << 1 ) , 0 , conn.get() );
 
+                    // one write lock per slice of the batch rather than per document, yielding
+                    // as often as the donor does while gathering it
                     BSONObjIterator i( arr );
                     while( i.more() ) {
-                        BSONObj o = i.next().Obj();
-                        {
-                            writelock lk( ns );
+                        writelock lk( ns );
+                        ElapsedTracker tracker( 128 , 10 );
+                        while( i.more() ) {
+                            BSONObj o = i.next().Obj();
                             Helpers::upsert( ns , o );
+                            numCloned++;
+                            clonedBytes += o.objsize();
+                            if ( tracker.intervalHasElapsed() )
+                                break;
                         }
-                        thisTime++;
-                        numCloned++;
-                        clonedBytes += o.objsize();
                     }
-
-                    if ( thisTime == 0 )
-                        break;
                 }
 
+                buildDeferredIndexes( deferredIndexes );
+
+                cloneMillis = t.millis();
+                timing.throughput( "clone" , numCloned , clonedBytes , cloneMillis );
                 timing.done(3);
             }
 
@@ -1456,6 +1637,43 @@ namespace mongo {
             conn.done();
         }
 
+        /**
+         * builds, and removes, the indexes _go() held back from the initial clone.  They are built
+         * in the background, which bulk loads non unique indexes and yields the write lock as it
+         * goes, so writes to the rest of the collection aren't held up for the whole build.
+         */
+        void buildDeferredIndexes( vector<BSONObj>& indexes ) {
+            if ( indexes.empty() )
+                return;
+
+            writelock lk( ns );
+            Client::Context ct( ns );
+
+            string system_indexes = cc().database()->name + ".system.indexes";
+            while ( ! indexes.empty() ) {
+                BSONObj idx = indexes.back();
+                indexes.pop_back();
+
+                BSONObjBuilder b;
+                BSONObjIterator i( idx );
+                while ( i.more() ) {
+                    BSONElement e = i.next();
+                    if ( strcmp( e.fieldName() , "background" ) != 0 )
+                        b.append( e );
+                }
+                b.appendBool( "background" , true );
+                idx = b.obj();
+
+                try {
+                    theDataFileMgr.insertAndLog( system_indexes.c_str() , idx );
+                }
+                catch ( DBException& e ) {
+                    error() << "couldn't build index " << idx << " held back from migrate clone: " << e.what() << migrateLog;
+                    throw;
+                }
+            }
+        }
+
         void status( BSONObjBuilder& b ) {
             b.appendBool( "active" , getActive() );
 
@@ -1471,6 +1689,7 @@ namespace mongo {
                 BSONObjBuilder bb( b.subobjStart( "counts" ) );
                 bb.append( "cloned" , numCloned );
                 bb.append( "clonedBytes" , clonedBytes );
+                bb.append( "cloneMillis" , cloneMillis );
                 bb.append( "catchup" , numCatchup );
                 bb.append( "steady" , numSteady );
                 bb.done();
@@ -1614,6 +1833,7 @@ namespace mongo {
 
         long long numCloned;
         long long clonedBytes;
+        long long cloneMillis;
         long long numCatchup;
         long long numSteady;
         
@@ -1647,11 +1867,11 @@ namespace mongo {
                 return false;
             }
             
-            if ( OldDataCleanup::_numThreads > 0 ) {
+            if ( rangeDeleter.overlaps( cmdObj.firstElement().String() , cmdObj["min"].Obj() , cmdObj["max"].Obj() ) ) {
                 errmsg = 
                     str::stream() 
-                    << "still waiting for a previous migrates data to get cleaned, can't accept new chunks, num threads: " 
-                    << OldDataCleanup::_numThreads;
+                    << "still waiting for a previous migrates data to get cleaned, can't accept new chunks, num pending: " 
+                    << rangeDeleter.numPending();
                 return false;
             }
 
@@ -251,6 +251,7 @@ namespace mongo {
                  "  \n"
                  "  { splitVector : \"blog.post\" , keyPattern:{x:1} , min:{x:10} , max:{x:20}, force: true }\n"
                  "  'force' will produce one split point even if data is small; defaults to false\n"
+                 "  'estimate' finds split points from the shape of the index instead of traversing it\n"
                  "NOTE: This command may take a while to run";
         }
 
@@ -368,9 +369,51 @@ namespace mongo {
                     log() << "limiting split vector to " << maxChunkObjects << " (from " << keyCount << ") objects " << endl;
                     keyCount = maxChunkObjects;
                 }
+
+                //
+                // 2.a If asked to, estimate the split points instead: the rank of every keyCount-th key in the
+                //     chunk is worked out from the ranks of its bounds, and the key at each such rank looked up.
+                //     Each lookup is a single descent of the index, so this costs a few bucket reads per split
+                //     point however large the chunk. A forced split that can't find a point this way (the
+                //     estimate may be too coarse for a small chunk) traverses the index as usual.
+                //
+
+                if ( jsobj["estimate"].trueValue() ) {
+                    IndexInterface& ii = idx->idxInterface();
+                    const double lo = ii.estimateRank( *idx , min , false );
+                    const double hi = ii.estimateRank( *idx , max , false );
+                    const long long keysInRange = (long long)( ( hi - lo ) * recCount );
+                    long long estimateKeyCount = force ? keysInRange / 2 : keyCount;
+
+                    BSONObj last = min;
+                    for ( long long i = estimateKeyCount; estimateKeyCount > 0 && i < keysInRange; i += estimateKeyCount ) {
+                        BSONObj key = ii.keyAtRank( *idx , lo + ( hi - lo ) * i / keysInRange );
+                        if ( key.isEmpty() || key.woCompare( last , BSONObj() , false ) <= 0 )
+                            continue;
+                        if ( key.woCompare( max , BSONObj() , false ) >= 0 )
+                            break;
+
+                        splitKeys.push_back( key.getOwned() );
+                        last = splitKeys.back();
+                        if ( maxSplitPoints && ( (long long)splitKeys.size() >= maxSplitPoints ) )
+                            break;
+                    }
+
+                    LOG(1) << "estimated " << keysInRange << " keys in chunk " << ns << " " << min << " -->> " << max
+                           << ", " << splitKeys.size() << " split points" << endl;
+
+                    if ( ! splitKeys.empty() || ! force ) {
+                        for ( vector<BSONObj>::iterator it = splitKeys.begin(); it != splitKeys.end() ; ++it ) {
+                            *it = it->replaceFieldNames( idx->keyPattern() ).clientReadable();
+                        }
+                        result.append( "splitKeys" , splitKeys );
+                        result.appendBool( "estimated" , true );
+                        return true;
+                    }
+                }
                 
                 //
-                // 2. Traverse the index and add the keyCount-th key to the result vector. If that key
+                // 2.b Traverse the index and add the keyCount-th key to the result vector. If that key
                 //    appeared in the vector before, we omit it. The invariant here is that all the
                 //    instances of a given key value live in the same chunk.
                 //
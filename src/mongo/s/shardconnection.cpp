@@ -55,7 +55,7 @@ namespace mongo {
                         delete ss->avail;
                     }
                     else
-                        release( addr , ss->avail );
+                        shardConnectionPool.releaseParked( addr , ss->avail );
                     ss->avail = 0;
                 }
                 delete ss;
@@ -73,14 +73,7 @@ namespace mongo {
             if ( s->avail ) {
                 DBClientBase* c = s->avail;
                 s->avail = 0;
-                try {
-                    shardConnectionPool.onHandedOut( c );
-                }
-                catch ( std::exception& ) {
-                    delete c;
-                    throw;
-                }
-                return c;
+                return shardConnectionPool.unpark( addr , c );
             }
 
             s->created++;
@@ -94,6 +87,8 @@ namespace mongo {
                 release( addr , conn );
                 return;
             }
+            // kept for this thread, but not in use
+            shardConnectionPool.park( addr , conn );
             s->avail = conn;
         }
 
@@ -122,8 +117,10 @@ namespace mongo {
                     s = new Status();
                 }
 
-                if( ! s->avail )
+                if( ! s->avail ) {
                     s->avail = shardConnectionPool.get( sconnString );
+                    shardConnectionPool.park( sconnString , s->avail );
+                }
 
                 versionManager.checkShardVersionCB( s->avail, ns, false, 1 );
 
@@ -210,7 +207,7 @@ namespace mongo {
     void ShardConnection::kill() {
         if ( _conn ) {
             if( versionManager.isVersionableCB( _conn ) ) versionManager.resetShardVersionCB( _conn );
-            delete _conn;
+            shardConnectionPool.discard( _addr , _conn );
             _conn = 0;
             _finishedInit = true;
         }
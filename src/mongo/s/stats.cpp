@@ -25,4 +25,61 @@ namespace mongo {
     OpCounters opsSharded;
 
     GenericCounter shardedCursorTypes;
+
+    ShardedInsertCounter shardedInserts;
+
+    ShardedWriteCounter shardedWrites;
+
+    void ShardedInsertCounter::gotBatch( int numShards ) {
+        _lock.lock();
+        _batches++;
+        if ( numShards > _maxFanOut )
+            _maxFanOut = numShards;
+        _lock.unlock();
+    }
+
+    void ShardedInsertCounter::gotShardSend( long long micros ) {
+        _lock.lock();
+        _shardSends++;
+        _sendMicros += micros;
+        if ( micros > _maxSendMicros )
+            _maxSendMicros = micros;
+        _lock.unlock();
+    }
+
+    void ShardedInsertCounter::append( BSONObjBuilder& b ) {
+        _lock.lock();
+        b.appendNumber( "batches" , _batches );
+        b.appendNumber( "shardSends" , _shardSends );
+        b.append( "avgFanOut" , _batches ? (double) _shardSends / _batches : 0.0 );
+        b.append( "maxFanOut" , _maxFanOut );
+        b.appendNumber( "sendMicros" , _sendMicros );
+        b.append( "avgSendMicros" , _shardSends ? (double) _sendMicros / _shardSends : 0.0 );
+        b.appendNumber( "maxSendMicros" , _maxSendMicros );
+        _lock.unlock();
+    }
+
+    void ShardedWriteCounter::gotWrite( bool update , int numShards , int totalShards ) {
+        long long * counts = update ? _updates : _deletes;
+        _lock.lock();
+        counts[ numShards < totalShards ? 0 : 1 ]++;
+        _lock.unlock();
+    }
+
+    void ShardedWriteCounter::append( BSONObjBuilder& b ) {
+        _lock.lock();
+        {
+            BSONObjBuilder bb( b.subobjStart( "update" ) );
+            bb.appendNumber( "targeted" , _updates[0] );
+            bb.appendNumber( "broadcast" , _updates[1] );
+            bb.done();
+        }
+        {
+            BSONObjBuilder bb( b.subobjStart( "delete" ) );
+            bb.appendNumber( "targeted" , _deletes[0] );
+            bb.appendNumber( "broadcast" , _deletes[1] );
+            bb.done();
+        }
+        _lock.unlock();
+    }
 }
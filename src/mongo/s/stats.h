@@ -27,4 +27,56 @@ namespace mongo {
     extern OpCounters opsSharded;
 
     extern GenericCounter shardedCursorTypes;
+
+    /**
+     * fan out of sharded bulk inserts: how many shards each batch went to and how long the
+     * per shard sends took
+     */
+    class ShardedInsertCounter {
+    public:
+        ShardedInsertCounter() : _batches(0), _shardSends(0), _maxFanOut(0), _sendMicros(0), _maxSendMicros(0) {}
+
+        /** a bulk insert was dispatched to numShards shards */
+        void gotBatch( int numShards );
+
+        /** one shard's part of a bulk insert was sent in micros */
+        void gotShardSend( long long micros );
+
+        void append( BSONObjBuilder& b );
+    private:
+        long long _batches;
+        long long _shardSends;
+        int _maxFanOut;
+        long long _sendMicros;
+        long long _maxSendMicros;
+
+        SpinLock _lock;
+    };
+
+    extern ShardedInsertCounter shardedInserts;
+
+    /**
+     * how sharded updates and deletes were routed: to only the shards whose chunks the query
+     * could match, or to every shard the collection is on
+     */
+    class ShardedWriteCounter {
+    public:
+        ShardedWriteCounter() {
+            _updates[0] = _updates[1] = 0;
+            _deletes[0] = _deletes[1] = 0;
+        }
+
+        /** an update (or delete) went to numShards of the collection's totalShards shards */
+        void gotWrite( bool update , int numShards , int totalShards );
+
+        void append( BSONObjBuilder& b );
+    private:
+        // [0] targeted, [1] broadcast
+        long long _updates[2];
+        long long _deletes[2];
+
+        SpinLock _lock;
+    };
+
+    extern ShardedWriteCounter shardedWrites;
 }
@@ -25,6 +25,7 @@
 
 #include "../client/connpool.h"
 #include "../db/commands.h"
+#include "../util/timer.h"
 
 // error codes 8010-8040
 
@@ -208,84 +209,128 @@ namespace mongo {
 
             _groupInserts( manager, insertsRemaining, insertsForChunks );
 
-            while( ! insertsForChunks.empty() ){
+            const string& ns = r.getns();
 
-                ChunkPtr c = insertsForChunks.begin()->first;
-                vector<BSONObj>& objs = insertsForChunks.begin()->second;
+            // One batch per shard holding the inserts for all of its chunks, rather than one
+            // round of version check and send per chunk.
+            map< Shard , vector<ChunkPtr> > chunksForShards;
+            for ( map<ChunkPtr, vector<BSONObj> >::iterator i = insertsForChunks.begin(); i != insertsForChunks.end(); ++i ) {
+                chunksForShards[ i->first->getShard() ].push_back( i->first );
+            }
 
-                const Shard& shard = c->getShard();
-                const string& ns = r.getns();
+            // Version every target connection before sending anything, so a stale config on any
+            // shard is found while all the inserts are still pending and the retry can regroup
+            // them all against the reloaded chunk manager.
+            vector< shared_ptr<ShardConnection> > conns;
+            try {
+                for ( map< Shard , vector<ChunkPtr> >::iterator i = chunksForShards.begin(); i != chunksForShards.end(); ++i ) {
+                    conns.push_back( shared_ptr<ShardConnection>( new ShardConnection( i->first, ns, manager ) ) );
+                    // It's okay if the version is set here, an exception will be thrown if the version is incompatible
+                    conns.back()->setVersion();
+                }
+            }
+            catch ( StaleConfigException& e ) {
+                // Cleanup the connections
+                for ( unsigned i = 0; i < conns.size(); i++ )
+                    conns[i]->done();
 
-                ShardConnection dbcon( shard, ns, manager );
+                // Nothing was sent, so all the inserts are retried
 
-                try {
+                int logLevel = retries < 2;
+                LOG( logLevel ) << "retrying bulk insert of " << insertsForChunks.size() << " chunk batches because of StaleConfigException: " << e << endl;
 
-                    LOG(4) << "  server:" << c->getShard().toString() << " bulk insert " << objs.size() << " documents" << endl;
+                if( retries > 2 ){
+                    versionManager.forceRemoteCheckShardVersionCB( e.getns() );
+                }
 
-                    // Taken from single-shard bulk insert, should not need multiple methods in future
-                    // insert( c->getShard() , r.getns() , objs , flags);
+                // TODO:  Replace with actual chunk handling code, simplify request
+                r.reset();
+                manager = r.getChunkManager();
 
-                    // It's okay if the version is set here, an exception will be thrown if the version is incompatible
-                    dbcon.setVersion();
+                if( ! manager ) {
+                    // TODO : We can probably handle this better?
+                    uasserted( 14804, "collection no longer sharded" );
+                }
+                // End TODO
 
-                    dbcon->insert( ns , objs , flags);
-                    // TODO: Option for safe inserts here - can then use this for all inserts
+                // We may need to regroup at least some of our inserts since our chunk manager may have changed
+                _insert( r, d, manager, insertsRemaining, insertsForChunks, retries + 1 );
+                return;
+            }
 
-                    dbcon.done();
+            shardedInserts.gotBatch( chunksForShards.size() );
 
-                    int bytesWritten = 0;
-                    for (vector<BSONObj>::iterator vecIt = objs.begin(); vecIt != objs.end(); ++vecIt) {
-                        r.gotInsert(); // Record the correct number of individual inserts
-                        bytesWritten += (*vecIt).objsize();
-                    }
+            // Inserts are fire and forget, so every shard is sent its batch before any connection
+            // is released or any chunk is checked for splitting, and the shards apply their
+            // batches concurrently.  Each batch goes out on this thread's own connection so that
+            // getLastError sees it.
+            vector<bool> sent( conns.size() , false );
+            unsigned shardNum = 0;
+            for ( map< Shard , vector<ChunkPtr> >::iterator i = chunksForShards.begin(); i != chunksForShards.end(); ++i, ++shardNum ) {
 
-                    // TODO: The only reason we're grouping by chunks here is for auto-split, more efficient
-                    // to track this separately and bulk insert to shards
-                    if ( r.getClientInfo()->autoSplitOk() )
-                        c->splitIfShould( bytesWritten );
+                ShardConnection& dbcon = *conns[shardNum];
+                vector<ChunkPtr>& chunks = i->second;
 
+                vector<BSONObj> objs;
+                for ( unsigned j = 0; j < chunks.size(); j++ ) {
+                    vector<BSONObj>& chunkObjs = insertsForChunks[ chunks[j] ];
+                    objs.insert( objs.end(), chunkObjs.begin(), chunkObjs.end() );
                 }
-                catch ( StaleConfigException& e ) {
-                    // Cleanup the connection
-                    dbcon.done();
-
-                    // Assume the inserts did *not* succeed, so we don't want to erase them
 
-                    int logLevel = retries < 2;
-                    LOG( logLevel ) << "retrying bulk insert of " << objs.size() << " documents to chunk " << c << " because of StaleConfigException: " << e << endl;
+                try {
 
-                    if( retries > 2 ){
-                        versionManager.forceRemoteCheckShardVersionCB( e.getns() );
-                    }
+                    LOG(4) << "  server:" << i->first.toString() << " bulk insert " << objs.size() << " documents to " << chunks.size() << " chunks" << endl;
 
-                    // TODO:  Replace with actual chunk handling code, simplify request
-                    r.reset();
-                    manager = r.getChunkManager();
-
-                    if( ! manager ) {
-                        // TODO : We can probably handle this better?
-                        uasserted( 14804, "collection no longer sharded" );
-                    }
-                    // End TODO
+                    Timer t;
+                    dbcon->insert( ns , objs , flags);
+                    // TODO: Option for safe inserts here - can then use this for all inserts
+                    shardedInserts.gotShardSend( t.micros() );
+                    sent[shardNum] = true;
 
-                    // We may need to regroup at least some of our inserts since our chunk manager may have changed
-                    _insert( r, d, manager, insertsRemaining, insertsForChunks, retries + 1 );
-                    return;
                 }
-                catch( UserException& ){
+                catch( UserException& e ){
                     // Unexpected exception, so don't clean up the conn
                     dbcon.kill();
 
                     // These inserts won't be retried, as something weird happened here
-                    insertsForChunks.erase( insertsForChunks.begin() );
 
-                    // Throw if this is the last chunk bulk-inserted to
-                    if( insertsForChunks.empty() ){
+                    // Throw, once the other shards are done, if this is the last shard bulk-inserted to.
+                    // It is the last one sent to, so rethrow from here to keep the exception's type.
+                    if( shardNum + 1 == conns.size() ){
+                        _insertsSent( r, chunksForShards, conns, sent, insertsForChunks );
                         throw;
                     }
                 }
+            }
 
-                insertsForChunks.erase( insertsForChunks.begin() );
+            _insertsSent( r, chunksForShards, conns, sent, insertsForChunks );
+        }
+
+        /** releases the connections _insert() sent batches on and checks their chunks for splitting */
+        void _insertsSent( Request& r, map< Shard , vector<ChunkPtr> >& chunksForShards, vector< shared_ptr<ShardConnection> >& conns,
+                           const vector<bool>& sent, map<ChunkPtr, vector<BSONObj> >& insertsForChunks ) {
+            unsigned shardNum = 0;
+            for ( map< Shard , vector<ChunkPtr> >::iterator i = chunksForShards.begin(); i != chunksForShards.end(); ++i, ++shardNum ) {
+
+                if ( ! sent[shardNum] )
+                    continue;
+
+                conns[shardNum]->done();
+
+                // Chunks are still tracked separately for auto-split
+                vector<ChunkPtr>& chunks = i->second;
+                for ( unsigned j = 0; j < chunks.size(); j++ ) {
+                    vector<BSONObj>& chunkObjs = insertsForChunks[ chunks[j] ];
+
+                    int bytesWritten = 0;
+                    for (vector<BSONObj>::iterator vecIt = chunkObjs.begin(); vecIt != chunkObjs.end(); ++vecIt) {
+                        r.gotInsert(); // Record the correct number of individual inserts
+                        bytesWritten += (*vecIt).objsize();
+                    }
+
+                    if ( r.getClientInfo()->autoSplitOk() )
+                        chunks[j]->splitIfShould( bytesWritten );
+                }
             }
         }
 
@@ -306,6 +351,11 @@ namespace mongo {
             _insert( r, d, manager, insertsRemaining, insertsForChunks );
         }
 
+        /** counts an update or delete sent to numShards shards as targeted or broadcast */
+        void gotWrite( bool update , const ChunkManagerPtr& manager , int numShards ) {
+            shardedWrites.gotWrite( update , numShards , manager->numShards() );
+        }
+
         void _update( Request& r , DbMessage& d, ChunkManagerPtr manager ) {
             int flags = d.pullInt();
 
@@ -373,8 +423,29 @@ namespace mongo {
             }
 
             if ( multi ) {
+                // only the shards owning chunks in the query's shard key ranges need the update
                 set<Shard> shards;
-                manager->getShardsForQuery( shards , chunkFinder );
+                int left = 5;
+                while ( true ) {
+                    try {
+                        manager->getShardsForQuery( shards , chunkFinder );
+                        break;
+                    }
+                    catch ( StaleConfigException& e ) {
+                        if ( left <= 0 )
+                            throw e;
+                        left--;
+                        log() << "multi update will be retried b/c sharding config info is stale, "
+                              << " left:" << left << " ns: " << r.getns() << " query: " << query << endl;
+                        r.reset();
+                        shards.clear();
+                        manager = r.getChunkManager();
+                        uassert(16067, "collection no longer sharded", manager);
+                    }
+                }
+                LOG(2) << "multi update : " << query << " \t " << shards.size() << " shards" << endl;
+                gotWrite( true , manager , shards.size() );
+
                 int * x = (int*)(r.d().afterNS());
                 x[0] |= UpdateOption_Broadcast;
                 for ( set<Shard>::iterator i=shards.begin(); i!=shards.end(); i++) {
@@ -387,6 +458,7 @@ namespace mongo {
                     try {
                         ChunkPtr c = manager->findChunk( chunkFinder );
                         doWrite( dbUpdate , r , c->getShard() );
+                        gotWrite( true , manager , 1 );
                         if ( r.getClientInfo()->autoSplitOk() )
                             c->splitIfShould( d.msg().header()->dataLen() );
                         break;
@@ -423,6 +495,7 @@ namespace mongo {
                     LOG(2) << "delete : " << pattern << " \t " << shards.size() << " justOne: " << justOne << endl;
                     if ( shards.size() == 1 ) {
                         doWrite( dbDelete , r , *shards.begin() );
+                        gotWrite( false , manager , 1 );
                         return;
                     }
                     break;
@@ -443,6 +516,8 @@ namespace mongo {
             if ( justOne && ! pattern.hasField( "_id" ) )
                 throw UserException( 8015 , "can only delete with a non-shard key pattern if can delete as many as we find" );
 
+            gotWrite( false , manager , shards.size() );
+
             for ( set<Shard>::iterator i=shards.begin(); i!=shards.end(); i++) {
                 int * x = (int*)(r.d().afterNS());
                 x[0] |= RemoveOption_Broadcast;
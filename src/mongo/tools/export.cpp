@@ -210,6 +210,7 @@ public:
             out << '[';
 
         long long num = 0;
+        StringBuilder line; // json output, reused from document to document
         while ( cursor->more() ) {
             num++;
             BSONObj obj = cursor->next();
@@ -225,13 +226,16 @@ public:
                 out << endl;
             }
             else {
+                line.reset();
                 if (jsonArray && num != 1)
-                    out << ',';
+                    line << ',';
 
-                out << obj.jsonString();
+                obj.jsonString( line );
 
+                // '\n' rather than endl, which would flush after every document
                 if (!jsonArray)
-                    out << endl;
+                    line << '\n';
+                out.write( line.stringData().data(), line.len() );
             }
         }
 
@@ -49,6 +49,7 @@ class Import : public Tool {
     bool _jsonArray;
     vector<string> _upsertFields;
     static const int BUF_SIZE = 1024 * 1024 * 16;
+    boost::scoped_array<char> _rowBuffer; // for parseRow
 
     void csvTokenizeRow(const string& row, vector<string>& tokens) {
         bool inQuotes = false;
@@ -165,8 +166,10 @@ class Import : public Tool {
      * Returns a true if a BSONObj was successfully created and false if not.
      */
     bool parseRow(istream* in, BSONObj& o, int& numBytesRead) {
-        boost::scoped_array<char> buffer(new char[BUF_SIZE+2]);
-        char* line = buffer.get();
+        // one buffer for every row, rather than allocating BUF_SIZE per line
+        if ( !_rowBuffer )
+            _rowBuffer.reset( new char[BUF_SIZE+2] );
+        char* line = _rowBuffer.get();
 
         numBytesRead = getLine(in, line);
         line += numBytesRead;
@@ -24,7 +24,8 @@ namespace mongo {
 
         Alphabet alphabet;
 
-        void encode( stringstream& ss , const char * data , int size ) {
+        template< class Stream >
+        static void encodeTo( Stream& ss , const char * data , int size ) {
             for ( int i=0; i<size; i+=3 ) {
                 int left = size - i;
                 const unsigned char * start = (const unsigned char*)data + i;
@@ -63,6 +64,13 @@ namespace mongo {
             }
         }
 
+        void encode( stringstream& ss , const char * data , int size ) {
+            encodeTo( ss , data , size );
+        }
+
+        void encode( StringBuilder& sb , const char * data , int size ) {
+            encodeTo( sb , data , size );
+        }
 
         string encode( const char * data , int size ) {
             stringstream ss;
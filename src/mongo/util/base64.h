@@ -56,6 +56,7 @@ namespace mongo {
 
 
         void encode( stringstream& ss , const char * data , int size );
+        void encode( StringBuilder& sb , const char * data , int size );
         string encode( const char * data , int size );
         string encode( const string& s );
 
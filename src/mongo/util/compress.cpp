@@ -1,10 +1,56 @@
 // @file compress.cpp
 
 #include "../third_party/snappy/snappy.h"
+#include "../third_party/snappy/snappy-sinksource.h"
 #include "compress.h"
 
 namespace mongo {
 
+    namespace {
+        /** the buffers, one after the other */
+        class BuffersSource : public snappy::Source {
+        public:
+            BuffersSource(const std::vector< std::pair<char*, int> >& buffers) :
+                _b(buffers), _i(0), _off(0), _left(0) {
+                for ( size_t i = 0; i < _b.size(); i++ )
+                    _left += _b[i].second;
+                skipEmpty();
+            }
+            virtual size_t Available() const { return _left; }
+            virtual const char* Peek(size_t* len) {
+                if ( _i == _b.size() ) {
+                    *len = 0;
+                    return 0;
+                }
+                *len = _b[_i].second - _off;
+                return _b[_i].first + _off;
+            }
+            virtual void Skip(size_t n) {
+                _left -= n;
+                while ( n ) {
+                    size_t here = _b[_i].second - _off;
+                    if ( n < here ) {
+                        _off += n;
+                        return;
+                    }
+                    n -= here;
+                    _i++;
+                    _off = 0;
+                }
+                skipEmpty();
+            }
+        private:
+            void skipEmpty() {
+                while ( _i < _b.size() && _b[_i].second == 0 )
+                    _i++;
+            }
+            const std::vector< std::pair<char*, int> >& _b;
+            size_t _i;   // the buffer Peek() reads from
+            size_t _off; // how far into it
+            size_t _left;
+        };
+    }
+
     void rawCompress(const char* input,
         size_t input_length,
         char* compressed,
@@ -13,6 +59,15 @@ namespace mongo {
         snappy::RawCompress(input, input_length, compressed, compressed_length);
     }
 
+    void rawCompress(const std::vector< std::pair<char*, int> >& input,
+        char* compressed,
+        size_t* compressed_length)
+    {
+        BuffersSource source(input);
+        snappy::UncheckedByteArraySink sink(compressed);
+        *compressed_length = snappy::Compress(&source, &sink);
+    }
+
     size_t maxCompressedLength(size_t source_len) { 
         return snappy::MaxCompressedLength(source_len);
     }
@@ -25,4 +80,12 @@ namespace mongo {
         return snappy::Uncompress(compressed, compressed_length, uncompressed);
     }
 
+    bool getUncompressedLength(const char* compressed, size_t compressed_length, size_t* result) { 
+        return snappy::GetUncompressedLength(compressed, compressed_length, result);
+    }
+
+    bool rawUncompress(const char* compressed, size_t compressed_length, char* uncompressed) { 
+        return snappy::RawUncompress(compressed, compressed_length, uncompressed);
+    }
+
 }
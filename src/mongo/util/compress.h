@@ -3,6 +3,7 @@
 #pragma once
 
 #include <string>
+#include <vector>
 
 namespace mongo { 
 
@@ -16,6 +17,19 @@ namespace mongo {
         char* compressed,
         size_t* compressed_length);
 
+    /** like rawCompress(), for input that is the concatenation of several buffers, which are not copied
+        together first.  compressed must have room for maxCompressedLength() of their total length.
+    */
+    void rawCompress(const std::vector< std::pair<char*, int> >& input,
+        char* compressed,
+        size_t* compressed_length);
+
+    /** @return false if compressed is corrupt */
+    bool getUncompressedLength(const char* compressed, size_t compressed_length, size_t* result);
+
+    /** @param uncompressed must have room for getUncompressedLength() bytes */
+    bool rawUncompress(const char* compressed, size_t compressed_length, char* uncompressed);
+
 }
 
 
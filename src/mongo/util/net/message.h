@@ -38,7 +38,8 @@ namespace mongo {
         dbQuery = 2004,
         dbGetMore = 2005,
         dbDelete = 2006,
-        dbKillCursors = 2007
+        dbKillCursors = 2007,
+        dbCompressed = 2012 /* another message, compressed. only seen by MessagingPort, see there */
     };
 
     bool doesOpGetAResponse( int op );
@@ -54,6 +55,7 @@ namespace mongo {
         case dbGetMore: return "getmore";
         case dbDelete: return "remove";
         case dbKillCursors: return "killcursors";
+        case dbCompressed: return "compressed";
         default:
             PRINT(op);
             assert(0);
@@ -70,6 +72,7 @@ namespace mongo {
         case dbQuery:
         case dbGetMore:
         case dbKillCursors:
+        case dbCompressed:
             return false;
 
         case dbUpdate:
@@ -152,6 +155,8 @@ namespace mongo {
 
     class Message {
     public:
+        typedef vector< pair< char*, int > > MsgVec;
+
         // we assume here that a vector with initial size 0 does no allocation (0 is the default, but wanted to make it explicit).
         Message() : _buf( 0 ), _data( 0 ), _freeIt( false ) {}
         Message( void * data , bool freeIt ) :
@@ -266,6 +271,37 @@ namespace mongo {
             header()->len += size;
         }
 
+        /** like appendData(), for a message that owns none of its buffers, which must each outlive it.
+            lets a reply be sent from where its parts are, rather than copied together first.
+        */
+        void appendBorrowedData(char *d, int size) {
+            if ( size <= 0 ) {
+                return;
+            }
+            if ( empty() ) {
+                MsgData *md = (MsgData*)d;
+                md->len = size;
+                _setData( md, false );
+                return;
+            }
+            assert( !_freeIt );
+            if ( _buf ) {
+                _data.push_back( make_pair( (char*)_buf, _buf->len ) );
+                _buf = 0;
+            }
+            _data.push_back( make_pair( d, size ) );
+            header()->len += size;
+        }
+
+        /** appends the message's buffers to out, in order.  the first starts with the header */
+        void getBuffers( MsgVec& out ) const {
+            if ( _buf ) {
+                out.push_back( make_pair( (char*)_buf, _buf->len ) );
+                return;
+            }
+            out.insert( out.end(), _data.begin(), _data.end() );
+        }
+
         // use to set first buffer if empty
         void setData(MsgData *d, bool freeIt) {
             assert( empty() );
@@ -300,7 +336,6 @@ namespace mongo {
         // if just one buffer, keep it in _buf, otherwise keep a sequence of buffers in _data
         MsgData * _buf;
         // byte buffer(s) - the first must contain at least a full MsgData unless using _buf for storage instead
-        typedef vector< pair< char*, int > > MsgVec;
         MsgVec _data;
         bool _freeIt;
     };
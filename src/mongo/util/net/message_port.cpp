@@ -30,6 +30,8 @@
 #include "../../db/cmdline.h"
 #include "../../client/dbclient.h"
 #include "../scopeguard.h"
+#include "../compress.h"
+#include "../concurrency/spin_lock.h"
 
 
 #ifndef _WIN32
@@ -121,18 +123,18 @@ namespace mongo {
     }
 
     MessagingPort::MessagingPort(int fd, const SockAddr& remote) 
-        : Socket( fd , remote ) , piggyBackData(0) {
+        : Socket( fd , remote ) , piggyBackData(0) , _compress(false) {
         ports.insert(this);
     }
 
     MessagingPort::MessagingPort( double timeout, int ll ) 
-        : Socket( timeout, ll ) {
+        : Socket( timeout, ll ) , _compress(false) {
         ports.insert(this);
         piggyBackData = 0;
     }
 
     MessagingPort::MessagingPort( Socket& sock )
-        : Socket( sock ) , piggyBackData( 0 ) {
+        : Socket( sock ) , piggyBackData( 0 ) , _compress(false) {
         ports.insert(this);
     }
 
@@ -191,6 +193,16 @@ again:
 
             Socket::recv( p, left );
 
+            if ( md->operation() == dbCompressed ) {
+                MsgData *u = uncompress( md );
+                if ( ! u ) {
+                    log(0) << "recv(): bad compressed message from " << remote() << endl;
+                    return false;
+                }
+                m.setData(u, true);
+                return true;
+            }
+
             guard.Dismiss();
             m.setData(md, true);
             return true;
@@ -264,9 +276,106 @@ again:
             }
         }
 
+        if ( _compress && sendCompressed( toSend ) )
+            return;
+
         toSend.send( *this, "say" );
     }
 
+    /* a dbCompressed message is the usual header, then
+         int  operation of the original message
+         int  length of the original message's body, that is without its header
+         char compressor: 1 for snappy
+         the original message's body, compressed
+       its id and responseTo are the original message's.
+    */
+    enum { CompressedPrefixSize = 9 , CompressorSnappy = 1 };
+
+    static SpinLock bytesSavedLock;
+    static long long bytesSavedIn = 0;
+    static long long bytesSavedOut = 0;
+
+    static void savedBytes( long long in , long long out ) {
+        scoped_spinlock lk( bytesSavedLock );
+        bytesSavedIn += in;
+        bytesSavedOut += out;
+    }
+
+    void MessagingPort::getBytesSaved( long long& in , long long& out ) {
+        scoped_spinlock lk( bytesSavedLock );
+        in = bytesSavedIn;
+        out = bytesSavedOut;
+    }
+
+    bool MessagingPort::sendCompressed( Message& toSend ) {
+        int op = toSend.operation();
+        if ( op != opReply && op != dbQuery )
+            return false;
+        if ( toSend.dataSize() < CompressMinBytes )
+            return false;
+
+        // compress the body from where its parts are, without the header
+        MsgData *md = toSend.header();
+        int bodyLen = md->dataLen();
+        Message::MsgVec body;
+        toSend.getBuffers( body );
+        body[0].first += MsgDataHeaderSize;
+        body[0].second -= MsgDataHeaderSize;
+
+        MsgData *c = (MsgData *) malloc( MsgDataHeaderSize + CompressedPrefixSize + maxCompressedLength( bodyLen ) );
+        ScopeGuard guard = MakeGuard(free, c);
+        assert(c);
+
+        size_t compressedLen;
+        rawCompress( body, c->_data + CompressedPrefixSize, &compressedLen );
+        if ( (int) compressedLen + CompressedPrefixSize >= bodyLen )
+            return false;
+
+        c->len = MsgDataHeaderSize + CompressedPrefixSize + compressedLen;
+        c->id = md->id;
+        c->responseTo = md->responseTo;
+        c->setOperation( dbCompressed );
+        memcpy( c->_data , &op , 4 );
+        memcpy( c->_data + 4 , &bodyLen , 4 );
+        c->_data[8] = CompressorSnappy;
+
+        send( (char *) c , c->len , "say" );
+        savedBytes( 0 , md->len - c->len );
+        return true;
+    }
+
+    MsgData* MessagingPort::uncompress( MsgData* md ) {
+        int compressedLen = md->dataLen() - CompressedPrefixSize;
+        if ( compressedLen < 0 || md->_data[8] != CompressorSnappy )
+            return 0;
+
+        int op;
+        int bodyLen;
+        memcpy( &op , md->_data , 4 );
+        memcpy( &bodyLen , md->_data + 4 , 4 );
+        const char *compressed = md->_data + CompressedPrefixSize;
+
+        size_t n;
+        if ( bodyLen < 0 || bodyLen > 48000000 - MsgDataHeaderSize ||
+             ! getUncompressedLength( compressed , compressedLen , &n ) || n != (size_t) bodyLen )
+            return 0;
+
+        int len = MsgDataHeaderSize + bodyLen;
+        MsgData *u = (MsgData *) malloc( ( len + 1023 ) & 0xfffffc00 );
+        assert(u);
+        if ( ! rawUncompress( compressed , compressedLen , u->_data ) ) {
+            free( u );
+            return 0;
+        }
+        u->len = len;
+        u->id = md->id;
+        u->responseTo = md->responseTo;
+        u->setOperation( op );
+
+        savedBytes( len - md->len , 0 );
+        return u;
+    }
+
     void MessagingPort::piggyBack( Message& toSend , int responseTo ) {
 
         if ( toSend.header()->len > 1300 ) {
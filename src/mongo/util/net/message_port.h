@@ -39,6 +39,11 @@ namespace mongo {
 
         virtual void assertStillConnected() = 0;
 
+        /** compress large messages sent from now on: the other side has said it can read them.
+            @return false if this kind of port doesn't compress
+        */
+        virtual bool enableCompression() { return false; }
+
     public:
         // TODO make this private with some helpers
 
@@ -90,9 +95,26 @@ namespace mongo {
 
         void assertStillConnected();
 
+        /** see AbstractMessagingPort.  queries and replies with bodies of CompressMinBytes or more
+            are sent snappy compressed, when that makes them smaller.  recv() always uncompresses.
+        */
+        bool enableCompression() { _compress = true; return true; }
+        enum { CompressMinBytes = 1024 };
+
+        /** the bytes compression has kept off the wire, summed over every port in this process,
+            server and client side alike
+        */
+        static void getBytesSaved( long long& in , long long& out );
+
     private:
-        
+        /** send toSend as a dbCompressed message.  @return false if it is not worth it */
+        bool sendCompressed( Message& toSend );
+        /** @return the message md holds, malloc()ed, or NULL if md is corrupt */
+        MsgData* uncompress( MsgData* md );
+
         PiggyBackData * piggyBackData;
+
+        bool _compress;
         
         // this is the parsed version of remote
         // mutable because its initialized only on call to remote()
@@ -7,7 +7,8 @@ def configure( env , fileLists , options ):
 
     files = ["$BUILD_DIR/third_party/snappy/snappy.cc", "$BUILD_DIR/third_party/snappy/snappy-sinksource.cc"]
 
-    fileLists["serverOnlyFiles"] += [ myenv.Object(f) for f in files ]
+    # in common: MessagingPort compresses messages between servers
+    fileLists["commonFiles"] += [ myenv.Object(f) for f in files ]
 
 def configureSystem( env , fileLists , options ):
     configure( env , fileLists , options )